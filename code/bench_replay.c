@@ -0,0 +1,314 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "collect.h"
+#include "common.h"
+#include "dispatch.h"
+#include "event_set.h"
+#include "latency.h"
+#include "logger.h"
+#include "metrics.h"
+#include "receive.h"
+#include "kleb.h"
+#include "respond.h"
+
+// exec 风暴回放基准：不需要 root 和 BPF，按记录的（或合成的）exec 序列驱动
+// 去重、采集线程调度、管道传输、特征组装、推理和输出整条用户态流水线，
+// 采集线程由合成计数器流代替 perf_event_open
+
+#define DEFAULT_WEIGHTS_PATH "model_weights.bin"
+#define DEFAULT_RATES "100,1000,10000,100000"
+#define DRAIN_TIMEOUT_S 30
+#define MAX_TRACE_EVENTS 10000000
+
+struct trace_event {
+    uint64_t offset_ns;     // 相对回放开始的时间
+    uint32_t pid;
+};
+
+struct trace {
+    struct trace_event *events;
+    size_t count;
+};
+
+static struct event_set active_events;
+static unsigned int window_interval_us = 0;
+static _Atomic int64_t collectors_done;
+
+// 合成计数器流：每个 PID 一个确定性的伪随机序列，各事件在各自量级附近波动
+static uint64_t xorshift64(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static void synthetic_collector(uint32_t pid, uint64_t exec_ns, int pipe_fd, void *ctx) {
+    const struct event_set *set = ctx;
+    int n = set->count;
+    const char *names[MAX_EVENTS];
+    uint64_t base[MAX_EVENTS];
+    uint64_t window[MAX_EVENTS][PRINT_EVERY];
+    uint64_t rng = (pid + 1) * 0x9E3779B97F4A7C15ull;
+    char header[64];
+
+    latency_record(LAT_EXEC_TO_COLLECT, latency_now() - exec_ns);
+    snprintf(header, sizeof(header), "[PID: %u]", pid);
+    for (int i = 0; i < n; i++) {
+        names[i] = set->events[i].name;
+        base[i] = 10000ull << (xorshift64(&rng) % 10);
+    }
+
+    for (int start = 0; start < TOTAL_SAMPLES; start += PRINT_EVERY) {
+        uint64_t window_ns = latency_now();
+        if (window_interval_us)
+            usleep(window_interval_us);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < PRINT_EVERY; j++) {
+                // 第 0 个样本与真实采集一致记 0
+                window[i][j] = start + j == 0 ? 0 : base[i] / 2 + xorshift64(&rng) % base[i];
+            }
+        }
+        send_window(pipe_fd, header, n, names, window, start, exec_ns, window_ns);
+    }
+    atomic_fetch_add(&collectors_done, 1);
+}
+
+// 记录格式：每行 "<相对时间 ns> <pid>"，# 开头为注释
+static int load_trace(const char *path, struct trace *trace) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open trace %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    size_t cap = 1024;
+    trace->events = malloc(cap * sizeof(*trace->events));
+    trace->count = 0;
+    char line[256];
+    while (trace->events && fgets(line, sizeof(line), file)) {
+        struct trace_event ev;
+        if (line[0] == '#' || sscanf(line, "%" SCNu64 " %" SCNu32, &ev.offset_ns, &ev.pid) != 2)
+            continue;
+        if (trace->count == cap) {
+            if (cap >= MAX_TRACE_EVENTS)
+                break;
+            cap *= 2;
+            struct trace_event *grown = realloc(trace->events, cap * sizeof(*grown));
+            if (!grown) {
+                free(trace->events);
+                trace->events = NULL;
+                break;
+            }
+            trace->events = grown;
+        }
+        trace->events[trace->count++] = ev;
+    }
+    fclose(file);
+    if (!trace->events) {
+        perror("malloc trace");
+        return -1;
+    }
+    return 0;
+}
+
+// 按固定速率合成 exec 序列，PID 互不重复
+static int synth_trace(struct trace *trace, uint64_t rate, double seconds, uint32_t pid_base) {
+    trace->count = (size_t)(rate * seconds);
+    if (trace->count == 0)
+        trace->count = 1;
+    trace->events = malloc(trace->count * sizeof(*trace->events));
+    if (!trace->events) {
+        perror("malloc trace");
+        return -1;
+    }
+    for (size_t i = 0; i < trace->count; i++) {
+        trace->events[i].offset_ns = i * 1000000000ull / rate;
+        trace->events[i].pid = pid_base + i;
+    }
+    return 0;
+}
+
+static int64_t metric(enum metric m) {
+    return atomic_load_explicit(&metric_values[m].value, memory_order_relaxed);
+}
+
+static double cpu_seconds(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static void sleep_until(uint64_t target_ns) {
+    uint64_t now = latency_now();
+    if (now >= target_ns)
+        return;
+    struct timespec ts = { .tv_sec = target_ns / 1000000000ull, .tv_nsec = target_ns % 1000000000ull };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static void run_trace(const char *label, const struct trace *trace) {
+    int64_t before[METRIC_COUNT];
+    for (int m = 0; m < METRIC_COUNT; m++)
+        before[m] = metric(m);
+    latency_reset();
+    atomic_store(&collectors_done, 0);
+    double cpu_start = cpu_seconds();
+    uint64_t start = latency_now();
+
+    // 落后于计划时不再等待，按突发方式追赶
+    int deduped = 0;
+    for (size_t i = 0; i < trace->count; i++) {
+        sleep_until(start + trace->events[i].offset_ns);
+        if (dispatch_exec(trace->events[i].pid, latency_now()) == 1)
+            deduped++;
+    }
+    uint64_t offered_end = latency_now();
+
+    // 等待所有采集线程结束、所有窗口被读出
+    int64_t dropped = metric(METRIC_EXECS_DROPPED) - before[METRIC_EXECS_DROPPED];
+    int64_t started = trace->count - deduped - dropped;
+    uint64_t deadline = offered_end + DRAIN_TIMEOUT_S * 1000000000ull;
+    while (latency_now() < deadline) {
+        int64_t received = metric(METRIC_WINDOWS_RECEIVED) - before[METRIC_WINDOWS_RECEIVED];
+        int64_t sent = metric(METRIC_WINDOWS_SENT) - before[METRIC_WINDOWS_SENT];
+        if (atomic_load(&collectors_done) >= started && received >= sent)
+            break;
+        usleep(1000);
+    }
+    uint64_t end = latency_now();
+    double cpu = cpu_seconds() - cpu_start;
+    double wall = (end - start) / 1e9;
+
+    int64_t windows = metric(METRIC_WINDOWS_RECEIVED) - before[METRIC_WINDOWS_RECEIVED];
+    int64_t inferences = metric(METRIC_INFERENCES) - before[METRIC_INFERENCES];
+
+    printf("== %s: %zu execs offered in %.3f s\n", label, trace->count, (offered_end - start) / 1e9);
+    printf("   started %" PRId64 ", deduped %d, dropped %" PRId64 ", windows %" PRId64
+           ", inferences %" PRId64 " (%.1f/s)\n",
+           started, deduped, dropped, windows, inferences, inferences / wall);
+    printf("   cpu %.3f s (%.1f%% of one core, %.1f us per started exec)\n",
+           cpu, 100.0 * cpu / wall, started ? cpu * 1e6 / started : 0.0);
+    printf("   %-16s %10s %10s %10s %10s %10s %10s (ms)\n",
+           "stage", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        uint64_t count = latency_count(s);
+        if (count == 0)
+            continue;
+        printf("   %-16s %10" PRIu64 " %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+               latency_stage_name(s), count,
+               latency_percentile(s, 0.50) / 1e6, latency_percentile(s, 0.90) / 1e6,
+               latency_percentile(s, 0.99) / 1e6, latency_percentile(s, 0.999) / 1e6,
+               latency_max(s) / 1e6);
+    }
+    fflush(stdout);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-m weights] [-r rates] [-d seconds] [-t trace] [-i interval_us]\n"
+            "  -m PATH     model weights (default " DEFAULT_WEIGHTS_PATH ")\n"
+            "  -r LIST     comma-separated exec rates per second (default " DEFAULT_RATES ")\n"
+            "  -d SECONDS  duration of each synthetic run (default 1)\n"
+            "  -t FILE     replay a recorded trace instead: one \"<offset_ns> <pid>\" per line\n"
+            "  -i USEC     sleep per synthetic window (default 0; real collectors take 100000)\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    const char *weights_path = DEFAULT_WEIGHTS_PATH;
+    const char *rates = DEFAULT_RATES;
+    const char *trace_path = NULL;
+    double seconds = 1.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:r:d:t:i:h")) != -1) {
+        switch (opt) {
+        case 'm':
+            weights_path = optarg;
+            break;
+        case 'r':
+            rates = optarg;
+            break;
+        case 'd':
+            seconds = atof(optarg);
+            break;
+        case 't':
+            trace_path = optarg;
+            break;
+        case 'i':
+            window_interval_us = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    struct kleb_ctx *detector = kleb_create();
+    if (!detector || kleb_load_model(detector, weights_path) != 0) {
+        fprintf(stderr, "Failed to initialize model: %s\n", detector ? kleb_error(detector) : "out of memory");
+        return 1;
+    }
+    active_events = *kleb_events(detector);
+
+    // 推理结果照常格式化输出，只是写到 /dev/null
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd == -1 || logger_start(LOG_INFO, null_fd) != 0) {
+        perror("open /dev/null");
+        return 1;
+    }
+    struct respond_config respond = { .action = RESPOND_NONE, .signal_map_fd = -1 };
+    respond_init(&respond);
+    dispatch_init(synthetic_collector, &active_events);
+
+    pthread_t recv_tid;
+    if (pthread_create(&recv_tid, NULL, receive_thread, detector) != 0) {
+        perror("pthread_create");
+        return 1;
+    }
+
+    if (trace_path) {
+        struct trace trace;
+        if (load_trace(trace_path, &trace) != 0)
+            return 1;
+        run_trace(trace_path, &trace);
+        free(trace.events);
+    } else {
+        char *list = strdup(rates);
+        uint32_t pid_base = 1000000;
+        for (char *tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+            uint64_t rate = strtoull(tok, NULL, 10);
+            if (rate == 0)
+                continue;
+            struct trace trace;
+            if (synth_trace(&trace, rate, seconds, pid_base) != 0)
+                break;
+            pid_base += trace.count;
+            char label[64];
+            snprintf(label, sizeof(label), "%" PRIu64 " execs/s", rate);
+            run_trace(label, &trace);
+            free(trace.events);
+        }
+        free(list);
+    }
+
+    exiting = 1;
+    pthread_join(recv_tid, NULL);
+    kleb_destroy(detector);
+    dispatch_cleanup();
+    logger_stop();
+    close(null_fd);
+    return 0;
+}
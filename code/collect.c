@@ -9,48 +9,21 @@
 #include <inttypes.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <stddef.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <limits.h>
+#include "collect.h"
+#include "event_set.h"
+#include "logger.h"
+#include "common.h"
+#include "latency.h"
+#include "metrics.h"
 
-#define TOTAL_EVENTS 4
 #define SAMPLE_INTERVAL_MS 10
-#define TOTAL_SAMPLES 30
-#define PRINT_EVERY 10
-
-typedef struct {
-    const char *name;
-    int type;
-    int config;
-} EventDef;
-
-// 默认事件（适合恶意软件检测）
-static const EventDef default_events[TOTAL_EVENTS] = {
-    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
-    { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
-    { "branch-instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
-    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
-};
-
-// 简单事件名解析器
-int parse_event(const char *name, int *type, int *config) {
-    if (strcmp(name, "instructions") == 0) {
-        *type = PERF_TYPE_HARDWARE;
-        *config = PERF_COUNT_HW_INSTRUCTIONS;
-    } else if (strcmp(name, "cycles") == 0) {
-        *type = PERF_TYPE_HARDWARE;
-        *config = PERF_COUNT_HW_CPU_CYCLES;
-    } else if (strcmp(name, "branch-instructions") == 0) {
-        *type = PERF_TYPE_HARDWARE;
-        *config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
-    } else if (strcmp(name, "branch-misses") == 0) {
-        *type = PERF_TYPE_HARDWARE;
-        *config = PERF_COUNT_HW_BRANCH_MISSES;
-    } else {
-        fprintf(stderr, "Unsupported event name: %s\n", name);
-        return -1;
-    }
-    return 0;
-}
 
-struct perf_event_attr create_event_attr(int type, int config) {
+struct perf_event_attr create_event_attr(uint32_t type, uint64_t config) {
     struct perf_event_attr attr = {
         .type = type,
         .config = config,
@@ -62,81 +35,508 @@ struct perf_event_attr create_event_attr(int type, int config) {
     return attr;
 }
 
-void collect_perf_events(int target_pid, const char *events[4], int pipe_fd) {
-    int fds[TOTAL_EVENTS];
-    uint64_t values[TOTAL_EVENTS][TOTAL_SAMPLES] = {0};
-    const char *used_names[TOTAL_EVENTS];
-    int types[TOTAL_EVENTS], configs[TOTAL_EVENTS];
-    char buffer[1024]; // 用于格式化数据
-
-    for (int i = 0; i < TOTAL_EVENTS; i++) {
-        if (!events || !events[i]) {
-            types[i] = default_events[i].type;
-            configs[i] = default_events[i].config;
-            used_names[i] = default_events[i].name;
-        } else {
-            if (parse_event(events[i], &types[i], &configs[i]) != 0)
-                return;
-            used_names[i] = events[i];
+// perf_event_open 与 close，同时维护打开 fd 数和按 errno 的失败计数
+static int perf_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+    int fd = syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+    if (fd == -1)
+        metrics_perf_open_failed(errno);
+    else
+        metrics_add(METRIC_PERF_FDS_OPEN, 1);
+    return fd;
+}
+
+static void perf_close(int fd) {
+    close(fd);
+    metrics_add(METRIC_PERF_FDS_OPEN, -1);
+}
+
+// 未指定事件集时使用默认事件集
+static const struct event_set *resolve_events(const struct event_set *events, struct event_set *fallback) {
+    if (events)
+        return events;
+    event_set_default(fallback);
+    return fallback;
+}
+
+void send_window(int pipe_fd, const char *header, int n, const char *used_names[MAX_EVENTS],
+                 uint64_t window[MAX_EVENTS][PRINT_EVERY], int start,
+                 uint64_t exec_ns, uint64_t window_ns) {
+    char buffer[PIPE_BUF];
+    uint64_t sent_ns = latency_now();
+    latency_record(LAT_WINDOW, sent_ns - window_ns);
+
+    int len = snprintf(buffer, sizeof(buffer), "%s Samples %d–%d:\n", header, start, start + PRINT_EVERY - 1);
+    len += snprintf(buffer + len, sizeof(buffer) - len, "Time: exec=%" PRIu64 " window=%" PRIu64
+                    " sent=%" PRIu64 "\n", exec_ns, window_ns, sent_ns);
+    for (int i = 0; i < n && len < (int)sizeof(buffer); i++) {
+        len += snprintf(buffer + len, sizeof(buffer) - len, "Event: %-20s\n", used_names[i]);
+        for (int j = 0; j < PRINT_EVERY && len < (int)sizeof(buffer); j++) {
+            len += snprintf(buffer + len, sizeof(buffer) - len, "  [%02d] %" PRIu64 "\t",
+                            start + j, window[i][j]);
         }
+        if (len < (int)sizeof(buffer))
+            len += snprintf(buffer + len, sizeof(buffer) - len, "\n");
+    }
+    if (len >= (int)sizeof(buffer))
+        len = sizeof(buffer) - 1;
 
-        struct perf_event_attr attr = create_event_attr(types[i], configs[i]);
-        fds[i] = syscall(__NR_perf_event_open, &attr, target_pid, -1, -1, 0);
+    // 连同结尾的 '\0' 一次写出（不超过 PIPE_BUF，写入是原子的），接收端按 '\0' 切分窗口
+    ssize_t written = write(pipe_fd, buffer, len + 1);
+    if (written == -1) {
+        metrics_add(METRIC_WINDOWS_DROPPED, 1);
+        log_msg(LOG_WARN, "Failed to write to pipe: %s\n", strerror(errno));
+    } else {
+        metrics_add(METRIC_WINDOWS_SENT, 1);
+    }
+}
+
+void collect_perf_events(int target_pid, const struct event_set *events, uint64_t exec_ns, int pipe_fd) {
+    struct event_set fallback;
+    const struct event_set *set = resolve_events(events, &fallback);
+    int n = set->count;
+    int fds[MAX_EVENTS];
+    uint64_t window[MAX_EVENTS][PRINT_EVERY] = {0};
+    uint64_t prev_values[MAX_EVENTS] = {0};
+    const char *used_names[MAX_EVENTS];
+    char header[64];
+
+    for (int i = 0; i < n; i++) {
+        used_names[i] = set->events[i].name;
+        struct perf_event_attr attr = create_event_attr(set->events[i].type, set->events[i].config);
+        fds[i] = perf_open(&attr, target_pid, -1, -1, 0);
         if (fds[i] == -1) {
-            fprintf(stderr, "perf_event_open failed for %s: %s\n", used_names[i], strerror(errno));
+            log_msg(LOG_WARN, "perf_event_open failed for %s: %s\n", used_names[i], strerror(errno));
+            while (--i >= 0)
+                perf_close(fds[i]);
             return;
         }
 
         ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
         ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
     }
+    snprintf(header, sizeof(header), "[PID: %d]", target_pid);
+    uint64_t window_ns = latency_now();
+    if (exec_ns)
+        latency_record(LAT_EXEC_TO_COLLECT, window_ns - exec_ns);
 
     for (int sample = 0; sample < TOTAL_SAMPLES; sample++) {
+        if (sample % PRINT_EVERY == 0 && sample)
+            window_ns = latency_now();
         usleep(SAMPLE_INTERVAL_MS * 1000);
-        uint64_t current_values[TOTAL_EVENTS];
-        for (int i = 0; i < TOTAL_EVENTS; i++) {
+        uint64_t current_values[MAX_EVENTS];
+        for (int i = 0; i < n; i++) {
             ssize_t ret = read(fds[i], &current_values[i], sizeof(current_values[i]));
             if (ret != sizeof(current_values[i])) {
-                fprintf(stderr, "Failed to read perf event %s for PID %d: %s\n",
+                log_msg(LOG_WARN, "Failed to read perf event %s for PID %d: %s\n",
                         used_names[i], target_pid, strerror(errno));
-                continue;
-            }
-            if (sample > 0) {
-                values[i][sample] = current_values[i] - values[i][sample - 1];
-            } else {
-                values[i][sample] = current_values[i];
+                current_values[i] = prev_values[i];
             }
+            // 与数据集采集器一致：第 0 个样本记 0，之后为相邻两次读数之差
+            window[i][sample % PRINT_EVERY] = sample == 0 ? 0 : current_values[i] - prev_values[i];
+            prev_values[i] = current_values[i];
         }
 
         // 将数据格式化为字符串并通过管道传递
-        if ((sample + 1) % PRINT_EVERY == 0) {
-            int start = sample + 1 - PRINT_EVERY;
-            int len = snprintf(buffer, sizeof(buffer), "[PID: %d] Samples %d–%d:\n", target_pid, start, sample);
-            for (int i = 0; i < TOTAL_EVENTS; i++) {
-                len += snprintf(buffer + len, sizeof(buffer) - len, "Event: %-20s\n", used_names[i]);
-                for (int j = start; j <= sample; j++) {
-                    len += snprintf(buffer + len, sizeof(buffer) - len, "  [%02d] %" PRIu64 "\t", j, values[i][j]);
+        if ((sample + 1) % PRINT_EVERY == 0)
+            send_window(pipe_fd, header, n, used_names, window, sample + 1 - PRINT_EVERY,
+                        exec_ns, window_ns);
+    }
+
+    for (int i = 0; i < n; i++) {
+        ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        perf_close(fds[i]);
+    }
+}
+
+// 溢出驱动采样：以事件集的第一个事件（默认事件集为 branches）为组长，组长每计数
+// sample_period 次溢出一次，内核把整组计数写入 mmap 环形缓冲区，按批消费；每行是组长
+// 同一计数预算内各事件的增量，并按组长的实际增量归一化到 sample_period，不受 CPU 频率影响
+#define SAMPLED_RING_PAGES 8
+#define SAMPLED_TIMEOUT_MS 10000
+
+struct sample_read {
+    struct perf_event_header header;
+    uint64_t nr;
+    uint64_t values[MAX_EVENTS];
+};
+
+// 从环形缓冲区复制 len 字节（处理回绕）
+static void ring_copy(const char *data, uint64_t size, uint64_t offset, void *dst, size_t len) {
+    uint64_t pos = offset % size;
+    size_t first = len < size - pos ? len : size - pos;
+    memcpy(dst, data + pos, first);
+    if (first < len)
+        memcpy((char *)dst + first, data, len - first);
+}
+
+void collect_perf_events_sampled(int target_pid, const struct event_set *events,
+                                 uint64_t sample_period, uint64_t exec_ns, int pipe_fd) {
+    struct event_set fallback;
+    const struct event_set *set = resolve_events(events, &fallback);
+    int n = set->count;
+    int fds[MAX_EVENTS];
+    const char *used_names[MAX_EVENTS];
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t mmap_len = (SAMPLED_RING_PAGES + 1) * page_size;
+
+    for (int i = 0; i < n; i++)
+        fds[i] = -1;
+
+    for (int i = 0; i < n; i++) {
+        used_names[i] = set->events[i].name;
+        struct perf_event_attr attr = create_event_attr(set->events[i].type, set->events[i].config);
+        attr.disabled = (i == 0);
+        if (i == 0) {
+            attr.sample_period = sample_period;
+            attr.sample_type = PERF_SAMPLE_READ;
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.wakeup_events = PRINT_EVERY;
+        }
+        fds[i] = perf_open(&attr, target_pid, -1, i == 0 ? -1 : fds[0], 0);
+        if (fds[i] == -1) {
+            log_msg(LOG_WARN, "perf_event_open failed for %s: %s\n", used_names[i], strerror(errno));
+            goto out;
+        }
+    }
+
+    char *base = mmap(NULL, mmap_len, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    if (base == MAP_FAILED) {
+        log_msg(LOG_WARN, "mmap perf ring failed for PID %d: %s\n", target_pid, strerror(errno));
+        goto out;
+    }
+    struct perf_event_mmap_page *meta = (struct perf_event_mmap_page *)base;
+    const char *data = base + page_size;
+    uint64_t data_size = SAMPLED_RING_PAGES * page_size;
+
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    uint64_t window_ns = latency_now();
+    if (exec_ns)
+        latency_record(LAT_EXEC_TO_COLLECT, window_ns - exec_ns);
+
+    uint64_t window[MAX_EVENTS][PRINT_EVERY] = {0};
+    uint64_t prev[MAX_EVENTS] = {0};
+    int have_prev = 0;
+    int sample = 0;
+    int idle_ms = 0;
+    char header[64];
+    snprintf(header, sizeof(header), "[PID: %d]", target_pid);
+
+    while (!exiting && sample < TOTAL_SAMPLES && idle_ms < SAMPLED_TIMEOUT_MS) {
+        struct pollfd pfd = { .fd = fds[0], .events = POLLIN };
+        int ret = poll(&pfd, 1, 100);
+        if (ret < 0 && errno != EINTR)
+            break;
+        idle_ms = ret == 0 ? idle_ms + 100 : 0;
+
+        uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+        uint64_t tail = meta->data_tail;
+        while (tail < head && sample < TOTAL_SAMPLES) {
+            struct perf_event_header hdr;
+            ring_copy(data, data_size, tail, &hdr, sizeof(hdr));
+            size_t rec_size = offsetof(struct sample_read, values) + n * sizeof(uint64_t);
+            if (hdr.type == PERF_RECORD_SAMPLE && hdr.size >= rec_size) {
+                struct sample_read rec;
+                ring_copy(data, data_size, tail, &rec, rec_size);
+                if (rec.nr == (uint64_t)n) {
+                    if (have_prev) {
+                        uint64_t leader = rec.values[0] - prev[0];
+                        int row = sample % PRINT_EVERY;
+                        if (row == 0 && sample)
+                            window_ns = latency_now();
+                        for (int i = 0; i < n; i++) {
+                            uint64_t delta = rec.values[i] - prev[i];
+                            window[i][row] = leader ? (uint64_t)((double)delta * sample_period / leader) : delta;
+                        }
+                        sample++;
+                        if (sample % PRINT_EVERY == 0)
+                            send_window(pipe_fd, header, n, used_names, window, sample - PRINT_EVERY,
+                                        exec_ns, window_ns);
+                    }
+                    memcpy(prev, rec.values, n * sizeof(uint64_t));
+                    have_prev = 1;
                 }
-                len += snprintf(buffer + len, sizeof(buffer) - len, "\n");
+            } else if (hdr.type == PERF_RECORD_LOST) {
+                // 丢失样本后的下一条记录不能与上一条做差
+                have_prev = 0;
             }
-            
-            ssize_t written = write(pipe_fd, buffer, len);
-	    if (written == -1) {
-	        fprintf(stderr, "Failed to write to pipe: %s\n", strerror(errno));
-	    }
-	    
+            if (hdr.size == 0)
+                break;
+            tail += hdr.size;
+        }
+        __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+
+        // 目标进程退出
+        if (ret > 0 && (pfd.revents & POLLHUP))
+            break;
+    }
+
+    ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    munmap(base, mmap_len);
+
+out:
+    for (int i = n - 1; i >= 0; i--) {
+        if (fds[i] >= 0)
+            perf_close(fds[i]);
+    }
+}
+
+// cgroup 每个 CPU 上的计数器组（组长 + 成员，一次 read 取回全部事件）
+struct cgroup_group {
+    int fds[MAX_EVENTS];
+};
+
+struct group_read {
+    uint64_t nr;
+    uint64_t values[MAX_EVENTS];
+};
+
+static void close_cgroup_groups(struct cgroup_group *groups, int ncpus, int n) {
+    for (int c = 0; c < ncpus; c++) {
+        if (groups[c].fds[0] >= 0)
+            ioctl(groups[c].fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        for (int i = n - 1; i >= 0; i--) {
+            if (groups[c].fds[i] >= 0)
+                perf_close(groups[c].fds[i]);
         }
     }
+}
 
-    for (int i = 0; i < TOTAL_EVENTS; i++) {
-        ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
-        close(fds[i]);
+// 按 cgroup 采集：每个 CPU 打开一个 PERF_FLAG_PID_CGROUP 计数器组，
+// 各 CPU 的计数求和后按与进程模式相同的格式写入管道，直到程序退出
+void collect_cgroup_events(const char *cgroup_path, const struct event_set *events, int pipe_fd) {
+    struct event_set fallback;
+    const struct event_set *set = resolve_events(events, &fallback);
+    int n = set->count;
+    const char *used_names[MAX_EVENTS];
+
+    int cgroup_fd = open(cgroup_path, O_RDONLY | O_DIRECTORY);
+    if (cgroup_fd == -1) {
+        log_msg(LOG_ERROR, "Failed to open cgroup %s: %s\n", cgroup_path, strerror(errno));
+        return;
+    }
+    // cgroup v2 中目录 inode 即 cgroup id
+    struct stat st;
+    if (fstat(cgroup_fd, &st) == -1) {
+        log_msg(LOG_ERROR, "Failed to stat cgroup %s: %s\n", cgroup_path, strerror(errno));
+        close(cgroup_fd);
+        return;
+    }
+    uint64_t cgroup_id = st.st_ino;
+
+    for (int i = 0; i < n; i++)
+        used_names[i] = set->events[i].name;
+
+    int ncpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (ncpus <= 0)
+        ncpus = 1;
+    struct cgroup_group *groups = calloc(ncpus, sizeof(*groups));
+    if (!groups) {
+        log_msg(LOG_ERROR, "calloc cgroup groups: %s\n", strerror(errno));
+        close(cgroup_fd);
+        return;
+    }
+
+    int opened = 0;
+    for (int c = 0; c < ncpus; c++) {
+        for (int i = 0; i < n; i++)
+            groups[c].fds[i] = -1;
+
+        for (int i = 0; i < n; i++) {
+            struct perf_event_attr attr = create_event_attr(set->events[i].type, set->events[i].config);
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = (i == 0);
+            int group_fd = i == 0 ? -1 : groups[c].fds[0];
+            groups[c].fds[i] = perf_open(&attr, cgroup_fd, c, group_fd, PERF_FLAG_PID_CGROUP);
+            if (groups[c].fds[i] == -1)
+                break;
+        }
+
+        if (groups[c].fds[n - 1] == -1) {
+            // 离线 CPU 返回 ENODEV，直接跳过
+            if (errno != ENODEV)
+                log_msg(LOG_WARN, "perf_event_open failed for cgroup %s on CPU %d: %s\n",
+                        cgroup_path, c, strerror(errno));
+            for (int i = 0; i < n; i++) {
+                if (groups[c].fds[i] >= 0)
+                    perf_close(groups[c].fds[i]);
+                groups[c].fds[i] = -1;
+            }
+            continue;
+        }
+
+        ioctl(groups[c].fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(groups[c].fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        opened++;
+    }
+    close(cgroup_fd);
+
+    if (opened == 0) {
+        log_msg(LOG_ERROR, "No perf counters opened for cgroup %s\n", cgroup_path);
+        free(groups);
+        return;
+    }
+
+    uint64_t values[MAX_EVENTS][PRINT_EVERY] = {0};
+    uint64_t prev_totals[MAX_EVENTS] = {0};
+    size_t read_size = sizeof(uint64_t) * (n + 1);
+
+    uint64_t window_ns = latency_now();
+
+    // 第 0 次读取仅作为基准，不产生样本
+    for (int sample = -1; !exiting; sample++) {
+        if (sample > 0 && sample % PRINT_EVERY == 0)
+            window_ns = latency_now();
+        usleep(SAMPLE_INTERVAL_MS * 1000);
+        uint64_t totals[MAX_EVENTS] = {0};
+        for (int c = 0; c < ncpus; c++) {
+            if (groups[c].fds[0] < 0)
+                continue;
+            struct group_read gr;
+            ssize_t ret = read(groups[c].fds[0], &gr, read_size);
+            if (ret != (ssize_t)read_size || gr.nr != (uint64_t)n) {
+                log_msg(LOG_WARN, "Failed to read perf group for cgroup %s on CPU %d: %s\n",
+                        cgroup_path, c, strerror(errno));
+                continue;
+            }
+            for (int i = 0; i < n; i++)
+                totals[i] += gr.values[i];
+        }
+
+        if (sample >= 0) {
+            for (int i = 0; i < n; i++)
+                values[i][sample % PRINT_EVERY] = totals[i] - prev_totals[i];
+        }
+        memcpy(prev_totals, totals, sizeof(prev_totals));
+
+        if (sample < 0 || (sample + 1) % PRINT_EVERY != 0)
+            continue;
+
+        char header[64];
+        snprintf(header, sizeof(header), "[CGROUP: %" PRIu64 "]", cgroup_id);
+        send_window(pipe_fd, header, n, used_names, values, sample + 1 - PRINT_EVERY, 0, window_ns);
+    }
+
+    close_cgroup_groups(groups, ncpus, n);
+    free(groups);
+}
+
+// 自监控快速路径：计数器只统计调用线程，通过 mmap 用户页 + rdpmc 在用户态读取，
+// 无需系统调用；PMU 不支持用户态读取或事件未在本 CPU 上运行时回退到 read()
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t rdpmc(uint32_t counter) {
+    uint32_t low, high;
+    __asm__ volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(counter));
+    return low | ((uint64_t)high << 32);
+}
+#define HAVE_RDPMC 1
+#else
+#define HAVE_RDPMC 0
+#endif
+
+#define barrier() __asm__ volatile("" ::: "memory")
+
+static int read_self_counter(const struct perf_self_ctx *pc, int i, uint64_t *value) {
+    const struct perf_event_mmap_page *page = pc->pages[i];
+    uint32_t seq, idx;
+    uint64_t count;
+
+    if (page && page->cap_user_rdpmc && HAVE_RDPMC) {
+        do {
+            seq = page->lock;
+            barrier();
+            idx = page->index;
+            count = page->offset;
+            if (idx) {
+#if HAVE_RDPMC
+                uint64_t pmc = rdpmc(idx - 1);
+                uint16_t width = page->pmc_width;
+                // 符号扩展到 64 位
+                pmc <<= 64 - width;
+                count += (int64_t)pmc >> (64 - width);
+#endif
+            }
+            barrier();
+        } while (page->lock != seq);
+
+        if (idx) {
+            *value = count;
+            return 0;
+        }
+    }
+
+    if (read(pc->fds[i], value, sizeof(*value)) != sizeof(*value))
+        return -1;
+    return 0;
+}
+
+int perf_self_open(struct perf_self_ctx *pc, const struct event_set *events) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    struct event_set fallback;
+    const struct event_set *set = resolve_events(events, &fallback);
+
+    memset(pc, 0, sizeof(*pc));
+    for (int i = 0; i < MAX_EVENTS; i++)
+        pc->fds[i] = -1;
+    pc->count = set->count;
+
+    for (int i = 0; i < pc->count; i++) {
+        snprintf(pc->names[i], sizeof(pc->names[i]), "%s", set->events[i].name);
+        struct perf_event_attr attr = create_event_attr(set->events[i].type, set->events[i].config);
+        attr.pinned = 1;
+        pc->fds[i] = perf_open(&attr, 0, -1, -1, 0);
+        if (pc->fds[i] == -1) {
+            fprintf(stderr, "perf_event_open failed for %s: %s\n", pc->names[i], strerror(errno));
+            goto fail;
+        }
+
+        void *page = mmap(NULL, page_size, PROT_READ, MAP_SHARED, pc->fds[i], 0);
+        if (page == MAP_FAILED) {
+            // 没有用户页时仍可用 read() 读取
+            fprintf(stderr, "mmap perf page failed for %s: %s\n", pc->names[i], strerror(errno));
+            page = NULL;
+        }
+        pc->pages[i] = page;
+        if (!page || !pc->pages[i]->cap_user_rdpmc || !HAVE_RDPMC)
+            pc->slow_path = 1;
+
+        ioctl(pc->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(pc->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return 0;
+
+fail:
+    perf_self_close(pc);
+    return -1;
+}
+
+int perf_self_read(const struct perf_self_ctx *pc, uint64_t values[MAX_EVENTS]) {
+    for (int i = 0; i < pc->count; i++) {
+        if (read_self_counter(pc, i, &values[i]) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+void perf_self_close(struct perf_self_ctx *pc) {
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    for (int i = 0; i < MAX_EVENTS; i++) {
+        if (pc->pages[i])
+            munmap(pc->pages[i], page_size);
+        if (pc->fds[i] >= 0) {
+            ioctl(pc->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            perf_close(pc->fds[i]);
+        }
+        pc->pages[i] = NULL;
+        pc->fds[i] = -1;
     }
 }
 
 /*int main(int argc, char *argv[]){
     int target_pid = atoi(argv[1]);
-    const char *events[] = {"instructions", "cycles", "branch-instructions", "branch-misses"};
-    collect_perf_events(target_pid, events);
+    struct event_set events;
+    event_set_parse(&events, "instructions,cycles,branch-instructions,branch-misses");
+    collect_perf_events(target_pid, &events, STDOUT_FILENO);
     return 0;
 }*/
@@ -1,9 +1,35 @@
 #ifndef COLLECT_H
 #define COLLECT_H
 
-#define TOTAL_EVENTS 4
+#include <stdint.h>
+#include "event_set.h"
+
 #define TOTAL_SAMPLES 30
+#define PRINT_EVERY 10      // 每个窗口的样本数
+
+// 自监控计数器（只统计调用线程），见 perf_self_open
+struct perf_self_ctx {
+    int count;
+    int fds[MAX_EVENTS];
+    struct perf_event_mmap_page *pages[MAX_EVENTS];
+    char names[MAX_EVENTS][EVENT_NAME_LEN];
+    int slow_path;          // 1 表示至少一个计数器只能通过 read() 读取
+};
+
+// events 为 NULL 时使用默认事件集；exec_ns 为 BPF 记录的 execve 时间，0 表示未知
+void collect_perf_events(int target_pid, const struct event_set *events, uint64_t exec_ns, int pipe_fd);
+void collect_perf_events_sampled(int target_pid, const struct event_set *events,
+                                 uint64_t sample_period, uint64_t exec_ns, int pipe_fd);
+void collect_cgroup_events(const char *cgroup_path, const struct event_set *events, int pipe_fd);
+
+// 把一个窗口（PRINT_EVERY 个样本）按管道文本格式写出，以 '\0' 结尾。
+// Time 行携带 exec 时间、窗口首个样本时间和写出时间，供接收端统计延迟
+void send_window(int pipe_fd, const char *header, int n, const char *used_names[MAX_EVENTS],
+                 uint64_t window[MAX_EVENTS][PRINT_EVERY], int start,
+                 uint64_t exec_ns, uint64_t window_ns);
 
-void collect_perf_events(int target_pid, const char *events[TOTAL_EVENTS], int pipe_fd);
+int perf_self_open(struct perf_self_ctx *pc, const struct event_set *events);
+int perf_self_read(const struct perf_self_ctx *pc, uint64_t values[MAX_EVENTS]);
+void perf_self_close(struct perf_self_ctx *pc);
 
 #endif
@@ -5,10 +5,13 @@
 #include <signal.h> // 添加 signal.h 以定义 sig_atomic_t
 
 #define MAX_PIDS 1024
+#define MAX_CGROUPS 64
 
 extern volatile sig_atomic_t exiting;
+// 采集管道槽位，fd 为 -1 表示该端已关闭；两端都关闭的槽位可被复用
 extern int pipe_fds[MAX_PIDS][2];
 extern int pipe_count;
+extern unsigned int pipe_generation;   // 槽位变化时递增，接收线程据此重建 poll 集合
 extern pthread_mutex_t pipe_mutex;
 
 #endif
@@ -0,0 +1,379 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "corpus.h"
+#include "dataset.h"
+
+#define MIN_CAPACITY 1024
+
+static const char *status_names[] = { "pending", "running", "done", "timeout", "failed" };
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t file_size(uint32_t capacity) {
+    return sizeof(struct corpus_header) + (size_t)capacity * (sizeof(struct corpus_entry) + sizeof(uint32_t));
+}
+
+// 在一块完整的文件映像上设置各区域指针
+static void layout(struct corpus *c, void *base, uint32_t capacity) {
+    c->header = base;
+    c->slots = (struct corpus_entry *)((uint8_t *)base + sizeof(struct corpus_header));
+    c->by_id = (uint32_t *)(c->slots + capacity);
+}
+
+// 样本哈希本身是均匀分布的，直接取前 8 字节作为散列值
+static uint32_t home_slot(const struct corpus *c, const uint8_t *hash) {
+    uint64_t h;
+    memcpy(&h, hash, sizeof(h));
+    return (uint32_t)(h ^ (h >> 32)) & (c->header->capacity - 1);
+}
+
+struct corpus_entry *corpus_find(const struct corpus *c, const uint8_t *hash) {
+    uint32_t mask = c->header->capacity - 1;
+    for (uint32_t i = home_slot(c, hash);; i = (i + 1) & mask) {
+        struct corpus_entry *e = &c->slots[i];
+        if (e->id == 0)
+            return NULL;
+        if (memcmp(e->hash, hash, CORPUS_HASH_LEN) == 0)
+            return e;
+    }
+}
+
+struct corpus_entry *corpus_by_id(const struct corpus *c, uint32_t id) {
+    if (id >= c->header->capacity || c->by_id[id] == 0)
+        return NULL;
+    return &c->slots[c->by_id[id] - 1];
+}
+
+struct corpus_entry *corpus_slot(const struct corpus *c, uint32_t i) {
+    if (i >= c->header->capacity || c->slots[i].id == 0)
+        return NULL;
+    return &c->slots[i];
+}
+
+const char *corpus_family(const struct corpus *c, const struct corpus_entry *e) {
+    if (e->family == 0 || e->family >= c->header->family_count)
+        return "";
+    return c->header->families[e->family];
+}
+
+const char *corpus_status_name(int status) {
+    if (status < 0 || status > CORPUS_FAILED)
+        return "?";
+    return status_names[status];
+}
+
+int corpus_status_parse(const char *name) {
+    for (int i = 0; i <= CORPUS_FAILED; i++) {
+        if (strcmp(name, status_names[i]) == 0)
+            return i;
+    }
+    fprintf(stderr, "未知的采集状态: %s\n", name);
+    return -1;
+}
+
+int corpus_needs_collect(const struct corpus_entry *e) {
+    return e->status == CORPUS_PENDING || e->status == CORPUS_RUNNING || e->status == CORPUS_FAILED;
+}
+
+void corpus_set_status(struct corpus_entry *e, enum corpus_status status) {
+    e->status = status;
+    e->updated_ns = realtime_ns();
+}
+
+size_t corpus_recover(struct corpus *c) {
+    size_t n = 0;
+    for (uint32_t i = 0; i < c->header->capacity; i++) {
+        if (c->slots[i].id && c->slots[i].status == CORPUS_RUNNING) {
+            corpus_set_status(&c->slots[i], CORPUS_PENDING);
+            n++;
+        }
+    }
+    return n;
+}
+
+static struct corpus_entry *insert(struct corpus *c, const uint8_t *hash, uint32_t id) {
+    uint32_t mask = c->header->capacity - 1;
+    uint32_t i = home_slot(c, hash);
+    while (c->slots[i].id != 0) {
+        if (memcmp(c->slots[i].hash, hash, CORPUS_HASH_LEN) == 0)
+            return NULL;
+        i = (i + 1) & mask;
+    }
+    struct corpus_entry *e = &c->slots[i];
+    memcpy(e->hash, hash, CORPUS_HASH_LEN);
+    e->id = id;
+    e->label = CORPUS_LABEL_UNKNOWN;
+    c->by_id[id] = i + 1;
+    c->header->count++;
+    return e;
+}
+
+static uint16_t intern_family(struct corpus *c, const char *name) {
+    struct corpus_header *h = c->header;
+    if (!*name)
+        return 0;
+    for (uint32_t i = 1; i < h->family_count; i++) {
+        if (strcmp(h->families[i], name) == 0)
+            return i;
+    }
+    if (h->family_count == CORPUS_MAX_FAMILIES) {
+        fprintf(stderr, "家族数超过上限 %d，%s 记为未知\n", CORPUS_MAX_FAMILIES, name);
+        return 0;
+    }
+    snprintf(h->families[h->family_count], CORPUS_FAMILY_LEN, "%s", name);
+    return h->family_count++;
+}
+
+struct mapping_item {
+    uint8_t hash[CORPUS_HASH_LEN];
+    uint32_t id;
+};
+
+// 读取 md5_mapping.txt 的全部 "哈希,样本号" 行
+static struct mapping_item *load_mapping(const char *path, size_t *count, uint32_t *max_id) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "打开映射文件 %s 失败: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct mapping_item *items = NULL;
+    size_t capacity = 0;
+    char line[256], hex[CORPUS_HASH_LEN * 2 + 2];
+    unsigned int id;
+    *count = 0;
+    *max_id = 0;
+    while (fgets(line, sizeof(line), file)) {
+        struct mapping_item item;
+        // 表头和无法解析的行跳过，样本号 0 保留为空槽
+        if (sscanf(line, "%65[0-9a-fA-F],%u", hex, &id) != 2 || id == 0 || kds_hash_parse(hex, item.hash) != 0)
+            continue;
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 4096;
+            struct mapping_item *grown = realloc(items, capacity * sizeof(*items));
+            if (!grown) {
+                perror("realloc");
+                free(items);
+                fclose(file);
+                return NULL;
+            }
+            items = grown;
+        }
+        item.id = id;
+        items[(*count)++] = item;
+        if (id > *max_id)
+            *max_id = id;
+    }
+    fclose(file);
+    if (*count == 0) {
+        fprintf(stderr, "映射文件 %s 中没有有效条目\n", path);
+        free(items);
+        return NULL;
+    }
+    return items;
+}
+
+// 标签文件：哈希,标签[,家族]
+static int apply_labels(struct corpus *c, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "打开标签文件 %s 失败: %s\n", path, strerror(errno));
+        return -1;
+    }
+    char line[512];
+    size_t applied = 0, unknown = 0;
+    while (fgets(line, sizeof(line), file)) {
+        char *save, *hex = strtok_r(line, ",\r\n", &save);
+        char *label = strtok_r(NULL, ",\r\n", &save);
+        char *family = strtok_r(NULL, ",\r\n", &save);
+        uint8_t hash[CORPUS_HASH_LEN];
+        if (!hex || !label || kds_hash_parse(hex, hash) != 0)
+            continue;
+        struct corpus_entry *e = corpus_find(c, hash);
+        if (!e) {
+            unknown++;
+            continue;
+        }
+        if (strcmp(label, "0") == 0 || strcmp(label, "benign") == 0)
+            e->label = 0;
+        else if (strcmp(label, "1") == 0 || strcmp(label, "malicious") == 0)
+            e->label = 1;
+        if (family)
+            e->family = intern_family(c, family);
+        applied++;
+    }
+    fclose(file);
+    printf("标签文件 %s：%zu 条已应用，%zu 条不在映射中\n", path, applied, unknown);
+    return 0;
+}
+
+// 从旧索引继承同一哈希的采集状态（标签文件未给出时也继承标签和家族）
+static void merge_previous(struct corpus *c, const char *path, int have_labels) {
+    struct corpus *old = corpus_open(path, 0);
+    if (!old)
+        return;
+    size_t kept = 0;
+    for (uint32_t i = 0; i < old->header->capacity; i++) {
+        const struct corpus_entry *o = corpus_slot(old, i);
+        struct corpus_entry *e = o ? corpus_find(c, o->hash) : NULL;
+        if (!e)
+            continue;
+        e->status = o->status;
+        e->attempts = o->attempts;
+        e->processes = o->processes;
+        e->data_offset = o->data_offset;
+        e->data_end = o->data_end;
+        e->updated_ns = o->updated_ns;
+        if (!have_labels) {
+            e->label = o->label;
+            e->family = intern_family(c, corpus_family(old, o));
+        }
+        kept++;
+    }
+    corpus_close(old);
+    printf("从已有索引继承 %zu 个样本的状态\n", kept);
+}
+
+int corpus_build(const char *path, const char *mapping_path, const char *labels_path) {
+    size_t n;
+    uint32_t max_id;
+    struct mapping_item *items = load_mapping(mapping_path, &n, &max_id);
+    if (!items)
+        return -1;
+
+    uint32_t capacity = MIN_CAPACITY;
+    while (capacity < 2 * n || capacity <= max_id)
+        capacity *= 2;
+    size_t size = file_size(capacity);
+    void *image = calloc(1, size);
+    if (!image) {
+        perror("calloc");
+        free(items);
+        return -1;
+    }
+    struct corpus c = { .fd = -1, .size = size };
+    layout(&c, image, capacity);
+    memcpy(c.header->magic, CORPUS_MAGIC, sizeof(c.header->magic));
+    c.header->version = CORPUS_VERSION;
+    c.header->capacity = capacity;
+    c.header->family_count = 1;
+    c.header->created_ns = realtime_ns();
+
+    size_t duplicates = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (c.by_id[items[i].id] != 0 || !insert(&c, items[i].hash, items[i].id))
+            duplicates++;
+    }
+    free(items);
+    if (duplicates)
+        fprintf(stderr, "警告：映射文件中 %zu 条重复的哈希或样本号被忽略\n", duplicates);
+
+    int ret = labels_path ? apply_labels(&c, labels_path) : 0;
+    if (ret == 0)
+        merge_previous(&c, path, labels_path != NULL);
+
+    // 先写临时文件再改名，构建中途失败不影响已有索引
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    int fd = ret == 0 ? open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) : -1;
+    if (ret == 0 && fd == -1) {
+        fprintf(stderr, "创建 %s 失败: %s\n", tmp_path, strerror(errno));
+        ret = -1;
+    }
+    if (fd != -1) {
+        const uint8_t *p = image;
+        size_t left = size;
+        while (left > 0) {
+            ssize_t written = write(fd, p, left);
+            if (written <= 0) {
+                fprintf(stderr, "写入 %s 失败: %s\n", tmp_path, strerror(errno));
+                ret = -1;
+                break;
+            }
+            p += written;
+            left -= written;
+        }
+        if (ret == 0 && fsync(fd) != 0)
+            ret = -1;
+        close(fd);
+        if (ret == 0 && rename(tmp_path, path) != 0) {
+            fprintf(stderr, "重命名 %s 失败: %s\n", tmp_path, strerror(errno));
+            ret = -1;
+        }
+        if (ret != 0)
+            unlink(tmp_path);
+    }
+    if (ret == 0)
+        printf("索引 %s：%u 个样本，%u 个家族，容量 %u\n", path, c.header->count, c.header->family_count - 1,
+               capacity);
+    free(image);
+    return ret;
+}
+
+struct corpus *corpus_open(const char *path, int writable) {
+    int fd = open(path, (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd == -1) {
+        if (writable || errno != ENOENT)
+            fprintf(stderr, "打开索引 %s 失败: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct corpus_header)) {
+        fprintf(stderr, "%s 不是有效的样本库索引\n", path);
+        close(fd);
+        return NULL;
+    }
+    void *base = mmap(NULL, st.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "映射 %s 失败: %s\n", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    const struct corpus_header *h = base;
+    if (memcmp(h->magic, CORPUS_MAGIC, sizeof(h->magic)) != 0 || h->version != CORPUS_VERSION ||
+        h->capacity < MIN_CAPACITY || (h->capacity & (h->capacity - 1)) != 0 ||
+        (size_t)st.st_size != file_size(h->capacity) || h->family_count > CORPUS_MAX_FAMILIES) {
+        fprintf(stderr, "%s 不是有效的样本库索引\n", path);
+        munmap(base, st.st_size);
+        close(fd);
+        return NULL;
+    }
+    struct corpus *c = calloc(1, sizeof(*c));
+    if (!c) {
+        perror("calloc");
+        munmap(base, st.st_size);
+        close(fd);
+        return NULL;
+    }
+    c->fd = fd;
+    c->size = st.st_size;
+    layout(c, base, h->capacity);
+    return c;
+}
+
+int corpus_sync(struct corpus *c) {
+    if (msync(c->header, c->size, MS_SYNC) != 0) {
+        fprintf(stderr, "同步索引失败: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+void corpus_close(struct corpus *c) {
+    if (!c)
+        return;
+    munmap(c->header, c->size);
+    close(c->fd);
+    free(c);
+}
@@ -0,0 +1,104 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 样本库索引（.kci）：由 rename.py 生成的 md5_mapping.txt（哈希 -> 样本号）和可选的标签文件
+// 建立，记录每个样本的标签、家族、采集状态和数据位置。文件整体 mmap（MAP_SHARED），
+// 采集器直接在映射上更新状态，进程崩溃后已写入的状态仍在页缓存中，下次运行据此续采。
+//
+//   文件头   struct corpus_header，含家族名表
+//   槽位     capacity 个 struct corpus_entry，按哈希开放寻址（线性探测），样本号为 0 的是空槽
+//   样本号表 capacity 个 u32，第 id 项为该样本所在槽位 + 1（0 表示无），按样本号 O(1) 查找
+//
+// capacity 为 2 的幂，不小于条目数的两倍且大于最大样本号。
+// 同一索引同一时间只应由一个采集器更新。C++ 代码可直接包含本头文件。
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CORPUS_MAGIC "KLEBCIX1"
+#define CORPUS_VERSION 1
+#define CORPUS_HASH_LEN 32              // 与 KDS_HASH_LEN 相同
+#define CORPUS_FAMILY_LEN 32
+#define CORPUS_MAX_FAMILIES 1024
+#define CORPUS_LABEL_UNKNOWN 0xff
+
+enum corpus_status {
+    CORPUS_PENDING = 0,     // 未采集
+    CORPUS_RUNNING,         // 采集中；打开索引时视为被中断，重新采集
+    CORPUS_DONE,
+    CORPUS_TIMEOUT,         // 超时终止，已有数据
+    CORPUS_FAILED,          // 样本缺失或启动失败
+};
+
+struct corpus_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t family_count;                      // 家族 0 保留为未知
+    uint64_t created_ns;                        // CLOCK_REALTIME
+    char families[CORPUS_MAX_FAMILIES][CORPUS_FAMILY_LEN];
+};
+
+struct corpus_entry {
+    uint8_t hash[CORPUS_HASH_LEN];
+    uint32_t id;
+    uint8_t label;              // 0 良性，1 恶意，CORPUS_LABEL_UNKNOWN 未知
+    uint8_t status;             // enum corpus_status
+    uint16_t family;
+    uint16_t attempts;          // 开始采集的次数
+    uint16_t processes;         // 最近一次采集的进程数
+    uint32_t pad;
+    uint64_t data_offset;       // 最近一次采集开始时数据集的写入位置，该次的分块都在
+    uint64_t data_end;          // [data_offset, data_end) 内，但区间里也有并发采集的其他样本的分块；
+                                // 该次的分块以 attempt == (uint8_t)attempts 区分。CSV 输出时为 0
+    uint64_t updated_ns;        // 最近一次状态变化（CLOCK_REALTIME）
+};
+
+struct corpus {
+    int fd;
+    size_t size;
+    struct corpus_header *header;
+    struct corpus_entry *slots;
+    uint32_t *by_id;
+};
+
+// 由映射文件建立索引。labels_path 可为 NULL，格式为每行 "哈希,标签[,家族]"（标签 0/1 或
+// benign/malicious）。path 已存在时保留同一哈希的采集状态，新的映射文件可以增删样本
+int corpus_build(const char *path, const char *mapping_path, const char *labels_path);
+
+// 打开索引（读写映射）。writable 为 0 时只读
+struct corpus *corpus_open(const char *path, int writable);
+void corpus_close(struct corpus *c);
+
+// 把修改同步到磁盘。映射上的修改在进程崩溃后仍保留在页缓存中，只有防断电时才需要调用
+int corpus_sync(struct corpus *c);
+
+struct corpus_entry *corpus_find(const struct corpus *c, const uint8_t *hash);
+struct corpus_entry *corpus_by_id(const struct corpus *c, uint32_t id);
+
+// 第 i 个槽位，空槽返回 NULL，用于遍历
+struct corpus_entry *corpus_slot(const struct corpus *c, uint32_t i);
+
+const char *corpus_family(const struct corpus *c, const struct corpus_entry *e);
+const char *corpus_status_name(int status);
+int corpus_status_parse(const char *name);
+
+// 把中断时仍为 RUNNING 的条目恢复为 PENDING，返回条数
+size_t corpus_recover(struct corpus *c);
+
+// 是否还需要采集（PENDING、RUNNING 和 FAILED）
+int corpus_needs_collect(const struct corpus_entry *e);
+
+// 更新状态和时间戳
+void corpus_set_status(struct corpus_entry *e, enum corpus_status status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include "corpus.h"
+#include "dataset.h"
+
+// 样本库索引工具：
+//   corpus_tool build [-L 标签文件] <索引> <md5_mapping.txt>   建立或更新索引（保留已有采集状态）
+//   corpus_tool info <索引>                                    各状态、标签、家族的样本数
+//   corpus_tool list <索引> [状态]                              每个样本一行，按样本号排序
+//   corpus_tool get <索引> <样本号|哈希>                         单个样本
+//   corpus_tool reset <索引> <状态>...                          把这些状态的样本改回 pending 以便重新采集
+
+static void usage(void) {
+    fprintf(stderr,
+            "用法: corpus_tool build [-L 标签文件] <索引> <md5_mapping.txt>\n"
+            "      corpus_tool info <索引>\n"
+            "      corpus_tool list <索引> [pending|running|done|timeout|failed]\n"
+            "      corpus_tool get <索引> <样本号|哈希>\n"
+            "      corpus_tool reset <索引> <状态>...\n"
+            "  标签文件每行为 \"哈希,标签[,家族]\"，标签为 0/1 或 benign/malicious\n");
+}
+
+static void print_entry(const struct corpus *c, const struct corpus_entry *e) {
+    char hex[CORPUS_HASH_LEN * 2 + 1];
+    kds_hash_format(e->hash, hex, sizeof(hex));
+    char label[8];
+    if (e->label == CORPUS_LABEL_UNKNOWN)
+        snprintf(label, sizeof(label), "?");
+    else
+        snprintf(label, sizeof(label), "%u", e->label);
+    printf("%u,%s,%s,%s,%s,%u,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", e->id, hex, label,
+           corpus_family(c, e), corpus_status_name(e->status), e->attempts, e->processes, e->data_offset,
+           e->data_end, e->updated_ns);
+}
+
+static const char *list_header = "id,hash,label,family,status,attempts,processes,data_offset,data_end,updated_ns\n";
+
+static int cmd_build(int argc, char **argv) {
+    const char *labels_path = NULL;
+    int opt;
+    optind = 1;
+    while ((opt = getopt(argc, argv, "L:")) != -1) {
+        if (opt != 'L') {
+            usage();
+            return 1;
+        }
+        labels_path = optarg;
+    }
+    if (argc - optind != 2) {
+        usage();
+        return 1;
+    }
+    return corpus_build(argv[optind], argv[optind + 1], labels_path) == 0 ? 0 : 1;
+}
+
+static int cmd_info(const char *path) {
+    struct corpus *c = corpus_open(path, 0);
+    if (!c)
+        return 1;
+    size_t by_status[CORPUS_FAILED + 1] = {0}, benign = 0, malicious = 0, unknown = 0;
+    size_t *by_family = calloc(c->header->family_count, sizeof(size_t));
+    for (uint32_t i = 0; i < c->header->capacity; i++) {
+        const struct corpus_entry *e = corpus_slot(c, i);
+        if (!e)
+            continue;
+        if (e->status <= CORPUS_FAILED)
+            by_status[e->status]++;
+        if (e->label == 0)
+            benign++;
+        else if (e->label == 1)
+            malicious++;
+        else
+            unknown++;
+        if (by_family && e->family < c->header->family_count)
+            by_family[e->family]++;
+    }
+    printf("样本 %u（良性 %zu，恶意 %zu，未知 %zu），容量 %u\n", c->header->count, benign, malicious, unknown,
+           c->header->capacity);
+    printf("状态:");
+    for (int s = 0; s <= CORPUS_FAILED; s++)
+        printf(" %s %zu", corpus_status_name(s), by_status[s]);
+    printf("\n");
+    if (by_family && c->header->family_count > 1) {
+        printf("家族:");
+        for (uint32_t f = 1; f < c->header->family_count; f++)
+            printf(" %s %zu", c->header->families[f], by_family[f]);
+        printf("\n");
+    }
+    free(by_family);
+    corpus_close(c);
+    return 0;
+}
+
+static int cmd_list(const char *path, const char *status_name) {
+    int status = status_name ? corpus_status_parse(status_name) : -1;
+    if (status_name && status < 0)
+        return 1;
+    struct corpus *c = corpus_open(path, 0);
+    if (!c)
+        return 1;
+    printf("%s", list_header);
+    for (uint32_t id = 0; id < c->header->capacity; id++) {
+        const struct corpus_entry *e = corpus_by_id(c, id);
+        if (e && (status < 0 || e->status == status))
+            print_entry(c, e);
+    }
+    corpus_close(c);
+    return 0;
+}
+
+static int cmd_get(const char *path, const char *key) {
+    struct corpus *c = corpus_open(path, 0);
+    if (!c)
+        return 1;
+    // 不超过 10 位的纯数字按样本号查找，否则按哈希
+    const struct corpus_entry *e = NULL;
+    uint8_t hash[CORPUS_HASH_LEN];
+    if (strlen(key) <= 10 && strspn(key, "0123456789") == strlen(key))
+        e = corpus_by_id(c, strtoul(key, NULL, 10));
+    else if (kds_hash_parse(key, hash) == 0)
+        e = corpus_find(c, hash);
+    if (e) {
+        printf("%s", list_header);
+        print_entry(c, e);
+    } else {
+        fprintf(stderr, "索引中没有 %s\n", key);
+    }
+    corpus_close(c);
+    return e ? 0 : 1;
+}
+
+static int cmd_reset(const char *path, int argc, char **argv) {
+    int reset[CORPUS_FAILED + 1] = {0};
+    for (int i = 0; i < argc; i++) {
+        int s = corpus_status_parse(argv[i]);
+        if (s < 0)
+            return 1;
+        reset[s] = 1;
+    }
+    struct corpus *c = corpus_open(path, 1);
+    if (!c)
+        return 1;
+    size_t n = 0;
+    for (uint32_t i = 0; i < c->header->capacity; i++) {
+        struct corpus_entry *e = corpus_slot(c, i);
+        if (e && e->status <= CORPUS_FAILED && reset[e->status] && e->status != CORPUS_PENDING) {
+            corpus_set_status(e, CORPUS_PENDING);
+            n++;
+        }
+    }
+    int ret = corpus_sync(c);
+    corpus_close(c);
+    printf("%zu 个样本改为 pending\n", n);
+    return ret == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    const char *cmd = argv[1];
+    if (strcmp(cmd, "build") == 0)
+        return cmd_build(argc - 1, argv + 1);
+    if (strcmp(cmd, "info") == 0)
+        return cmd_info(argv[2]);
+    if (strcmp(cmd, "list") == 0)
+        return cmd_list(argv[2], argc >= 4 ? argv[3] : NULL);
+    if (strcmp(cmd, "get") == 0 && argc >= 4)
+        return cmd_get(argv[2], argv[3]);
+    if (strcmp(cmd, "reset") == 0 && argc >= 4)
+        return cmd_reset(argv[2], argc - 3, argv + 3);
+    usage();
+    return 1;
+}
@@ -0,0 +1,642 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+#include "dataset.h"
+
+#define ZSTD_LEVEL 3
+
+struct kds_writer {
+    int fd;
+    enum kds_codec codec;
+    int columns;
+    pthread_mutex_t lock;
+    uint64_t end;           // 下一块的写入位置
+    uint64_t *offsets;
+    size_t count;
+    size_t capacity;
+};
+
+struct kds_reader {
+    const uint8_t *base;
+    size_t size;
+    const struct kds_header *header;
+    const struct kds_chunk **chunks;    // 按 (sample_id, pid) 排序
+    size_t *by_hash;                    // chunks 的下标，按哈希排序
+    size_t count;
+    size_t superseded;
+};
+
+static uint64_t pad8(uint64_t n) {
+    return (n + 7) & ~(uint64_t)7;
+}
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int codec_supported(int codec) {
+    switch (codec) {
+    case KDS_CODEC_NONE:
+        return 1;
+#ifdef HAVE_ZSTD
+    case KDS_CODEC_ZSTD:
+        return 1;
+#endif
+#ifdef HAVE_LZ4
+    case KDS_CODEC_LZ4:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+int kds_codec_parse(const char *name) {
+    static const char *names[] = { "none", "zstd", "lz4" };
+    for (int i = 0; i < 3; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            if (!codec_supported(i)) {
+                fprintf(stderr, "未编译 %s 压缩支持\n", name);
+                return -1;
+            }
+            return i;
+        }
+    }
+    fprintf(stderr, "未知的压缩方式: %s\n", name);
+    return -1;
+}
+
+const char *kds_codec_name(int codec) {
+    switch (codec) {
+    case KDS_CODEC_NONE: return "none";
+    case KDS_CODEC_ZSTD: return "zstd";
+    case KDS_CODEC_LZ4: return "lz4";
+    default: return "?";
+    }
+}
+
+int kds_hash_parse(const char *hex, uint8_t *hash) {
+    size_t len = strlen(hex);
+    if (len == 0 || len > KDS_HASH_LEN * 2 || len % 2)
+        return -1;
+    memset(hash, 0, KDS_HASH_LEN);
+    for (size_t i = 0; i < len / 2; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1)
+            return -1;
+        hash[i] = byte;
+    }
+    return 0;
+}
+
+void kds_hash_format(const uint8_t *hash, char *out, size_t out_len) {
+    // md5 的后半部分为 0，不输出
+    size_t len = KDS_HASH_LEN;
+    while (len > 16 && hash[len - 1] == 0)
+        len--;
+    if (len == 16) {
+        int zero = 1;
+        for (size_t i = 0; i < 16 && zero; i++)
+            zero = hash[i] == 0;
+        if (zero)
+            len = 0;
+    }
+    size_t pos = 0;
+    for (size_t i = 0; i < len && pos + 3 <= out_len; i++)
+        pos += snprintf(out + pos, out_len - pos, "%02x", hash[i]);
+    if (out_len > 0)
+        out[pos < out_len ? pos : out_len - 1] = '\0';
+}
+
+uint8_t *kds_mapping_load(const char *path, uint32_t *count) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "打开映射文件 %s 失败: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    uint8_t *hashes = NULL;
+    uint32_t capacity = 0;
+    char line[256], hex[KDS_HASH_LEN * 2 + 2];
+    unsigned int id;
+    *count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        // 表头和无法解析的行跳过
+        uint8_t hash[KDS_HASH_LEN];
+        if (sscanf(line, "%65[0-9a-fA-F],%u", hex, &id) != 2 || kds_hash_parse(hex, hash) != 0)
+            continue;
+        if (id >= capacity) {
+            uint32_t grown_capacity = capacity ? capacity : 1024;
+            while (grown_capacity <= id)
+                grown_capacity *= 2;
+            uint8_t *grown = realloc(hashes, (size_t)grown_capacity * KDS_HASH_LEN);
+            if (!grown) {
+                perror("realloc");
+                free(hashes);
+                fclose(file);
+                return NULL;
+            }
+            memset(grown + (size_t)capacity * KDS_HASH_LEN, 0,
+                   (size_t)(grown_capacity - capacity) * KDS_HASH_LEN);
+            hashes = grown;
+            capacity = grown_capacity;
+        }
+        memcpy(hashes + (size_t)id * KDS_HASH_LEN, hash, KDS_HASH_LEN);
+        if (id >= *count)
+            *count = id + 1;
+    }
+    fclose(file);
+    if (!hashes)
+        fprintf(stderr, "映射文件 %s 中没有有效条目\n", path);
+    return hashes;
+}
+
+// 校验 offset 处的分块头，返回下一块的位置，无效或截断时返回 0
+static uint64_t check_chunk(const uint8_t *base, uint64_t size, uint64_t offset, int columns) {
+    if (offset + sizeof(struct kds_chunk) > size)
+        return 0;
+    const struct kds_chunk *c = (const struct kds_chunk *)(base + offset);
+    if (c->magic != KDS_CHUNK_MAGIC || c->columns != columns || c->codec > KDS_CODEC_LZ4)
+        return 0;
+    if (c->codec == KDS_CODEC_NONE && c->stored_size != (uint64_t)c->columns * c->rows * sizeof(uint64_t))
+        return 0;
+    uint64_t next = offset + sizeof(*c) + pad8(c->stored_size);
+    return next <= size ? next : 0;
+}
+
+// 从文件头之后顺序扫描分块，返回块数；*end 为最后一个有效块之后的位置
+static size_t scan_chunks(const uint8_t *base, uint64_t size, int columns, uint64_t **offsets,
+                          uint64_t *end) {
+    size_t count = 0, capacity = 0;
+    uint64_t offset = sizeof(struct kds_header), next;
+    *offsets = NULL;
+    while ((next = check_chunk(base, size, offset, columns)) != 0) {
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            uint64_t *grown = realloc(*offsets, capacity * sizeof(uint64_t));
+            if (!grown)
+                break;
+            *offsets = grown;
+        }
+        (*offsets)[count++] = offset;
+        offset = next;
+    }
+    *end = offset;
+    return count;
+}
+
+// 文件末尾的索引，无效时返回 -1
+static int load_index(const uint8_t *base, uint64_t size, int columns, uint64_t **offsets,
+                      size_t *count) {
+    if (size < sizeof(struct kds_header) + sizeof(struct kds_footer))
+        return -1;
+    const struct kds_footer *footer = (const struct kds_footer *)(base + size - sizeof(*footer));
+    if (memcmp(footer->magic, KDS_INDEX_MAGIC, 8) != 0 ||
+        footer->index_offset < sizeof(struct kds_header) ||
+        footer->index_offset + footer->count * sizeof(uint64_t) != size - sizeof(*footer))
+        return -1;
+    const uint64_t *index = (const uint64_t *)(base + footer->index_offset);
+    for (uint64_t i = 0; i < footer->count; i++) {
+        if (index[i] >= footer->index_offset || !check_chunk(base, footer->index_offset, index[i], columns))
+            return -1;
+    }
+    *offsets = malloc((footer->count ? footer->count : 1) * sizeof(uint64_t));
+    if (!*offsets)
+        return -1;
+    memcpy(*offsets, index, footer->count * sizeof(uint64_t));
+    *count = footer->count;
+    return 0;
+}
+
+static int check_header(const struct kds_header *h, const char *path) {
+    if (memcmp(h->magic, KDS_MAGIC, 8) != 0 || h->version != KDS_VERSION ||
+        h->event_count == 0 || h->event_count > MAX_EVENTS) {
+        fprintf(stderr, "%s 不是有效的数据集文件\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int write_all(int fd, const void *buf, size_t len, uint64_t offset) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += n;
+        offset += n;
+        len -= n;
+    }
+    return 0;
+}
+
+struct kds_writer *kds_writer_open(const char *path, const struct event_set *events,
+                                   enum kds_codec codec) {
+    if (!codec_supported(codec)) {
+        fprintf(stderr, "未编译 %s 压缩支持\n", kds_codec_name(codec));
+        return NULL;
+    }
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "打开数据集 %s 失败: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct kds_writer *w = calloc(1, sizeof(*w));
+    if (!w) {
+        close(fd);
+        return NULL;
+    }
+    w->fd = fd;
+    w->codec = codec;
+    w->columns = events->count;
+    pthread_mutex_init(&w->lock, NULL);
+
+    struct kds_header header = {0};
+    memcpy(header.magic, KDS_MAGIC, 8);
+    header.version = KDS_VERSION;
+    header.event_count = events->count;
+    header.created_ns = realtime_ns();
+    for (int i = 0; i < events->count; i++)
+        snprintf(header.events[i], EVENT_NAME_LEN, "%s", events->events[i].name);
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        fprintf(stderr, "读取数据集 %s 失败: %s\n", path, strerror(errno));
+        goto fail;
+    }
+    if (st.st_size == 0) {
+        if (write_all(fd, &header, sizeof(header), 0) != 0) {
+            fprintf(stderr, "写入数据集 %s 失败: %s\n", path, strerror(errno));
+            goto fail;
+        }
+        w->end = sizeof(header);
+        return w;
+    }
+
+    // 续写：校验事件名，扫描已有分块，丢弃旧索引和截断的最后一块
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "映射数据集 %s 失败: %s\n", path, strerror(errno));
+        goto fail;
+    }
+    const struct kds_header *old = map;
+    int ok = (size_t)st.st_size >= sizeof(header) && check_header(old, path) == 0;
+    if (ok && (old->event_count != header.event_count ||
+               memcmp(old->events, header.events, sizeof(header.events)) != 0)) {
+        fprintf(stderr, "数据集 %s 的事件与当前事件集不一致\n", path);
+        ok = 0;
+    }
+    if (ok) {
+        w->count = scan_chunks(map, st.st_size, w->columns, &w->offsets, &w->end);
+        w->capacity = w->count;
+    }
+    munmap(map, st.st_size);
+    if (!ok)
+        goto fail;
+    if (ftruncate(fd, w->end) == -1) {
+        fprintf(stderr, "截断数据集 %s 失败: %s\n", path, strerror(errno));
+        goto fail;
+    }
+    return w;
+
+fail:
+    free(w->offsets);
+    pthread_mutex_destroy(&w->lock);
+    free(w);
+    close(fd);
+    return NULL;
+}
+
+// 压缩 raw，结果不比原始数据小时返回 0，按未压缩保存
+static size_t compress_payload(int codec, const void *raw, size_t raw_size, void *out, size_t cap) {
+    switch (codec) {
+#ifdef HAVE_ZSTD
+    case KDS_CODEC_ZSTD: {
+        size_t n = ZSTD_compress(out, cap, raw, raw_size, ZSTD_LEVEL);
+        return ZSTD_isError(n) || n >= raw_size ? 0 : n;
+    }
+#endif
+#ifdef HAVE_LZ4
+    case KDS_CODEC_LZ4: {
+        int n = LZ4_compress_default(raw, out, raw_size, cap);
+        return n <= 0 || (size_t)n >= raw_size ? 0 : (size_t)n;
+    }
+#endif
+    default:
+        return 0;
+    }
+}
+
+static size_t compress_bound(int codec, size_t raw_size) {
+    switch (codec) {
+#ifdef HAVE_ZSTD
+    case KDS_CODEC_ZSTD:
+        return ZSTD_compressBound(raw_size);
+#endif
+#ifdef HAVE_LZ4
+    case KDS_CODEC_LZ4:
+        return LZ4_compressBound(raw_size);
+#endif
+    default:
+        return raw_size;
+    }
+}
+
+uint64_t kds_writer_offset(struct kds_writer *w) {
+    pthread_mutex_lock(&w->lock);
+    uint64_t end = w->end;
+    pthread_mutex_unlock(&w->lock);
+    return end;
+}
+
+int kds_append(struct kds_writer *w, uint32_t sample_id, uint8_t attempt, uint32_t pid,
+               const uint8_t *hash, const uint64_t *columns, size_t stride, uint32_t rows) {
+    size_t raw_size = (size_t)w->columns * rows * sizeof(uint64_t);
+    size_t cap = compress_bound(w->codec, raw_size);
+    uint8_t *buf = malloc(sizeof(struct kds_chunk) + raw_size + (cap > raw_size ? cap : raw_size) + 8);
+    if (!buf) {
+        perror("malloc");
+        return -1;
+    }
+    struct kds_chunk *c = (struct kds_chunk *)buf;
+    uint8_t *payload = buf + sizeof(*c);
+    memset(c, 0, sizeof(*c));
+    c->magic = KDS_CHUNK_MAGIC;
+    c->sample_id = sample_id;
+    c->pid = pid;
+    c->rows = rows;
+    c->columns = w->columns;
+    c->codec = KDS_CODEC_NONE;
+    c->attempt = attempt;
+    c->stored_size = raw_size;
+    c->time_ns = realtime_ns();
+    if (hash)
+        memcpy(c->hash, hash, KDS_HASH_LEN);
+
+    // 各列紧凑排列，压缩时先放到数据区之后再压回数据区
+    uint64_t *raw = (uint64_t *)(w->codec == KDS_CODEC_NONE ? payload : payload + cap);
+    for (int i = 0; i < w->columns; i++)
+        memcpy(raw + (size_t)i * rows, columns + i * stride, rows * sizeof(uint64_t));
+    if (w->codec != KDS_CODEC_NONE) {
+        size_t n = compress_payload(w->codec, raw, raw_size, payload, cap);
+        if (n) {
+            c->codec = w->codec;
+            c->stored_size = n;
+        } else {
+            memmove(payload, raw, raw_size);
+        }
+    }
+    size_t total = sizeof(*c) + pad8(c->stored_size);
+    memset(payload + c->stored_size, 0, pad8(c->stored_size) - c->stored_size);
+
+    pthread_mutex_lock(&w->lock);
+    int ret = -1;
+    if (w->count == w->capacity) {
+        size_t capacity = w->capacity ? w->capacity * 2 : 1024;
+        uint64_t *grown = realloc(w->offsets, capacity * sizeof(uint64_t));
+        if (!grown)
+            goto out;
+        w->offsets = grown;
+        w->capacity = capacity;
+    }
+    if (write_all(w->fd, buf, total, w->end) != 0) {
+        fprintf(stderr, "写入数据集失败: %s\n", strerror(errno));
+        goto out;
+    }
+    w->offsets[w->count++] = w->end;
+    w->end += total;
+    ret = 0;
+out:
+    pthread_mutex_unlock(&w->lock);
+    free(buf);
+    return ret;
+}
+
+int kds_writer_close(struct kds_writer *w) {
+    if (!w)
+        return 0;
+    struct kds_footer footer = { .index_offset = w->end, .count = w->count };
+    memcpy(footer.magic, KDS_INDEX_MAGIC, 8);
+    size_t index_size = w->count * sizeof(uint64_t);
+    int ret = 0;
+    if ((index_size && write_all(w->fd, w->offsets, index_size, w->end) != 0) ||
+        write_all(w->fd, &footer, sizeof(footer), w->end + index_size) != 0) {
+        fprintf(stderr, "写入数据集索引失败: %s\n", strerror(errno));
+        ret = -1;
+    }
+    if (close(w->fd) == -1)
+        ret = -1;
+    pthread_mutex_destroy(&w->lock);
+    free(w->offsets);
+    free(w);
+    return ret;
+}
+
+static int compare_chunk(const void *a, const void *b) {
+    const struct kds_chunk *x = *(const struct kds_chunk *const *)a;
+    const struct kds_chunk *y = *(const struct kds_chunk *const *)b;
+    if (x->sample_id != y->sample_id)
+        return x->sample_id < y->sample_id ? -1 : 1;
+    if (x->pid != y->pid)
+        return x->pid < y->pid ? -1 : 1;
+    return x < y ? -1 : x > y;
+}
+
+// 每个样本只保留最后写入的分块所属尝试的分块，原地压缩 chunks（已按 sample_id 排序），
+// 返回丢弃的块数。中断的尝试留下的分块（可能只有部分进程、行数不全）因此不会混入读取结果
+static size_t drop_superseded(const struct kds_chunk **chunks, size_t count) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count;) {
+        const struct kds_chunk *latest = chunks[i];
+        size_t end = i + 1;
+        for (; end < count && chunks[end]->sample_id == chunks[i]->sample_id; end++) {
+            if (chunks[end]->time_ns > latest->time_ns)
+                latest = chunks[end];
+        }
+        uint8_t attempt = latest->attempt;
+        for (; i < end; i++) {
+            if (chunks[i]->attempt == attempt)
+                chunks[kept++] = chunks[i];
+        }
+    }
+    return count - kept;
+}
+
+// qsort 没有上下文参数，按哈希排序时经由此指针访问分块
+static const struct kds_chunk **sort_chunks;
+
+static int compare_hash(const void *a, const void *b) {
+    return memcmp(sort_chunks[*(const size_t *)a]->hash, sort_chunks[*(const size_t *)b]->hash,
+                  KDS_HASH_LEN);
+}
+
+struct kds_reader *kds_open(const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        fprintf(stderr, "打开数据集 %s 失败: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct kds_header)) {
+        fprintf(stderr, "%s 不是有效的数据集文件\n", path);
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "映射数据集 %s 失败: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct kds_reader *r = calloc(1, sizeof(*r));
+    if (!r) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+    r->base = map;
+    r->size = st.st_size;
+    r->header = map;
+    if (check_header(r->header, path) != 0) {
+        kds_close(r);
+        return NULL;
+    }
+
+    uint64_t *offsets;
+    if (load_index(r->base, r->size, r->header->event_count, &offsets, &r->count) != 0) {
+        uint64_t end;
+        r->count = scan_chunks(r->base, r->size, r->header->event_count, &offsets, &end);
+        fprintf(stderr, "%s 没有有效索引（采集未正常结束？），扫描得到 %zu 块\n", path, r->count);
+    }
+    r->chunks = malloc((r->count ? r->count : 1) * sizeof(*r->chunks));
+    r->by_hash = malloc((r->count ? r->count : 1) * sizeof(*r->by_hash));
+    if (!r->chunks || !r->by_hash) {
+        free(offsets);
+        kds_close(r);
+        return NULL;
+    }
+    for (size_t i = 0; i < r->count; i++)
+        r->chunks[i] = (const struct kds_chunk *)(r->base + offsets[i]);
+    free(offsets);
+    qsort(r->chunks, r->count, sizeof(*r->chunks), compare_chunk);
+    r->superseded = drop_superseded(r->chunks, r->count);
+    r->count -= r->superseded;
+    for (size_t i = 0; i < r->count; i++)
+        r->by_hash[i] = i;
+    sort_chunks = r->chunks;
+    qsort(r->by_hash, r->count, sizeof(*r->by_hash), compare_hash);
+    return r;
+}
+
+void kds_close(struct kds_reader *r) {
+    if (!r)
+        return;
+    munmap((void *)r->base, r->size);
+    free(r->chunks);
+    free(r->by_hash);
+    free(r);
+}
+
+int kds_event_count(const struct kds_reader *r) {
+    return r->header->event_count;
+}
+
+const char *kds_event_name(const struct kds_reader *r, int i) {
+    return r->header->events[i];
+}
+
+size_t kds_count(const struct kds_reader *r) {
+    return r->count;
+}
+
+size_t kds_superseded(const struct kds_reader *r) {
+    return r->superseded;
+}
+
+const struct kds_chunk *kds_chunk_at(const struct kds_reader *r, size_t i) {
+    return i < r->count ? r->chunks[i] : NULL;
+}
+
+size_t kds_find(const struct kds_reader *r, uint32_t sample_id, size_t *first) {
+    size_t lo = 0, hi = r->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->chunks[mid]->sample_id < sample_id)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    size_t end = lo;
+    while (end < r->count && r->chunks[end]->sample_id == sample_id)
+        end++;
+    *first = lo;
+    return end - lo;
+}
+
+const struct kds_chunk *kds_find_pid(const struct kds_reader *r, uint32_t sample_id, uint32_t pid) {
+    size_t first, n = kds_find(r, sample_id, &first);
+    for (size_t i = first; i < first + n; i++) {
+        if (r->chunks[i]->pid == pid)
+            return r->chunks[i];
+    }
+    return NULL;
+}
+
+// by_hash 上二分查找，命中后返回该样本的全部分块（与 kds_find 相同）
+size_t kds_find_hash(const struct kds_reader *r, const uint8_t *hash, size_t *first) {
+    size_t lo = 0, hi = r->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (memcmp(r->chunks[r->by_hash[mid]]->hash, hash, KDS_HASH_LEN) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == r->count || memcmp(r->chunks[r->by_hash[lo]]->hash, hash, KDS_HASH_LEN) != 0) {
+        *first = r->count;
+        return 0;
+    }
+    return kds_find(r, r->chunks[r->by_hash[lo]]->sample_id, first);
+}
+
+const uint64_t *kds_columns(const struct kds_reader *r, const struct kds_chunk *c, uint64_t *buf) {
+    const uint8_t *payload = (const uint8_t *)(c + 1);
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+    size_t raw_size = (size_t)c->columns * c->rows * sizeof(uint64_t);
+#endif
+    switch (c->codec) {
+    case KDS_CODEC_NONE:
+        return (const uint64_t *)payload;
+#ifdef HAVE_ZSTD
+    case KDS_CODEC_ZSTD: {
+        size_t n = ZSTD_decompress(buf, raw_size, payload, c->stored_size);
+        return ZSTD_isError(n) || n != raw_size ? NULL : buf;
+    }
+#endif
+#ifdef HAVE_LZ4
+    case KDS_CODEC_LZ4: {
+        int n = LZ4_decompress_safe((const char *)payload, (char *)buf, c->stored_size, raw_size);
+        return n < 0 || (size_t)n != raw_size ? NULL : buf;
+    }
+#endif
+    default:
+        fprintf(stderr, "分块使用了未编译支持的压缩方式 %s\n", kds_codec_name(c->codec));
+        return NULL;
+    }
+}
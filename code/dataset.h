@@ -0,0 +1,119 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 列式数据集文件（.kds）：一次采集运行一个只追加的文件，代替每个 PID 一个 CSV。
+//
+//   文件头   struct kds_header，记录事件名
+//   分块     struct kds_chunk + 数据，每块是一个样本中一个进程的全部采样：
+//            columns 列，每列 rows 个 u64（列优先），可按 codec 压缩，按 8 字节对齐
+//   索引     关闭写入端时追加：每块的文件偏移（u64）+ struct kds_footer
+//
+// 没有索引（采集中途崩溃）时读取端和续写端顺序扫描分块头重建索引，截断的最后一块被丢弃。
+// 样本被中断后重新采集时，前几次尝试的分块仍留在文件中；读取端每个样本只保留最后写入的
+// 分块所属的那次尝试（attempt 相同）的分块，其余计为被取代。
+// 读取端 mmap 整个文件，未压缩的分块直接返回映射内的列指针。
+// C++ 代码可直接包含本头文件。
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "event_set.h"
+
+#define KDS_MAGIC "KLEBKDS1"
+#define KDS_INDEX_MAGIC "KDSINDEX"
+#define KDS_VERSION 1
+#define KDS_CHUNK_MAGIC 0x4b445343u     // "KDSC"
+#define KDS_HASH_LEN 32                  // 样本哈希（sha256；md5 时后 16 字节为 0）
+
+enum kds_codec {
+    KDS_CODEC_NONE = 0,
+    KDS_CODEC_ZSTD,     // 需要以 -DHAVE_ZSTD 编译
+    KDS_CODEC_LZ4,      // 需要以 -DHAVE_LZ4 编译
+};
+
+struct kds_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t event_count;
+    uint64_t created_ns;                        // CLOCK_REALTIME
+    char events[MAX_EVENTS][EVENT_NAME_LEN];
+};
+
+struct kds_chunk {
+    uint32_t magic;
+    uint32_t sample_id;
+    uint32_t pid;
+    uint32_t rows;
+    uint16_t columns;
+    uint8_t codec;
+    uint8_t attempt;            // 第几次采集该样本（低 8 位），不重试的采集为 0
+    uint32_t stored_size;       // 数据字节数（不含对齐填充）
+    uint8_t hash[KDS_HASH_LEN]; // 全 0 表示未知
+    uint64_t time_ns;           // 写入时间（CLOCK_REALTIME）
+};
+
+struct kds_footer {
+    uint64_t index_offset;
+    uint64_t count;
+    char magic[8];
+};
+
+struct kds_writer;
+struct kds_reader;
+
+// 打开数据集用于追加。文件已存在时事件名必须一致，已有分块保留（可续写）
+struct kds_writer *kds_writer_open(const char *path, const struct event_set *events,
+                                   enum kds_codec codec);
+
+// 追加一块：第 i 列从 columns + i * stride 开始，共 rows 个值。可被多个线程同时调用
+int kds_append(struct kds_writer *w, uint32_t sample_id, uint8_t attempt, uint32_t pid,
+               const uint8_t *hash, const uint64_t *columns, size_t stride, uint32_t rows);
+
+// 下一块的写入位置。此后追加的分块都位于该偏移之后
+uint64_t kds_writer_offset(struct kds_writer *w);
+
+// 写入索引并关闭
+int kds_writer_close(struct kds_writer *w);
+
+struct kds_reader *kds_open(const char *path);
+void kds_close(struct kds_reader *r);
+
+int kds_event_count(const struct kds_reader *r);
+const char *kds_event_name(const struct kds_reader *r, int i);
+
+// 分块按 (sample_id, pid) 排序，不含被重新采集取代的分块
+size_t kds_count(const struct kds_reader *r);
+// 被同一样本后一次尝试取代而不可见的分块数
+size_t kds_superseded(const struct kds_reader *r);
+const struct kds_chunk *kds_chunk_at(const struct kds_reader *r, size_t i);
+
+// 某个样本的全部分块：返回块数，*first 为第一块的序号
+size_t kds_find(const struct kds_reader *r, uint32_t sample_id, size_t *first);
+size_t kds_find_hash(const struct kds_reader *r, const uint8_t *hash, size_t *first);
+const struct kds_chunk *kds_find_pid(const struct kds_reader *r, uint32_t sample_id, uint32_t pid);
+
+// 分块的全部列（列优先，columns * rows 个值）。未压缩时返回映射内的指针，
+// 否则解压到 buf（至少 columns * rows 个元素）；失败返回 NULL
+const uint64_t *kds_columns(const struct kds_reader *r, const struct kds_chunk *c, uint64_t *buf);
+
+// "none" / "zstd" / "lz4"，不支持的编码返回 -1
+int kds_codec_parse(const char *name);
+const char *kds_codec_name(int codec);
+
+// 十六进制哈希（md5 或 sha256）与二进制互转
+int kds_hash_parse(const char *hex, uint8_t *hash);
+void kds_hash_format(const uint8_t *hash, char *out, size_t out_len);
+
+// 读取 rename.py 生成的 md5_mapping.txt（"原文件名,新文件名"，原文件名为哈希）。
+// 返回按样本号索引的哈希数组（*count 个，每个 KDS_HASH_LEN 字节，缺失的为 0），调用者 free
+uint8_t *kds_mapping_load(const char *path, uint32_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
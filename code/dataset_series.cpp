@@ -0,0 +1,250 @@
+#include "dataset_series.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// 一个 mmap 的只读文件
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                data_ = static_cast<const char *>(map);
+                size_ = st.st_size;
+                madvise(map, size_, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (data_)
+            munmap(const_cast<char *>(data_), size_);
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return data_; }
+    const char *end() const { return data_ + size_; }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// CSV 表头中的事件列（跳过采集器写出的 sample 列）
+std::vector<std::string> csv_header(const char *p, const char *end, bool *has_sample) {
+    const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+    std::string line(p, nl ? nl : end);
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+    std::vector<std::string> names = series_split(line, ',');
+    *has_sample = !names.empty() && names[0] == "sample";
+    if (*has_sample)
+        names.erase(names.begin());
+    return names;
+}
+
+size_t count_lines(const char *p, const char *end) {
+    size_t n = 0;
+    while ((p = static_cast<const char *>(memchr(p, '\n', end - p)))) {
+        n++;
+        p++;
+    }
+    return n;
+}
+
+bool map_columns(SeriesInput &in, const std::vector<std::string> &names, std::vector<std::string> &events) {
+    if (events.empty())
+        events = names;
+    in.columns.clear();
+    for (const std::string &ev : events) {
+        auto it = std::find(names.begin(), names.end(), ev);
+        if (it == names.end()) {
+            std::fprintf(stderr, "%s 中没有事件 %s\n", in.path.c_str(), ev.c_str());
+            return false;
+        }
+        in.columns.push_back(it - names.begin());
+    }
+    return true;
+}
+
+// 解析 CSV 数据行到行优先的 values（每行 ncols 个值），返回行数
+uint32_t parse_csv(const char *p, const char *end, size_t ncols, bool skip_first, uint32_t max_rows,
+                   std::vector<double> &values) {
+    const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+    p = nl ? nl + 1 : end;
+    uint32_t rows = 0;
+    while (p < end && rows < max_rows) {
+        size_t col = 0;
+        bool first = true;
+        while (p < end && *p != '\n') {
+            double v = 0;
+            const char *start = p;
+            // 计数器都是非负整数，逐位累加；其他格式退回 strtod
+            while (p < end && *p >= '0' && *p <= '9')
+                v = v * 10 + (*p++ - '0');
+            if (p < end && *p != ',' && *p != '\n' && *p != '\r') {
+                char *next;
+                v = strtod(start, &next);
+                p = next;
+            }
+            if (!(first && skip_first) && col < ncols)
+                values[static_cast<size_t>(rows) * ncols + col++] = v;
+            first = false;
+            while (p < end && *p != ',' && *p != '\n')
+                p++;
+            if (p < end && *p == ',')
+                p++;
+        }
+        if (p < end)
+            p++;
+        if (col == ncols)
+            rows++;
+    }
+    return rows;
+}
+
+bool ends_with(const std::string &s, const char *suffix) {
+    size_t n = strlen(suffix);
+    return s.size() > n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+}  // namespace
+
+SeriesInput::~SeriesInput() {
+    kds_close(kds);
+}
+
+std::vector<std::string> series_split(const std::string &s, char sep) {
+    std::vector<std::string> out;
+    size_t start = 0, pos;
+    while ((pos = s.find(sep, start)) != std::string::npos) {
+        out.push_back(s.substr(start, pos - start));
+        start = pos + 1;
+    }
+    out.push_back(s.substr(start));
+    return out;
+}
+
+bool series_input_parse(const char *arg, SeriesInput *in) {
+    const char *colon = strrchr(arg, ':');
+    char *end;
+    long label = colon ? strtol(colon + 1, &end, 10) : -1;
+    if (!colon || colon == arg || *end != '\0' || label < 0 || label > 255) {
+        std::fprintf(stderr, "输入 %s 缺少标签（路径:标签，标签为 0~255）\n", arg);
+        return false;
+    }
+    in->path.assign(arg, colon - arg);
+    in->label = label;
+    return true;
+}
+
+bool series_list(SeriesInput &in, std::vector<std::string> &events, std::vector<Series> &out) {
+    if (ends_with(in.path, ".kds")) {
+        in.kds = kds_open(in.path.c_str());
+        if (!in.kds)
+            return false;
+        std::vector<std::string> names;
+        for (int i = 0; i < kds_event_count(in.kds); i++)
+            names.push_back(kds_event_name(in.kds, i));
+        if (!map_columns(in, names, events))
+            return false;
+        for (size_t i = 0; i < kds_count(in.kds); i++) {
+            const struct kds_chunk *c = kds_chunk_at(in.kds, i);
+            out.push_back({&in, c, {}, c->sample_id, c->pid, c->rows});
+        }
+        return true;
+    }
+
+    DIR *dir = opendir(in.path.c_str());
+    if (!dir) {
+        std::fprintf(stderr, "打开 %s 失败: %s\n", in.path.c_str(), strerror(errno));
+        return false;
+    }
+    std::vector<std::string> files;
+    while (struct dirent *ent = readdir(dir)) {
+        std::string name = ent->d_name;
+        if (ends_with(name, ".csv"))
+            files.push_back(name);
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+
+    std::vector<std::string> header;
+    for (size_t i = 0; i < files.size(); i++) {
+        std::string path = in.path + "/" + files[i];
+        MappedFile f(path);
+        if (!f.data())
+            continue;
+        bool has_sample;
+        std::vector<std::string> names = csv_header(f.data(), f.end(), &has_sample);
+        if (header.empty()) {
+            header = names;
+            in.csv_sample_column = has_sample;
+            in.csv_columns = names.size();
+            if (!map_columns(in, names, events))
+                return false;
+        } else if (names != header || has_sample != in.csv_sample_column) {
+            std::fprintf(stderr, "%s 的事件列与同目录其他文件不一致\n", path.c_str());
+            return false;
+        }
+        size_t lines = count_lines(f.data(), f.end());
+        if (f.end()[-1] != '\n')
+            lines++;
+        unsigned int pid = 0;
+        sscanf(files[i].c_str(), "perf_output_%u.csv", &pid);
+        out.push_back({&in, nullptr, path, static_cast<uint32_t>(i), pid,
+                       static_cast<uint32_t>(lines > 0 ? lines - 1 : 0)});
+    }
+    return true;
+}
+
+long series_read(const Series &s, uint32_t max_rows, std::vector<float> &out) {
+    const SeriesInput &in = *s.input;
+    size_t nev = in.columns.size();
+    uint32_t rows = std::min(s.rows, max_rows);
+
+    if (s.chunk) {
+        std::vector<uint64_t> buf(static_cast<size_t>(s.chunk->columns) * s.chunk->rows + 1);
+        const uint64_t *cols = kds_columns(in.kds, s.chunk, buf.data());
+        if (!cols) {
+            std::fprintf(stderr, "读取样本 %u PID %u 失败\n", s.sample_id, s.pid);
+            return -1;
+        }
+        out.resize(static_cast<size_t>(rows) * nev);
+        for (uint32_t r = 0; r < rows; r++)
+            for (size_t e = 0; e < nev; e++)
+                out[r * nev + e] = static_cast<float>(cols[static_cast<size_t>(in.columns[e]) * s.chunk->rows + r]);
+        return rows;
+    }
+
+    MappedFile f(s.csv_path);
+    if (!f.data()) {
+        std::fprintf(stderr, "读取 %s 失败\n", s.csv_path.c_str());
+        return -1;
+    }
+    size_t ncols = in.csv_columns;
+    std::vector<double> values(static_cast<size_t>(rows) * ncols);
+    rows = parse_csv(f.data(), f.end(), ncols, in.csv_sample_column, rows, values);
+    out.resize(static_cast<size_t>(rows) * nev);
+    for (uint32_t r = 0; r < rows; r++)
+        for (size_t e = 0; e < nev; e++)
+            out[r * nev + e] = static_cast<float>(values[r * ncols + in.columns[e]]);
+    return rows;
+}
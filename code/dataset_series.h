@@ -0,0 +1,50 @@
+#ifndef DATASET_SERIES_H
+#define DATASET_SERIES_H
+
+// 离线工具（extract_windows、eval_dataset）共用的数据集输入：
+// 每个输入是 .kds 数据集文件或 perf_output CSV 目录加一个标签，展开为若干条时间序列
+// （kds 的一个分块或一个 CSV 文件，即一个样本的一个进程），按指定事件顺序读出
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "dataset.h"
+}
+
+struct SeriesInput {
+    std::string path;
+    uint8_t label = 0;
+    struct kds_reader *kds = nullptr;   // .kds 输入
+    std::vector<int> columns;           // 第 i 个事件对应的输入列
+    bool csv_sample_column = false;     // CSV 第一列是采集器写出的 sample 序号
+    size_t csv_columns = 0;
+
+    SeriesInput() = default;
+    SeriesInput(const SeriesInput &) = delete;
+    SeriesInput &operator=(const SeriesInput &) = delete;
+    ~SeriesInput();
+};
+
+struct Series {
+    SeriesInput *input;
+    const struct kds_chunk *chunk;      // CSV 时为 nullptr
+    std::string csv_path;
+    uint32_t sample_id;                 // CSV 输入为文件序号
+    uint32_t pid;                       // CSV 输入从 perf_output_<pid>.csv 文件名解析，未知为 0
+    uint32_t rows;
+};
+
+// 解析 "路径:标签"
+bool series_input_parse(const char *arg, SeriesInput *in);
+
+// 列出输入中的所有序列并确定事件列映射。events 为空时取该输入的全部事件
+bool series_list(SeriesInput &in, std::vector<std::string> &events, std::vector<Series> &out);
+
+// 读出序列的前 max_rows 行，按 series_list 时的事件顺序行优先写入 out，返回行数，失败返回 -1
+long series_read(const Series &s, uint32_t max_rows, std::vector<float> &out);
+
+std::vector<std::string> series_split(const std::string &s, char sep);
+
+#endif
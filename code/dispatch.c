@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "dispatch.h"
+#include "common.h"
+#include "logger.h"
+#include "metrics.h"
+#include "respond.h"
+#include "selfprof.h"
+
+// 定义全局变量（在 common.h 中声明）
+volatile sig_atomic_t exiting = 0;
+int pipe_fds[MAX_PIDS][2];
+int pipe_count = 0;
+unsigned int pipe_generation = 0;
+pthread_mutex_t pipe_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// 哈希表节点，用于存储 PID 和时间戳
+struct pid_entry {
+    uint32_t pid;
+    time_t timestamp;
+    struct pid_entry *next;
+};
+
+// 哈希表大小
+#define HASH_SIZE 1024
+
+// 全局哈希表（只在调度线程中访问）
+static struct pid_entry *pid_table[HASH_SIZE] = {0};
+
+static collector_fn collector;
+static void *collector_ctx;
+
+struct thread_arg {
+    uint32_t pid;
+    uint64_t exec_ns;
+    int slot;
+    int pipe_fd;
+};
+
+// 哈希函数
+static unsigned int hash_pid(uint32_t pid) {
+    return pid % HASH_SIZE;
+}
+
+// 检查 PID 是否在 5 秒内已处理
+static int is_pid_recent(uint32_t pid) {
+    unsigned int index = hash_pid(pid);
+    struct pid_entry *entry = pid_table[index];
+    time_t now = time(NULL);
+
+    while (entry) {
+        if (entry->pid == pid) {
+            if (now - entry->timestamp < 5) {
+                return 1;
+            } else {
+                entry->timestamp = now;
+                return 0;
+            }
+        }
+        entry = entry->next;
+    }
+
+    struct pid_entry *new_entry = malloc(sizeof(struct pid_entry));
+    if (!new_entry) {
+        log_msg(LOG_ERROR, "malloc pid_entry: %s\n", strerror(errno));
+        return 0;
+    }
+    new_entry->pid = pid;
+    new_entry->timestamp = now;
+    new_entry->next = pid_table[index];
+    pid_table[index] = new_entry;
+    return 0;
+}
+
+void dispatch_init(collector_fn fn, void *ctx) {
+    collector = fn;
+    collector_ctx = ctx;
+}
+
+// 复用两端都已关闭的槽位，没有时追加；调用者持有 pipe_mutex
+static int alloc_slot_locked(int fd[2]) {
+    int slot = -1;
+    for (int i = 0; i < pipe_count; i++) {
+        if (pipe_fds[i][0] == -1 && pipe_fds[i][1] == -1) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == -1) {
+        if (pipe_count >= MAX_PIDS)
+            return -1;
+        slot = pipe_count++;
+    }
+    pipe_fds[slot][0] = fd[0];
+    pipe_fds[slot][1] = fd[1];
+    pipe_generation++;
+    return slot;
+}
+
+int dispatch_alloc_pipe(int fd[2]) {
+    if (pipe(fd) == -1) {
+        perror("pipe");
+        return -1;
+    }
+    pthread_mutex_lock(&pipe_mutex);
+    int slot = alloc_slot_locked(fd);
+    pthread_mutex_unlock(&pipe_mutex);
+    if (slot == -1) {
+        close(fd[0]);
+        close(fd[1]);
+        fprintf(stderr, "Too many PIDs\n");
+    }
+    return slot;
+}
+
+// 采集线程函数
+static void *monitor_thread(void *arg) {
+    struct thread_arg *targ = arg;
+    selfprof_thread_begin(PROF_COLLECT);
+    metrics_add(METRIC_COLLECTORS_ACTIVE, 1);
+    collector(targ->pid, targ->exec_ns, targ->pipe_fd, collector_ctx);
+    metrics_add(METRIC_COLLECTORS_ACTIVE, -1);
+
+    // 关闭写端，接收线程读完剩余数据后会收到 EOF
+    pthread_mutex_lock(&pipe_mutex);
+    if (pipe_fds[targ->slot][1] == targ->pipe_fd) {
+        close(targ->pipe_fd);
+        pipe_fds[targ->slot][1] = -1;
+    }
+    pthread_mutex_unlock(&pipe_mutex);
+    free(targ);
+    selfprof_thread_end();
+    return NULL;
+}
+
+// 释放尚未交给采集线程的槽位
+static void release_slot(int slot) {
+    pthread_mutex_lock(&pipe_mutex);
+    close(pipe_fds[slot][0]);
+    close(pipe_fds[slot][1]);
+    pipe_fds[slot][0] = -1;
+    pipe_fds[slot][1] = -1;
+    pipe_generation++;
+    pthread_mutex_unlock(&pipe_mutex);
+}
+
+int dispatch_exec(uint32_t pid, uint64_t exec_ns) {
+    if (is_pid_recent(pid))
+        return 1;
+
+    respond_note_exec(pid, exec_ns);
+
+    int fd[2];
+    if (pipe(fd) == -1) {
+        metrics_add(METRIC_EXECS_DROPPED, 1);
+        log_msg(LOG_ERROR, "pipe: %s\n", strerror(errno));
+        return -1;
+    }
+
+    pthread_mutex_lock(&pipe_mutex);
+    int slot = alloc_slot_locked(fd);
+    pthread_mutex_unlock(&pipe_mutex);
+    if (slot == -1) {
+        metrics_add(METRIC_EXECS_DROPPED, 1);
+        log_msg(LOG_WARN, "Too many PIDs\n");
+        close(fd[0]);
+        close(fd[1]);
+        return -1;
+    }
+
+    pthread_t tid;
+    struct thread_arg *targ = malloc(sizeof(*targ));
+    if (!targ) {
+        metrics_add(METRIC_EXECS_DROPPED, 1);
+        log_msg(LOG_ERROR, "malloc: %s\n", strerror(errno));
+        release_slot(slot);
+        return -1;
+    }
+    targ->pid = pid;
+    targ->exec_ns = exec_ns;
+    targ->slot = slot;
+    targ->pipe_fd = fd[1];
+    if (pthread_create(&tid, NULL, monitor_thread, targ) != 0) {
+        metrics_add(METRIC_EXECS_DROPPED, 1);
+        log_msg(LOG_ERROR, "pthread_create: %s\n", strerror(errno));
+        release_slot(slot);
+        free(targ);
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
+
+// 清理哈希表和管道
+void dispatch_cleanup(void) {
+    for (int i = 0; i < HASH_SIZE; i++) {
+        struct pid_entry *entry = pid_table[i];
+        while (entry) {
+            struct pid_entry *temp = entry;
+            entry = entry->next;
+            free(temp);
+        }
+        pid_table[i] = NULL;
+    }
+
+    pthread_mutex_lock(&pipe_mutex);
+    for (int i = 0; i < pipe_count; i++) {
+        if (pipe_fds[i][0] != -1)
+            close(pipe_fds[i][0]);
+        if (pipe_fds[i][1] != -1)
+            close(pipe_fds[i][1]);
+        pipe_fds[i][0] = -1;
+        pipe_fds[i][1] = -1;
+    }
+    pipe_count = 0;
+    pipe_generation++;
+    pthread_mutex_unlock(&pipe_mutex);
+}
@@ -0,0 +1,22 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <stdint.h>
+
+// execve 事件调度：按 PID 去重，为每个新进程分配管道槽位并启动采集线程。
+// 采集线程返回后关闭写端，接收线程读到 EOF 后关闭读端，槽位随后被复用
+
+// 采集线程入口：把窗口写入 pipe_fd，返回即表示采集结束
+typedef void (*collector_fn)(uint32_t pid, uint64_t exec_ns, int pipe_fd, void *ctx);
+
+void dispatch_init(collector_fn fn, void *ctx);
+
+// 返回 0 表示已启动采集，1 表示 5 秒内已处理过该 PID，-1 表示资源不足而丢弃
+int dispatch_exec(uint32_t pid, uint64_t exec_ns);
+
+// 为常驻采集线程（cgroup 模式）分配管道槽位，写端由调用者持有直到退出
+int dispatch_alloc_pipe(int fd[2]);
+
+void dispatch_cleanup(void);
+
+#endif
@@ -0,0 +1,399 @@
+// 离线评估：把数据集（.kds 文件或 perf_output CSV 目录）逐条序列按采集端的窗口大小
+// （PRINT_EVERY 行）送入 libkleb 的 kleb_feed，与守护进程完全相同的特征拼装和 kleb_forward()，
+// 统计窗口级与样本级（任一窗口判为恶意即为恶意）的准确率、混淆矩阵、ROC/AUC、
+// 推理延迟、检出所需窗口数和吞吐量。序列在工作窃取线程池中并行处理，每个线程一个 kleb_ctx。
+//
+//   eval_dataset [-w model_weights.bin] [-j 线程数] [-t 行数] [-T 阈值] [-R roc.csv]
+//                benign.kds:0 dataset/ransomware/ransomware_vec:1 ...
+//
+// 标签 0 为良性，非 0 为恶意；分数为 score[1] - score[0]，守护进程的判定等价于阈值 0
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <getopt.h>
+#include <time.h>
+
+#include "dataset_series.h"
+
+extern "C" {
+#include "collect.h"
+#include "kleb.h"
+}
+
+namespace {
+
+uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+// 工作窃取线程池：任务预先按块分给各线程，自己的队列从头取，空了从其他线程的队列尾部偷。
+// 样本长短差异很大（进程数、行数），按块静态划分会有线程早早空闲
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads) : queues_(threads) {}
+
+    void run(size_t tasks, const std::function<void(int, size_t)> &fn) {
+        int n = queues_.size();
+        for (int t = 0; t < n; t++) {
+            size_t begin = tasks * t / n, end = tasks * (t + 1) / n;
+            for (size_t i = begin; i < end; i++)
+                queues_[t].tasks.push_back(i);
+        }
+        std::vector<std::thread> workers;
+        for (int t = 0; t < n; t++) {
+            workers.emplace_back([this, t, n, &fn] {
+                size_t task;
+                while (pop(t, &task) || steal(t, n, &task))
+                    fn(t, task);
+            });
+        }
+        for (std::thread &w : workers)
+            w.join();
+    }
+
+    uint64_t steals() const { return steals_.load(); }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    bool pop(int t, size_t *task) {
+        std::lock_guard<std::mutex> guard(queues_[t].lock);
+        if (queues_[t].tasks.empty())
+            return false;
+        *task = queues_[t].tasks.front();
+        queues_[t].tasks.pop_front();
+        return true;
+    }
+
+    bool steal(int t, int n, size_t *task) {
+        for (int k = 1; k < n; k++) {
+            Queue &victim = queues_[(t + k) % n];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                *task = victim.tasks.back();
+                victim.tasks.pop_back();
+                steals_++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<Queue> queues_;
+    std::atomic<uint64_t> steals_{0};
+};
+
+// 一条序列的评估结果，只由处理它的线程写入
+struct SeriesResult {
+    std::vector<float> scores;      // 每个窗口的 score[1] - score[0]
+    std::vector<uint32_t> infer_ns; // kleb_forward() 耗时（kleb_verdict.infer_ns）
+    uint64_t feed_ns = 0;           // 全部 kleb_feed 调用耗时
+    bool failed = false;
+};
+
+struct Confusion {
+    uint64_t tp = 0, fp = 0, tn = 0, fn = 0;
+
+    void add(bool positive, bool predicted) {
+        if (positive)
+            predicted ? tp++ : fn++;
+        else
+            predicted ? fp++ : tn++;
+    }
+    double ratio(uint64_t a, uint64_t b) const { return b ? static_cast<double>(a) / b : 0; }
+
+    void print(const char *level) const {
+        uint64_t total = tp + fp + tn + fn;
+        double precision = ratio(tp, tp + fp), recall = ratio(tp, tp + fn);
+        std::printf("%s: %" PRIu64 " 个，准确率 %.4f，精确率 %.4f，召回率 %.4f，F1 %.4f，误报率 %.4f\n", level,
+                    total, ratio(tp + tn, total), precision, recall,
+                    precision + recall > 0 ? 2 * precision * recall / (precision + recall) : 0, ratio(fp, fp + tn));
+        std::printf("  混淆矩阵（行为真实，列为预测）\n");
+        std::printf("            良性      恶意\n");
+        std::printf("  良性  %8" PRIu64 "  %8" PRIu64 "\n", tn, fp);
+        std::printf("  恶意  %8" PRIu64 "  %8" PRIu64 "\n", fn, tp);
+    }
+};
+
+struct RocPoint {
+    float threshold;
+    double tpr, fpr;
+};
+
+// 按分数从高到低扫描，每个不同分数一个点（分数 >= 阈值判为恶意）
+std::vector<RocPoint> roc_curve(std::vector<std::pair<float, bool>> scored, double *auc) {
+    std::sort(scored.begin(), scored.end(),
+              [](const std::pair<float, bool> &a, const std::pair<float, bool> &b) { return a.first > b.first; });
+    uint64_t pos = 0, neg = 0;
+    for (const auto &s : scored)
+        s.second ? pos++ : neg++;
+    std::vector<RocPoint> curve;
+    uint64_t tp = 0, fp = 0;
+    double area = 0, prev_tpr = 0, prev_fpr = 0;
+    for (size_t i = 0; i < scored.size(); i++) {
+        scored[i].second ? tp++ : fp++;
+        if (i + 1 < scored.size() && scored[i + 1].first == scored[i].first)
+            continue;
+        double tpr = pos ? static_cast<double>(tp) / pos : 0;
+        double fpr = neg ? static_cast<double>(fp) / neg : 0;
+        area += (fpr - prev_fpr) * (tpr + prev_tpr) / 2;
+        prev_tpr = tpr;
+        prev_fpr = fpr;
+        curve.push_back({scored[i].first, tpr, fpr});
+    }
+    *auc = pos && neg ? area : NAN;
+    return curve;
+}
+
+void print_roc(const char *level, const std::vector<RocPoint> &curve, double auc) {
+    std::printf("%s ROC AUC %.4f\n", level, auc);
+    for (double limit : {0.001, 0.01, 0.05, 0.1}) {
+        const RocPoint *best = nullptr;
+        for (const RocPoint &p : curve) {
+            if (p.fpr <= limit)
+                best = &p;
+        }
+        if (best)
+            std::printf("  误报率 <= %5.1f%%: 阈值 %10.4g，召回率 %.4f\n", limit * 100, best->threshold, best->tpr);
+    }
+}
+
+template <typename T>
+T percentile(std::vector<T> &v, double p) {
+    if (v.empty())
+        return 0;
+    size_t k = std::min(v.size() - 1, static_cast<size_t>(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "用法: eval_dataset [-w 权重文件] [-j 线程数] [-t 行数] [-T 阈值] [-R roc.csv] 输入:标签 ...\n"
+                 "  输入为 .kds 数据集文件或 perf_output CSV 目录，标签 0 为良性、非 0 为恶意\n"
+                 "  -w     模型权重（默认 model_weights.bin，同时读取 .schema 确定事件和窗口行数）\n"
+                 "  -j N   线程数（默认 CPU 数）\n"
+                 "  -t N   每条序列只使用前 N 行（守护进程每个进程采集 %d 行），默认全部\n"
+                 "  -T X   判为恶意的分数阈值（score[1] - score[0] >= X），默认 0\n"
+                 "  -R F   把窗口级和样本级 ROC 曲线写到 CSV\n",
+                 TOTAL_SAMPLES);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const char *weights_path = "model_weights.bin";
+    const char *roc_path = nullptr;
+    int threads = 0;
+    uint32_t max_rows = UINT32_MAX;
+    float threshold = 0;
+    int c;
+    while ((c = getopt(argc, argv, "w:j:t:T:R:h")) != -1) {
+        switch (c) {
+        case 'w':
+            weights_path = optarg;
+            break;
+        case 'j':
+            threads = std::atoi(optarg);
+            break;
+        case 't':
+            max_rows = std::atoi(optarg) > 0 ? std::atoi(optarg) : UINT32_MAX;
+            break;
+        case 'T':
+            threshold = std::atof(optarg);
+            break;
+        case 'R':
+            roc_path = optarg;
+            break;
+        default:
+            usage();
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind == argc) {
+        usage();
+        return 1;
+    }
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // 每个线程一个检测上下文（ctx 不能跨线程共享），事件顺序以模型模式为准
+    std::vector<struct kleb_ctx *> ctxs(threads);
+    for (int t = 0; t < threads; t++) {
+        ctxs[t] = kleb_create();
+        if (!ctxs[t] || kleb_load_model(ctxs[t], weights_path) != 0) {
+            std::fprintf(stderr, "加载模型失败: %s\n", ctxs[t] ? kleb_error(ctxs[t]) : "内存不足");
+            return 1;
+        }
+    }
+    const struct event_set *model_events = kleb_events(ctxs[0]);
+    std::vector<std::string> events;
+    for (int i = 0; i < model_events->count; i++)
+        events.push_back(model_events->events[i].name);
+    size_t nev = events.size();
+    int rows_per_window = kleb_schema(ctxs[0])->rows_per_window;
+
+    std::vector<std::unique_ptr<SeriesInput>> inputs;
+    std::vector<Series> series;
+    for (int i = optind; i < argc; i++) {
+        inputs.emplace_back(new SeriesInput);
+        if (!series_input_parse(argv[i], inputs.back().get()) ||
+            !series_list(*inputs.back(), events, series))
+            return 1;
+    }
+
+    std::vector<SeriesResult> results(series.size());
+    WorkStealingPool pool(threads);
+    uint64_t start_ns = monotonic_ns();
+    pool.run(series.size(), [&](int t, size_t i) {
+        struct kleb_ctx *ctx = ctxs[t];
+        SeriesResult &res = results[i];
+        std::vector<float> rows;
+        long nrows = series_read(series[i], max_rows, rows);
+        if (nrows < 0) {
+            res.failed = true;
+            return;
+        }
+        // 与采集端一致：每满 PRINT_EVERY 行送一次，不足一个窗口的尾部不送
+        for (long r = 0; r + PRINT_EVERY <= nrows; r += PRINT_EVERY) {
+            uint64_t t0 = monotonic_ns();
+            int ret = kleb_feed(ctx, series[i].pid, 0, 0, &rows[r * nev], PRINT_EVERY);
+            res.feed_ns += monotonic_ns() - t0;
+            struct kleb_verdict v;
+            if (ret != 0 || kleb_poll(ctx, &v, 1) != 1) {
+                res.failed = true;
+                break;
+            }
+            res.scores.push_back(v.score[1] - v.score[0]);
+            res.infer_ns.push_back(v.infer_ns);
+        }
+        // 下一条序列可能复用同一个 PID，清空累积的行
+        kleb_expire(ctx, 0);
+    });
+    double wall_s = (monotonic_ns() - start_ns) / 1e9;
+    for (struct kleb_ctx *ctx : ctxs)
+        kleb_destroy(ctx);
+
+    // 汇总：窗口级直接统计，样本级按（输入，样本号）聚合取最高分
+    struct SampleAgg {
+        bool positive;
+        float score = -INFINITY;
+        long first_detect = -1;     // 第一个判为恶意的窗口序号（在该样本各进程中取最早）
+        uint64_t feed_ns = 0;
+    };
+    std::map<std::pair<const SeriesInput *, uint32_t>, SampleAgg> samples;
+    Confusion window_cm, sample_cm;
+    std::vector<std::pair<float, bool>> window_scores;
+    std::vector<uint32_t> infer_ns;
+    std::vector<uint64_t> feed_ns;
+    size_t failed = 0, empty = 0;
+    for (size_t i = 0; i < series.size(); i++) {
+        const SeriesResult &res = results[i];
+        bool positive = series[i].input->label != 0;
+        failed += res.failed;
+        if (res.scores.empty()) {
+            empty++;
+            continue;
+        }
+        SampleAgg &agg = samples[{series[i].input, series[i].sample_id}];
+        agg.positive = positive;
+        agg.feed_ns += res.feed_ns;
+        for (size_t w = 0; w < res.scores.size(); w++) {
+            float s = res.scores[w];
+            window_cm.add(positive, s >= threshold);
+            window_scores.push_back({s, positive});
+            agg.score = std::max(agg.score, s);
+            if (s >= threshold && (agg.first_detect < 0 || static_cast<long>(w) < agg.first_detect))
+                agg.first_detect = w;
+        }
+        infer_ns.insert(infer_ns.end(), res.infer_ns.begin(), res.infer_ns.end());
+        feed_ns.push_back(res.feed_ns / res.scores.size());
+    }
+    std::vector<std::pair<float, bool>> sample_scores;
+    std::vector<long> detect_windows;
+    std::vector<uint64_t> sample_ns;
+    for (const auto &entry : samples) {
+        const SampleAgg &agg = entry.second;
+        sample_cm.add(agg.positive, agg.score >= threshold);
+        sample_scores.push_back({agg.score, agg.positive});
+        sample_ns.push_back(agg.feed_ns);
+        if (agg.positive && agg.first_detect >= 0)
+            detect_windows.push_back(agg.first_detect + 1);
+    }
+
+    std::printf("模型 %s，事件", weights_path);
+    for (const std::string &e : events)
+        std::printf(" %s", e.c_str());
+    std::printf("，每窗口 %d 行，阈值 %g\n", rows_per_window, threshold);
+    std::printf("序列 %zu（不足一个窗口 %zu，读取失败 %zu），样本 %zu\n\n", series.size(), empty, failed,
+                samples.size());
+    window_cm.print("窗口级");
+    sample_cm.print("样本级");
+
+    double window_auc, sample_auc;
+    std::vector<RocPoint> window_roc = roc_curve(window_scores, &window_auc);
+    std::vector<RocPoint> sample_roc = roc_curve(sample_scores, &sample_auc);
+    std::printf("\n");
+    print_roc("窗口级", window_roc, window_auc);
+    print_roc("样本级", sample_roc, sample_auc);
+
+    size_t detected = detect_windows.size();
+    if (detected) {
+        double mean = 0;
+        for (long w : detect_windows)
+            mean += w;
+        mean /= detected;
+        std::printf("\n检出恶意样本 %zu 个，所需窗口数: 平均 %.2f，p50 %ld，p90 %ld（每窗口 %d 行）\n", detected,
+                    mean, percentile(detect_windows, 0.5), percentile(detect_windows, 0.9), PRINT_EVERY);
+    }
+    size_t windows = window_scores.size();
+    std::printf("\n推理 kleb_forward(): p50 %u ns，p99 %u ns，最大 %u ns\n", percentile(infer_ns, 0.5),
+                percentile(infer_ns, 0.99), percentile(infer_ns, 1.0));
+    std::printf("kleb_feed（含特征拼装）每窗口: p50 %" PRIu64 " ns，p99 %" PRIu64 " ns\n", percentile(feed_ns, 0.5),
+                percentile(feed_ns, 0.99));
+    std::printf("每个样本: p50 %.1f us，p99 %.1f us\n", percentile(sample_ns, 0.5) / 1e3,
+                percentile(sample_ns, 0.99) / 1e3);
+    std::printf("吞吐量: %.0f 窗口/s，%.0f 样本/s（%d 线程，窃取 %" PRIu64 " 次，用时 %.3f s）\n",
+                wall_s > 0 ? windows / wall_s : 0, wall_s > 0 ? samples.size() / wall_s : 0, threads,
+                pool.steals(), wall_s);
+
+    if (roc_path) {
+        FILE *f = std::fopen(roc_path, "w");
+        if (!f) {
+            std::perror(roc_path);
+            return 1;
+        }
+        std::fprintf(f, "level,threshold,tpr,fpr\n");
+        for (const RocPoint &p : window_roc)
+            std::fprintf(f, "window,%.9g,%.6f,%.6f\n", p.threshold, p.tpr, p.fpr);
+        for (const RocPoint &p : sample_roc)
+            std::fprintf(f, "sample,%.9g,%.6f,%.6f\n", p.threshold, p.tpr, p.fpr);
+        if (std::fclose(f) != 0) {
+            std::perror(roc_path);
+            return 1;
+        }
+    }
+    return failed ? 1 : 0;
+}
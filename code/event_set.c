@@ -0,0 +1,334 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <linux/perf_event.h>
+#include "event_set.h"
+
+struct named_event {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+};
+
+static const struct named_event generic_events[] = {
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "cpu-cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "branch-instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+    { "branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { "cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+    { "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { "bus-cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BUS_CYCLES },
+    { "ref-cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES },
+    { "stalled-cycles-frontend", PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND },
+    { "stalled-cycles-backend", PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND },
+    { "task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    { "page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+    { "context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    { "cpu-migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS },
+    { "minor-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN },
+    { "major-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ },
+};
+
+static const struct {
+    const char *name;
+    uint64_t id;
+} cache_ids[] = {
+    { "L1-dcache", PERF_COUNT_HW_CACHE_L1D },
+    { "L1-icache", PERF_COUNT_HW_CACHE_L1I },
+    { "LLC", PERF_COUNT_HW_CACHE_LL },
+    { "dTLB", PERF_COUNT_HW_CACHE_DTLB },
+    { "iTLB", PERF_COUNT_HW_CACHE_ITLB },
+    { "branch", PERF_COUNT_HW_CACHE_BPU },
+    { "node", PERF_COUNT_HW_CACHE_NODE },
+};
+
+static const struct {
+    const char *name;
+    uint64_t op;
+    uint64_t result;
+} cache_ops[] = {
+    { "loads", PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS },
+    { "load-misses", PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS },
+    { "stores", PERF_COUNT_HW_CACHE_OP_WRITE, PERF_COUNT_HW_CACHE_RESULT_ACCESS },
+    { "store-misses", PERF_COUNT_HW_CACHE_OP_WRITE, PERF_COUNT_HW_CACHE_RESULT_MISS },
+    { "prefetches", PERF_COUNT_HW_CACHE_OP_PREFETCH, PERF_COUNT_HW_CACHE_RESULT_ACCESS },
+    { "prefetch-misses", PERF_COUNT_HW_CACHE_OP_PREFETCH, PERF_COUNT_HW_CACHE_RESULT_MISS },
+};
+
+// 数据集采集器使用的事件，现有模型即在此事件集上训练
+static const char *default_names[] = { "branches", "cache-references", "cache-misses", "bus-cycles" };
+
+static int parse_cache_event(const char *name, EventDef *ev) {
+    for (size_t i = 0; i < sizeof(cache_ids) / sizeof(cache_ids[0]); i++) {
+        size_t len = strlen(cache_ids[i].name);
+        if (strncmp(name, cache_ids[i].name, len) != 0 || name[len] != '-')
+            continue;
+        for (size_t j = 0; j < sizeof(cache_ops) / sizeof(cache_ops[0]); j++) {
+            if (strcmp(name + len + 1, cache_ops[j].name) == 0) {
+                ev->type = PERF_TYPE_HW_CACHE;
+                ev->config = cache_ids[i].id | (cache_ops[j].op << 8) | (cache_ops[j].result << 16);
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+// cpu/event=0xc4,umask=0x01,cmask=1,edge,inv/ -> x86 原始编码
+static int parse_pmu_event(const char *name, EventDef *ev) {
+    const char *body = strchr(name, '/');
+    if (!body)
+        return -1;
+    body++;
+    size_t body_len = strlen(body);
+    if (body_len == 0 || body[body_len - 1] != '/')
+        return -1;
+
+    char terms[EVENT_NAME_LEN];
+    if (body_len >= sizeof(terms))
+        return -1;
+    memcpy(terms, body, body_len - 1);
+    terms[body_len - 1] = '\0';
+
+    uint64_t event = 0, umask = 0, cmask = 0, edge = 0, inv = 0;
+    int have_event = 0;
+    char *save = NULL;
+    for (char *term = strtok_r(terms, ",", &save); term; term = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(term, '=');
+        uint64_t val = 1;
+        if (eq) {
+            *eq = '\0';
+            char *end;
+            val = strtoull(eq + 1, &end, 0);
+            if (*end != '\0')
+                return -1;
+        }
+        if (strcmp(term, "event") == 0) {
+            event = val;
+            have_event = 1;
+        } else if (strcmp(term, "umask") == 0) {
+            umask = val;
+        } else if (strcmp(term, "cmask") == 0) {
+            cmask = val;
+        } else if (strcmp(term, "edge") == 0) {
+            edge = val;
+        } else if (strcmp(term, "inv") == 0) {
+            inv = val;
+        } else {
+            return -1;
+        }
+    }
+    if (!have_event)
+        return -1;
+
+    ev->type = PERF_TYPE_RAW;
+    ev->config = (event & 0xff) | ((umask & 0xff) << 8) | ((edge & 1) << 18) |
+                 ((inv & 1) << 23) | ((cmask & 0xff) << 24) | ((event >> 8) << 32);
+    return 0;
+}
+
+int event_parse(const char *name, EventDef *ev) {
+    if (strlen(name) >= EVENT_NAME_LEN) {
+        fprintf(stderr, "Event name too long: %s\n", name);
+        return -1;
+    }
+    snprintf(ev->name, sizeof(ev->name), "%s", name);
+
+    for (size_t i = 0; i < sizeof(generic_events) / sizeof(generic_events[0]); i++) {
+        if (strcmp(name, generic_events[i].name) == 0) {
+            ev->type = generic_events[i].type;
+            ev->config = generic_events[i].config;
+            return 0;
+        }
+    }
+
+    if (parse_cache_event(name, ev) == 0)
+        return 0;
+
+    // 原始编码 rNNNN（十六进制）
+    if (name[0] == 'r' && isxdigit((unsigned char)name[1])) {
+        char *end;
+        uint64_t config = strtoull(name + 1, &end, 16);
+        if (*end == '\0') {
+            ev->type = PERF_TYPE_RAW;
+            ev->config = config;
+            return 0;
+        }
+    }
+
+    if (strchr(name, '/') && parse_pmu_event(name, ev) == 0)
+        return 0;
+
+    fprintf(stderr, "Unsupported event name: %s\n", name);
+    return -1;
+}
+
+static int event_set_add(struct event_set *set, const char *name) {
+    if (set->count >= MAX_EVENTS) {
+        fprintf(stderr, "Too many events (max %d)\n", MAX_EVENTS);
+        return -1;
+    }
+    if (event_parse(name, &set->events[set->count]) != 0)
+        return -1;
+    set->count++;
+    return 0;
+}
+
+int event_set_parse(struct event_set *set, const char *spec) {
+    char name[EVENT_NAME_LEN];
+    size_t len = 0;
+    int in_pmu = 0;
+
+    set->count = 0;
+    for (const char *p = spec;; p++) {
+        if (*p == '/')
+            in_pmu = !in_pmu;
+        if (*p == '\0' || (*p == ',' && !in_pmu)) {
+            name[len] = '\0';
+            if (len > 0 && event_set_add(set, name) != 0)
+                return -1;
+            len = 0;
+            if (*p == '\0')
+                break;
+            continue;
+        }
+        if (len + 1 >= sizeof(name)) {
+            fprintf(stderr, "Event name too long in list: %s\n", spec);
+            return -1;
+        }
+        name[len++] = *p;
+    }
+    if (set->count == 0) {
+        fprintf(stderr, "Empty event list\n");
+        return -1;
+    }
+    return 0;
+}
+
+// 去掉行首尾空白，返回 NULL 表示空行或注释
+static char *trim_line(char *line) {
+    while (isspace((unsigned char)*line))
+        line++;
+    char *end = line + strlen(line);
+    while (end > line && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+    if (*line == '\0' || *line == '#')
+        return NULL;
+    return line;
+}
+
+int event_set_load(struct event_set *set, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "无法打开事件文件: %s\n", path);
+        return -1;
+    }
+
+    char line[256];
+    set->count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        char *name = trim_line(line);
+        if (name && event_set_add(set, name) != 0) {
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+
+    if (set->count == 0) {
+        fprintf(stderr, "事件文件为空: %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void event_set_default(struct event_set *set) {
+    set->count = 0;
+    for (size_t i = 0; i < sizeof(default_names) / sizeof(default_names[0]); i++)
+        event_set_add(set, default_names[i]);
+}
+
+int event_equal(const EventDef *a, const EventDef *b) {
+    return a->type == b->type && a->config == b->config;
+}
+
+int schema_load(struct feature_schema *schema, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return -1;
+
+    char line[256];
+    schema->rows_per_window = 0;
+    schema->events.count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        char *text = trim_line(line);
+        if (!text)
+            continue;
+        if (strncmp(text, "rows_per_window", 15) == 0) {
+            schema->rows_per_window = atoi(text + 15);
+        } else if (strncmp(text, "event", 5) == 0 && isspace((unsigned char)text[5])) {
+            char *name = trim_line(text + 5);
+            if (!name || event_set_add(&schema->events, name) != 0) {
+                fclose(file);
+                return -1;
+            }
+        } else {
+            fprintf(stderr, "模式文件 %s 中无法识别的行: %s\n", path, text);
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+
+    if (schema->rows_per_window <= 0 || schema->events.count == 0) {
+        fprintf(stderr, "模式文件 %s 不完整\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+int schema_save(const struct feature_schema *schema, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "无法写入模式文件: %s\n", path);
+        return -1;
+    }
+    fprintf(file, "rows_per_window %d\n", schema->rows_per_window);
+    for (int i = 0; i < schema->events.count; i++)
+        fprintf(file, "event %s\n", schema->events.events[i].name);
+    fclose(file);
+    return 0;
+}
+
+int schema_check(const struct feature_schema *schema, const struct event_set *set,
+                 int input_dim, char *err, size_t err_len) {
+    if (schema->rows_per_window * schema->events.count != input_dim) {
+        snprintf(err, err_len, "schema has %d rows x %d events, model input is %d",
+                 schema->rows_per_window, schema->events.count, input_dim);
+        return -1;
+    }
+    if (set->count != schema->events.count) {
+        snprintf(err, err_len, "model expects %d events, live event set has %d",
+                 schema->events.count, set->count);
+        return -1;
+    }
+    for (int i = 0; i < set->count; i++) {
+        if (!event_equal(&set->events[i], &schema->events.events[i])) {
+            snprintf(err, err_len, "event %d: model expects %s, live event set has %s",
+                     i, schema->events.events[i].name, set->events[i].name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// model_weights.bin -> model_weights.schema
+void schema_path_for(const char *weights_path, char *out, size_t out_len) {
+    size_t len = strlen(weights_path);
+    if (len > 4 && strcmp(weights_path + len - 4, ".bin") == 0)
+        len -= 4;
+    snprintf(out, out_len, "%.*s.schema", (int)len, weights_path);
+}
@@ -0,0 +1,61 @@
+#ifndef EVENT_SET_H
+#define EVENT_SET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 事件集与特征模式，采集端（code/ 与 collect_data/program/）和推理端共用
+
+#define MAX_EVENTS 8
+#define EVENT_NAME_LEN 64
+
+typedef struct {
+    char name[EVENT_NAME_LEN];
+    uint32_t type;
+    uint64_t config;
+} EventDef;
+
+struct event_set {
+    int count;
+    EventDef events[MAX_EVENTS];
+};
+
+// 特征模式：每个推理窗口 rows_per_window 行，每行按 events 顺序排列（样本优先）
+struct feature_schema {
+    int rows_per_window;
+    struct event_set events;
+};
+
+// 解析单个事件名：
+//   硬件/软件事件    instructions, cycles, branches, cache-misses, task-clock ...
+//   硬件缓存事件      L1-dcache-load-misses, LLC-loads, dTLB-store-misses ...
+//   原始 PMU 编码     r01c2
+//   libpfm 风格       cpu/event=0xc4,umask=0x01[,cmask=N,edge,inv]/
+int event_parse(const char *name, EventDef *ev);
+
+// 解析逗号分隔的事件列表（cpu/.../ 内部的逗号不作分隔）
+int event_set_parse(struct event_set *set, const char *spec);
+
+// 从文件读取事件列表，每行一个事件，# 开头为注释
+int event_set_load(struct event_set *set, const char *path);
+
+// 采集端默认事件集（与数据集采集器一致）
+void event_set_default(struct event_set *set);
+
+int event_equal(const EventDef *a, const EventDef *b);
+
+// 模式文件格式：
+//   rows_per_window 10
+//   event branches
+//   ...
+int schema_load(struct feature_schema *schema, const char *path);
+int schema_save(const struct feature_schema *schema, const char *path);
+
+// 权重文件对应的模式文件路径：xxx.bin -> xxx.schema
+void schema_path_for(const char *weights_path, char *out, size_t out_len);
+
+// 检查实际事件集与模型模式是否一致，不一致时把原因写入 err
+int schema_check(const struct feature_schema *schema, const struct event_set *set,
+                 int input_dim, char *err, size_t err_len);
+
+#endif
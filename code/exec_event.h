@@ -0,0 +1,15 @@
+#ifndef EXEC_EVENT_H
+#define EXEC_EVENT_H
+
+// BPF 程序与用户态共用的 execve 事件格式
+#ifndef __VMLINUX_H__
+#include <linux/types.h>
+#endif
+
+struct exec_event {
+    __u32 pid;
+    __u32 pad;
+    __u64 exec_ns;      // bpf_ktime_get_ns()，CLOCK_MONOTONIC
+};
+
+#endif
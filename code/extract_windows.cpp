@@ -0,0 +1,238 @@
+// 特征窗口提取：mmap 读取数据集（.kds 文件或 perf_output CSV 目录），按
+// 行数 x 事件、步长和截断长度切出固定窗口，多线程写入一个连续的 float32 张量文件，
+// Python 端直接 np.memmap：
+//
+//   <out>.f32       窗口数 x (rows * 事件数) 个 float32，窗口内按行优先（与 train.py 展平一致）
+//   <out>.labels    每个窗口一个 uint8 标签
+//   <out>.samples   每个窗口所属样本号（uint32，CSV 输入为文件序号），用于按样本划分训练/测试集
+//   <out>.json      形状、事件名、参数
+//
+//   extract_windows -o windows [-r 10] [-s 10] [-t 90] [-e 事件列表] [-j 线程数]
+//                   benign.kds:0 dataset/ransomware/ransomware_vec:1 ...
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "dataset_series.h"
+
+namespace {
+
+struct Options {
+    int rows = 10;
+    int stride = 10;
+    int truncate = 0;                   // 每条序列最多使用的行数，0 表示不截断
+    int threads = 0;
+    std::vector<std::string> events;    // 为空时使用第一个输入的全部事件
+    std::string out;
+};
+
+size_t window_count(const Options &opt, uint32_t rows) {
+    if (rows < static_cast<uint32_t>(opt.rows))
+        return 0;
+    return (rows - opt.rows) / opt.stride + 1;
+}
+
+// 读取失败时返回 false，该序列的窗口未写入（仍为 0）
+bool extract(const Options &opt, const Series &s, size_t first_window, float *out, uint8_t *labels,
+             uint32_t *samples) {
+    size_t windows = window_count(opt, s.rows);
+    if (windows == 0)
+        return true;
+    std::vector<float> rows;
+    long nrows = series_read(s, s.rows, rows);
+    if (nrows < 0) {
+        if (s.chunk)
+            std::fprintf(stderr, "读取 %s 中样本 %u 失败\n", s.input->path.c_str(), s.sample_id);
+        else
+            std::fprintf(stderr, "读取 %s 失败\n", s.csv_path.c_str());
+        return false;
+    }
+
+    // 解析出的有效行可能少于行数（空行），缺少的部分补 0
+    size_t nev = opt.events.size();
+    size_t dim = static_cast<size_t>(opt.rows) * nev;
+    for (size_t w = 0; w < windows; w++) {
+        float *dst = out + (first_window + w) * dim;
+        size_t start = w * opt.stride;
+        size_t have = start < static_cast<size_t>(nrows) ? std::min<size_t>(opt.rows, nrows - start) : 0;
+        std::memcpy(dst, rows.data() + start * nev, have * nev * sizeof(float));
+        std::memset(dst + have * nev, 0, (dim - have * nev) * sizeof(float));
+        labels[first_window + w] = s.input->label;
+        samples[first_window + w] = s.sample_id;
+    }
+    return true;
+}
+
+// 创建大小为 size 的输出文件并映射
+void *map_output(const std::string &path, size_t size) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        std::fprintf(stderr, "创建 %s 失败: %s\n", path.c_str(), strerror(errno));
+        return nullptr;
+    }
+    void *map = nullptr;
+    if (ftruncate(fd, size) == -1) {
+        std::fprintf(stderr, "扩展 %s 失败: %s\n", path.c_str(), strerror(errno));
+    } else if (size > 0) {
+        map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            std::fprintf(stderr, "映射 %s 失败: %s\n", path.c_str(), strerror(errno));
+            map = nullptr;
+        }
+    }
+    close(fd);
+    return map;
+}
+
+bool write_meta(const Options &opt, size_t windows, const std::vector<std::unique_ptr<SeriesInput>> &inputs) {
+    std::string path = opt.out + ".json";
+    FILE *f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        std::fprintf(stderr, "创建 %s 失败: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+    std::fprintf(f, "{\n  \"windows\": %zu,\n  \"rows\": %d,\n  \"stride\": %d,\n  \"truncate\": %d,\n",
+                 windows, opt.rows, opt.stride, opt.truncate);
+    std::fprintf(f, "  \"dim\": %zu,\n  \"events\": [", opt.rows * opt.events.size());
+    for (size_t i = 0; i < opt.events.size(); i++)
+        std::fprintf(f, "%s\"%s\"", i ? ", " : "", opt.events[i].c_str());
+    std::fprintf(f, "],\n  \"inputs\": [");
+    for (size_t i = 0; i < inputs.size(); i++)
+        std::fprintf(f, "%s{\"path\": \"%s\", \"label\": %u}", i ? ", " : "", inputs[i]->path.c_str(),
+                     inputs[i]->label);
+    std::fprintf(f, "]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "用法: extract_windows -o 输出前缀 [-r 行数] [-s 步长] [-t 截断行数] [-e 事件列表] [-j 线程数]\n"
+                 "                      输入:标签 ...\n"
+                 "  输入为 .kds 数据集文件或 perf_output CSV 目录，标签为 0~255\n"
+                 "  -r N   每个窗口的行数（默认 10）\n"
+                 "  -s N   相邻窗口起点的间隔（默认与 -r 相同，不重叠）\n"
+                 "  -t N   每条序列只使用前 N 行（如 90，代替 script.py 截断 CSV），默认不截断\n"
+                 "  -e     事件列表，按此顺序输出（默认第一个输入的全部事件）\n"
+                 "  -j N   线程数（默认 CPU 数）\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    bool stride_set = false;
+    int c;
+    while ((c = getopt(argc, argv, "o:r:s:t:e:j:h")) != -1) {
+        switch (c) {
+        case 'o':
+            opt.out = optarg;
+            break;
+        case 'r':
+            opt.rows = std::atoi(optarg);
+            break;
+        case 's':
+            opt.stride = std::atoi(optarg);
+            stride_set = true;
+            break;
+        case 't':
+            opt.truncate = std::atoi(optarg);
+            break;
+        case 'e':
+            opt.events = series_split(optarg, ',');
+            break;
+        case 'j':
+            opt.threads = std::atoi(optarg);
+            break;
+        default:
+            usage();
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (!stride_set)
+        opt.stride = opt.rows;
+    if (opt.out.empty() || optind == argc || opt.rows <= 0 || opt.stride <= 0 || opt.truncate < 0) {
+        usage();
+        return 1;
+    }
+    if (opt.threads <= 0)
+        opt.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<SeriesInput>> inputs;
+    std::vector<Series> series;
+    for (int i = optind; i < argc; i++) {
+        inputs.emplace_back(new SeriesInput);
+        if (!series_input_parse(argv[i], inputs.back().get()) ||
+            !series_list(*inputs.back(), opt.events, series))
+            return 1;
+    }
+    if (opt.events.empty() || opt.events.size() > MAX_EVENTS) {
+        std::fprintf(stderr, "事件数无效\n");
+        return 1;
+    }
+
+    // 先确定每条序列的窗口位置，各线程直接写入输出文件的不同区域
+    std::vector<size_t> first_window(series.size());
+    size_t windows = 0;
+    for (size_t i = 0; i < series.size(); i++) {
+        Series &s = series[i];
+        if (opt.truncate > 0 && s.rows > static_cast<uint32_t>(opt.truncate))
+            s.rows = opt.truncate;
+        first_window[i] = windows;
+        windows += window_count(opt, s.rows);
+    }
+    size_t dim = static_cast<size_t>(opt.rows) * opt.events.size();
+    float *out = static_cast<float *>(map_output(opt.out + ".f32", windows * dim * sizeof(float)));
+    uint8_t *labels = static_cast<uint8_t *>(map_output(opt.out + ".labels", windows));
+    uint32_t *samples = static_cast<uint32_t *>(map_output(opt.out + ".samples", windows * sizeof(uint32_t)));
+    if (windows > 0 && (!out || !labels || !samples))
+        return 1;
+
+    std::atomic<size_t> next{0}, failed{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < opt.threads; t++) {
+        workers.emplace_back([&] {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < series.size();) {
+                if (!extract(opt, series[i], first_window[i], out, labels, samples))
+                    failed.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (std::thread &w : workers)
+        w.join();
+
+    if (windows > 0) {
+        munmap(out, windows * dim * sizeof(float));
+        munmap(labels, windows);
+        munmap(samples, windows * sizeof(uint32_t));
+    }
+    // 失败序列的窗口是全 0、标签 0 的占位，不能用于训练：删除输出，不写 .json
+    if (failed > 0) {
+        std::fprintf(stderr, "%zu 条序列读取失败，未生成输出\n", failed.load());
+        for (const char *ext : {".f32", ".labels", ".samples"})
+            unlink((opt.out + ext).c_str());
+        return 1;
+    }
+    if (!write_meta(opt, windows, inputs))
+        return 1;
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("%zu 条序列 -> %zu 个窗口（%zu 维），%d 线程，用时 %.2f s，输出 %s.f32\n", series.size(),
+                windows, dim, opt.threads, secs, opt.out.c_str());
+    return 0;
+}
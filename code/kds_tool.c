@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <limits.h>
+#include "dataset.h"
+
+// 数据集工具：
+//   kds_tool info <文件>                           事件、分块数、样本数、压缩情况
+//   kds_tool list <文件>                           每块一行：样本号 PID 行数 压缩 哈希
+//   kds_tool dump <文件> <样本号> [PID]             按 perf_output_<pid>.csv 的格式输出
+//   kds_tool import [-c 压缩] [-M 映射文件] <输出文件> <数据目录>
+//                                                  把 data_a_<样本号>/perf_output_<pid>.csv 转为数据集
+
+#define MAX_IMPORT_ROWS 100000
+
+static void usage(void) {
+    fprintf(stderr,
+            "用法: kds_tool info <文件>\n"
+            "      kds_tool list <文件>\n"
+            "      kds_tool dump <文件> <样本号> [PID]\n"
+            "      kds_tool import [-c none|zstd|lz4] [-M md5_mapping.txt] <输出文件> <数据目录>\n");
+}
+
+static int cmd_info(const char *path) {
+    struct kds_reader *r = kds_open(path);
+    if (!r)
+        return 1;
+    size_t samples = 0, rows = 0, stored = 0, raw = 0, by_codec[3] = {0};
+    for (size_t i = 0; i < kds_count(r); i++) {
+        const struct kds_chunk *c = kds_chunk_at(r, i);
+        if (i == 0 || c->sample_id != kds_chunk_at(r, i - 1)->sample_id)
+            samples++;
+        rows += c->rows;
+        stored += c->stored_size;
+        raw += (size_t)c->columns * c->rows * sizeof(uint64_t);
+        if (c->codec <= KDS_CODEC_LZ4)
+            by_codec[c->codec]++;
+    }
+    printf("事件:");
+    for (int i = 0; i < kds_event_count(r); i++)
+        printf(" %s", kds_event_name(r, i));
+    printf("\n样本 %zu，分块 %zu（none %zu / zstd %zu / lz4 %zu），共 %zu 行\n", samples,
+           kds_count(r), by_codec[0], by_codec[1], by_codec[2], rows);
+    printf("数据 %zu 字节，原始 %zu 字节（%.1f%%）\n", stored, raw, raw ? 100.0 * stored / raw : 0);
+    if (kds_superseded(r))
+        printf("另有 %zu 块属于被重新采集取代的尝试，已忽略\n", kds_superseded(r));
+    kds_close(r);
+    return 0;
+}
+
+static int cmd_list(const char *path) {
+    struct kds_reader *r = kds_open(path);
+    if (!r)
+        return 1;
+    printf("sample,pid,rows,codec,hash\n");
+    for (size_t i = 0; i < kds_count(r); i++) {
+        const struct kds_chunk *c = kds_chunk_at(r, i);
+        char hex[KDS_HASH_LEN * 2 + 1];
+        kds_hash_format(c->hash, hex, sizeof(hex));
+        printf("%u,%u,%u,%s,%s\n", c->sample_id, c->pid, c->rows, kds_codec_name(c->codec), hex);
+    }
+    kds_close(r);
+    return 0;
+}
+
+static int dump_chunk(const struct kds_reader *r, const struct kds_chunk *c) {
+    uint64_t *buf = malloc((size_t)c->columns * c->rows * sizeof(uint64_t) + 1);
+    const uint64_t *cols = buf ? kds_columns(r, c, buf) : NULL;
+    if (!cols) {
+        fprintf(stderr, "读取样本 %u PID %u 失败\n", c->sample_id, c->pid);
+        free(buf);
+        return -1;
+    }
+    printf("sample");
+    for (int i = 0; i < c->columns; i++)
+        printf(",%s", kds_event_name(r, i));
+    printf("\n");
+    for (uint32_t row = 0; row < c->rows; row++) {
+        printf("%u", row);
+        for (int i = 0; i < c->columns; i++)
+            printf(",%" PRIu64, cols[(size_t)i * c->rows + row]);
+        printf("\n");
+    }
+    free(buf);
+    return 0;
+}
+
+static int cmd_dump(const char *path, uint32_t sample_id, int pid) {
+    struct kds_reader *r = kds_open(path);
+    if (!r)
+        return 1;
+    size_t first, n = kds_find(r, sample_id, &first);
+    int ret = 1;
+    for (size_t i = first; i < first + n; i++) {
+        const struct kds_chunk *c = kds_chunk_at(r, i);
+        if (pid >= 0 && c->pid != (uint32_t)pid)
+            continue;
+        if (pid < 0)
+            printf("# pid %u\n", c->pid);
+        ret = dump_chunk(r, c) == 0 ? 0 : 1;
+    }
+    if (n == 0)
+        fprintf(stderr, "数据集中没有样本 %u\n", sample_id);
+    kds_close(r);
+    return ret;
+}
+
+// 读取一个 perf_output CSV 到列优先的 values（stride 为 MAX_IMPORT_ROWS），返回行数
+static int read_csv(const char *path, struct event_set *events, uint64_t *values) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "打开 %s 失败\n", path);
+        return -1;
+    }
+    char line[1024];
+    if (!fgets(line, sizeof(line), file)) {
+        fclose(file);
+        return 0;
+    }
+    // 表头：sample,事件1,事件2...
+    struct event_set header = {0};
+    char *save, *tok = strtok_r(line, ",\r\n", &save);
+    while ((tok = strtok_r(NULL, ",\r\n", &save)) && header.count < MAX_EVENTS)
+        snprintf(header.events[header.count++].name, EVENT_NAME_LEN, "%s", tok);
+    if (events->count == 0) {
+        *events = header;
+    } else {
+        int same = header.count == events->count;
+        for (int i = 0; same && i < header.count; i++)
+            same = strcmp(header.events[i].name, events->events[i].name) == 0;
+        if (!same) {
+            fprintf(stderr, "%s 的事件列与之前的文件不一致，跳过\n", path);
+            fclose(file);
+            return -1;
+        }
+    }
+
+    int rows = 0;
+    while (rows < MAX_IMPORT_ROWS && fgets(line, sizeof(line), file)) {
+        char *p = strchr(line, ',');
+        int col = 0;
+        while (p && col < events->count) {
+            values[(size_t)col * MAX_IMPORT_ROWS + rows] = strtoull(p + 1, &p, 10);
+            col++;
+            p = strchr(p, ',');
+        }
+        if (col == events->count)
+            rows++;
+    }
+    fclose(file);
+    return rows;
+}
+
+static int cmd_import(int argc, char **argv) {
+    enum kds_codec codec = KDS_CODEC_NONE;
+    const char *mapping_path = NULL;
+    int opt;
+    optind = 1;
+    while ((opt = getopt(argc, argv, "c:M:")) != -1) {
+        switch (opt) {
+        case 'c': {
+            int c = kds_codec_parse(optarg);
+            if (c < 0)
+                return 1;
+            codec = c;
+            break;
+        }
+        case 'M':
+            mapping_path = optarg;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        usage();
+        return 1;
+    }
+    const char *out_path = argv[optind], *data_dir = argv[optind + 1];
+
+    uint32_t mapped = 0;
+    uint8_t *hashes = NULL;
+    if (mapping_path && !(hashes = kds_mapping_load(mapping_path, &mapped)))
+        return 1;
+
+    DIR *dir = opendir(data_dir);
+    if (!dir) {
+        fprintf(stderr, "打开数据目录 %s 失败\n", data_dir);
+        free(hashes);
+        return 1;
+    }
+    uint64_t *values = malloc((size_t)MAX_EVENTS * MAX_IMPORT_ROWS * sizeof(uint64_t));
+    struct event_set events = {0};
+    struct kds_writer *w = NULL;
+    size_t chunks = 0, skipped = 0;
+    struct dirent *sample;
+    while (values && (sample = readdir(dir))) {
+        unsigned int sample_id;
+        char tail;
+        if (sscanf(sample->d_name, "data_a_%u%c", &sample_id, &tail) != 1)
+            continue;
+        char sample_path[PATH_MAX];
+        snprintf(sample_path, sizeof(sample_path), "%s/%s", data_dir, sample->d_name);
+        DIR *sd = opendir(sample_path);
+        if (!sd)
+            continue;
+        struct dirent *file;
+        while ((file = readdir(sd))) {
+            unsigned int pid;
+            char suffix[8];
+            if (sscanf(file->d_name, "perf_output_%u.%7s", &pid, suffix) != 2 || strcmp(suffix, "csv") != 0)
+                continue;
+            char csv_path[PATH_MAX + 256];
+            snprintf(csv_path, sizeof(csv_path), "%s/%s", sample_path, file->d_name);
+            int rows = read_csv(csv_path, &events, values);
+            if (rows <= 0) {
+                skipped++;
+                continue;
+            }
+            if (!w && !(w = kds_writer_open(out_path, &events, codec)))
+                break;
+            const uint8_t *hash = sample_id < mapped ? hashes + (size_t)sample_id * KDS_HASH_LEN : NULL;
+            if (kds_append(w, sample_id, 0, pid, hash, values, MAX_IMPORT_ROWS, rows) == 0)
+                chunks++;
+        }
+        closedir(sd);
+        if (events.count && !w)
+            break;
+    }
+    closedir(dir);
+    free(values);
+    free(hashes);
+    if (!w) {
+        fprintf(stderr, "没有导入任何数据\n");
+        return 1;
+    }
+    int ret = kds_writer_close(w);
+    printf("导入 %zu 个文件到 %s，跳过 %zu 个\n", chunks, out_path, skipped);
+    return ret == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    const char *cmd = argv[1];
+    if (strcmp(cmd, "info") == 0)
+        return cmd_info(argv[2]);
+    if (strcmp(cmd, "list") == 0)
+        return cmd_list(argv[2]);
+    if (strcmp(cmd, "dump") == 0 && argc >= 4)
+        return cmd_dump(argv[2], strtoul(argv[3], NULL, 10), argc >= 5 ? atoi(argv[4]) : -1);
+    if (strcmp(cmd, "import") == 0)
+        return cmd_import(argc - 1, argv + 1);
+    usage();
+    return 1;
+}
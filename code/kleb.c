@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <limits.h>
+#include "kleb.h"
+#include "model.h"
+
+#define HASH_SIZE 1024
+
+// 按目标累积的样本
+struct target_data {
+    uint32_t pid;
+    uint64_t cgroup_id;     // 非 0 表示 cgroup 条目（pid 为 0）
+    time_t timestamp;
+    uint64_t exec_ns;       // BPF 记录的 execve 时间，cgroup 条目为 0
+    float rows[KLEB_MAX_ROWS][MAX_EVENTS];  // 最近 KLEB_MAX_ROWS 行样本（环形）
+    size_t row_count;       // 累计接收行数
+    size_t recv_count;      // 累计接收次数
+    struct target_data *next;
+};
+
+struct kleb_ctx {
+    struct model model;
+    struct feature_schema schema;
+    struct event_set events;
+    int model_loaded;
+    int events_set;
+    struct target_data *table[HASH_SIZE];
+    struct kleb_verdict queue[KLEB_VERDICT_QUEUE];
+    size_t queue_head;      // 下一条待取出的结果
+    size_t queue_len;
+    uint64_t dropped;
+    char error[256];
+};
+
+static int fail(struct kleb_ctx *ctx, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(ctx->error, sizeof(ctx->error), fmt, ap);
+    va_end(ap);
+    return -1;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+struct kleb_ctx *kleb_create(void) {
+    struct kleb_ctx *ctx = calloc(1, sizeof(*ctx));
+    if (!ctx)
+        return NULL;
+    ctx->schema.rows_per_window = KLEB_DEFAULT_ROWS;
+    event_set_default(&ctx->schema.events);
+    ctx->events = ctx->schema.events;
+    return ctx;
+}
+
+void kleb_destroy(struct kleb_ctx *ctx) {
+    if (!ctx)
+        return;
+    kleb_expire(ctx, 0);
+    free(ctx);
+}
+
+static int check_events(struct kleb_ctx *ctx, const struct event_set *events) {
+    char err[200];
+    if (schema_check(&ctx->schema, events, INPUT_DIM, err, sizeof(err)) != 0)
+        return fail(ctx, "模型特征模式与实际事件集不一致: %s", err);
+    return 0;
+}
+
+int kleb_load_model(struct kleb_ctx *ctx, const char *weights_path) {
+    struct feature_schema schema;
+    char schema_path[PATH_MAX];
+    schema_path_for(weights_path, schema_path, sizeof(schema_path));
+    if (schema_load(&schema, schema_path) != 0) {
+        fprintf(stderr, "No model schema at %s, assuming default events with %d rows per window\n",
+                schema_path, KLEB_DEFAULT_ROWS);
+        schema.rows_per_window = KLEB_DEFAULT_ROWS;
+        event_set_default(&schema.events);
+    }
+    if (schema.rows_per_window > KLEB_MAX_ROWS)
+        return fail(ctx, "rows_per_window %d 超过上限 %d", schema.rows_per_window, KLEB_MAX_ROWS);
+    if (kleb_load_weights(&ctx->model, weights_path) != 0)
+        return fail(ctx, "无法加载权重文件: %s", weights_path);
+
+    ctx->schema = schema;
+    ctx->model_loaded = 1;
+    if (!ctx->events_set)
+        ctx->events = schema.events;
+    return check_events(ctx, &ctx->events);
+}
+
+int kleb_set_events(struct kleb_ctx *ctx, const struct event_set *events) {
+    if (ctx->model_loaded && check_events(ctx, events) != 0)
+        return -1;
+    ctx->events = *events;
+    ctx->events_set = 1;
+    return 0;
+}
+
+const struct feature_schema *kleb_schema(const struct kleb_ctx *ctx) {
+    return &ctx->schema;
+}
+
+const struct event_set *kleb_events(const struct kleb_ctx *ctx) {
+    return &ctx->events;
+}
+
+const char *kleb_error(const struct kleb_ctx *ctx) {
+    return ctx->error;
+}
+
+uint64_t kleb_dropped(const struct kleb_ctx *ctx) {
+    return ctx->dropped;
+}
+
+static unsigned int hash_key(uint32_t pid, uint64_t cgroup_id) {
+    return (pid ^ cgroup_id ^ (cgroup_id >> 32)) % HASH_SIZE;
+}
+
+// 查找或创建目标数据节点
+static struct target_data *get_entry(struct kleb_ctx *ctx, uint32_t pid, uint64_t cgroup_id) {
+    unsigned int index = hash_key(pid, cgroup_id);
+    for (struct target_data *entry = ctx->table[index]; entry; entry = entry->next) {
+        if (entry->pid == pid && entry->cgroup_id == cgroup_id)
+            return entry;
+    }
+
+    struct target_data *entry = calloc(1, sizeof(*entry));
+    if (!entry)
+        return NULL;
+    entry->pid = pid;
+    entry->cgroup_id = cgroup_id;
+    entry->timestamp = time(NULL);
+    entry->next = ctx->table[index];
+    ctx->table[index] = entry;
+    return entry;
+}
+
+void kleb_expire(struct kleb_ctx *ctx, time_t max_age_s) {
+    time_t now = time(NULL);
+    for (int i = 0; i < HASH_SIZE; i++) {
+        struct target_data **link = &ctx->table[i];
+        while (*link) {
+            struct target_data *entry = *link;
+            if (now - entry->timestamp >= max_age_s) {
+                *link = entry->next;
+                free(entry);
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+static void push_verdict(struct kleb_ctx *ctx, const struct kleb_verdict *v) {
+    if (ctx->queue_len == KLEB_VERDICT_QUEUE) {
+        // 调用者未及时取走，丢弃最旧的一条
+        ctx->queue_head = (ctx->queue_head + 1) % KLEB_VERDICT_QUEUE;
+        ctx->queue_len--;
+        ctx->dropped++;
+    }
+    ctx->queue[(ctx->queue_head + ctx->queue_len) % KLEB_VERDICT_QUEUE] = *v;
+    ctx->queue_len++;
+}
+
+int kleb_poll(struct kleb_ctx *ctx, struct kleb_verdict *out, int max) {
+    int n = 0;
+    while (n < max && ctx->queue_len > 0) {
+        out[n++] = ctx->queue[ctx->queue_head];
+        ctx->queue_head = (ctx->queue_head + 1) % KLEB_VERDICT_QUEUE;
+        ctx->queue_len--;
+    }
+    return n;
+}
+
+int kleb_feed(struct kleb_ctx *ctx, uint32_t pid, uint64_t cgroup_id, uint64_t exec_ns,
+              const float *rows, int row_count) {
+    if (!ctx->model_loaded)
+        return fail(ctx, "模型未加载");
+    if (row_count <= 0)
+        return fail(ctx, "窗口没有样本");
+    struct target_data *entry = get_entry(ctx, pid, cgroup_id);
+    if (!entry)
+        return fail(ctx, "内存不足");
+
+    int n = ctx->events.count;
+    if (exec_ns)
+        entry->exec_ns = exec_ns;
+    // 追加到环形行缓冲区
+    for (int r = 0; r < row_count; r++) {
+        memcpy(entry->rows[entry->row_count % KLEB_MAX_ROWS], rows + r * n, n * sizeof(float));
+        entry->row_count++;
+    }
+    entry->recv_count++;
+    entry->timestamp = time(NULL);
+
+    // 每次接收到数据时用最近 rows_per_window 行进行推理，不足时填充 0
+    float input[INPUT_DIM] = {0};
+    int need = ctx->schema.rows_per_window;
+    size_t have = entry->row_count < (size_t)need ? entry->row_count : (size_t)need;
+    size_t first = entry->row_count - have;
+    for (size_t r = 0; r < have; r++)
+        memcpy(&input[r * n], entry->rows[(first + r) % KLEB_MAX_ROWS], n * sizeof(float));
+
+    struct kleb_verdict v = {
+        .pid = entry->pid,
+        .cgroup_id = entry->cgroup_id,
+        .window = entry->recv_count,
+        .exec_ns = entry->exec_ns,
+    };
+    uint64_t start = monotonic_ns();
+    kleb_forward(&ctx->model, input, v.score);
+    v.time_ns = monotonic_ns();
+    v.infer_ns = v.time_ns - start;
+    v.prediction = v.score[0] > v.score[1] ? 0 : 1;
+    push_verdict(ctx, &v);
+    return 0;
+}
+
+// 解析一个窗口的文本数据，按样本优先写入 rows，返回解析出的行数。
+// 事件名必须与事件集一致，否则拒绝该窗口
+static int parse_window(struct kleb_ctx *ctx, const char *buffer, float rows[][MAX_EVENTS],
+                        int max_rows) {
+    const struct event_set *events = &ctx->events;
+    int event_idx = -1;
+    int row_count = max_rows;
+
+    for (const char *line = buffer; line && *line; line = strchr(line, '\n'), line = line ? line + 1 : NULL) {
+        char name[EVENT_NAME_LEN];
+        if (sscanf(line, "Event: %63s", name) == 1) {
+            event_idx++;
+            if (event_idx >= events->count || strcmp(name, events->events[event_idx].name) != 0)
+                return fail(ctx, "窗口事件 %s 与模型模式不一致", name);
+            continue;
+        }
+        if (event_idx < 0 || strncmp(line, "  [", 3) != 0)
+            continue;
+
+        // 一行内依次是 "  [NN] value\t"
+        int row = 0;
+        const char *p = line;
+        float value;
+        int consumed;
+        while (row < max_rows && sscanf(p, "  [%*d] %f\t%n", &value, &consumed) == 1) {
+            rows[row++][event_idx] = value;
+            p += consumed;
+        }
+        if (row < row_count)
+            row_count = row;
+    }
+    if (event_idx != events->count - 1)
+        return fail(ctx, "窗口包含 %d 个事件，模型需要 %d 个", event_idx + 1, events->count);
+    return row_count;
+}
+
+int kleb_feed_window(struct kleb_ctx *ctx, const char *window, struct kleb_window_info *info) {
+    struct kleb_window_info local;
+    if (!info)
+        info = &local;
+    memset(info, 0, sizeof(*info));
+
+    if (sscanf(window, "[PID: %" SCNu32 "]", &info->pid) != 1 &&
+        (sscanf(window, "[CGROUP: %" SCNu64 "]", &info->cgroup_id) != 1 || info->cgroup_id == 0))
+        return fail(ctx, "窗口头部无法识别");
+
+    // 采集端写入的时间戳
+    const char *time_line = strstr(window, "\nTime: ");
+    if (time_line && sscanf(time_line + 1, "Time: exec=%" SCNu64 " window=%" SCNu64 " sent=%" SCNu64,
+                            &info->exec_ns, &info->window_ns, &info->sent_ns) != 3)
+        info->exec_ns = info->window_ns = info->sent_ns = 0;
+
+    float rows[KLEB_MAX_ROWS][MAX_EVENTS];
+    int count = parse_window(ctx, window, rows, KLEB_MAX_ROWS);
+    if (count < 0)
+        return -1;
+    if (count == 0)
+        return fail(ctx, "窗口没有样本");
+
+    // rows 按 MAX_EVENTS 对齐，kleb_feed 需要紧凑排列
+    int n = ctx->events.count;
+    float packed[KLEB_MAX_ROWS * MAX_EVENTS];
+    for (int r = 0; r < count; r++)
+        memcpy(&packed[r * n], rows[r], n * sizeof(float));
+    return kleb_feed(ctx, info->pid, info->cgroup_id, info->exec_ns, packed, count);
+}
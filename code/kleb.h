@@ -0,0 +1,87 @@
+#ifndef KLEB_H
+#define KLEB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// libkleb：检测核心（特征模式、按目标累积样本、推理、结果队列），不含 BPF、
+// 采集线程和全局状态。每个 kleb_ctx 相互独立，一个进程内可创建多个；
+// 同一个 ctx 的 feed/poll 须由同一线程（或调用者加锁）调用。
+//
+//   struct kleb_ctx *ctx = kleb_create();
+//   kleb_load_model(ctx, "model_weights.bin");     // 同时读取 model_weights.schema
+//   kleb_set_events(ctx, &events);                  // 可选，默认使用模式中的事件
+//   kleb_feed(ctx, pid, 0, exec_ns, rows, n);       // 或 kleb_feed_window 解析采集端文本窗口
+//   while (kleb_poll(ctx, &v, 1) == 1) ...
+//   kleb_destroy(ctx);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "event_set.h"
+
+#define KLEB_MAX_ROWS 90            // 每个目标保留的最近样本行数
+#define KLEB_VERDICT_QUEUE 256      // 未取走的推理结果上限，满时丢弃最旧的
+#define KLEB_DEFAULT_ROWS 10        // 无模式文件时每窗口行数
+
+struct kleb_ctx;
+
+struct kleb_verdict {
+    uint32_t pid;
+    uint64_t cgroup_id;     // 非 0 表示 cgroup 结果（pid 为 0）
+    uint32_t window;        // 该目标第几次接收
+    int prediction;         // 0=良性, 1=恶意
+    float score[2];         // 模型输出
+    uint64_t exec_ns;       // BPF 记录的 execve 时间（未知为 0）
+    uint64_t time_ns;       // 推理完成时间（CLOCK_MONOTONIC）
+    uint64_t infer_ns;      // 前向推理耗时
+};
+
+// 采集端文本窗口头部信息（kleb_feed_window 填写）
+struct kleb_window_info {
+    uint32_t pid;
+    uint64_t cgroup_id;
+    uint64_t exec_ns;
+    uint64_t window_ns;     // 窗口第一个样本的时间
+    uint64_t sent_ns;       // 写入管道的时间，0 表示窗口中没有时间行
+};
+
+struct kleb_ctx *kleb_create(void);
+void kleb_destroy(struct kleb_ctx *ctx);
+
+// 加载权重及同名 .schema 模式文件；没有模式文件时使用默认事件、每窗口 10 行
+int kleb_load_model(struct kleb_ctx *ctx, const char *weights_path);
+
+// 设置实际采集的事件集，须与模型模式一致
+int kleb_set_events(struct kleb_ctx *ctx, const struct event_set *events);
+
+const struct feature_schema *kleb_schema(const struct kleb_ctx *ctx);
+const struct event_set *kleb_events(const struct kleb_ctx *ctx);
+
+// 追加 row_count 行样本（每行按事件集顺序排列）并推理一次，结果进入队列。
+// 返回 0 成功，-1 失败（原因见 kleb_error）
+int kleb_feed(struct kleb_ctx *ctx, uint32_t pid, uint64_t cgroup_id, uint64_t exec_ns,
+              const float *rows, int row_count);
+
+// 解析采集端写出的一个文本窗口（[PID: N] 或 [CGROUP: N] 开头）并调用 kleb_feed
+int kleb_feed_window(struct kleb_ctx *ctx, const char *window, struct kleb_window_info *info);
+
+// 取出最多 max 条结果，返回条数
+int kleb_poll(struct kleb_ctx *ctx, struct kleb_verdict *out, int max);
+
+// 因队列满而丢弃的结果数
+uint64_t kleb_dropped(const struct kleb_ctx *ctx);
+
+// 释放 max_age_s 秒内没有新数据的目标
+void kleb_expire(struct kleb_ctx *ctx, time_t max_age_s);
+
+// 最近一次失败的原因
+const char *kleb_error(const struct kleb_ctx *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdatomic.h>
+#include <inttypes.h>
+#include <time.h>
+#include "latency.h"
+#include "logger.h"
+
+// 小于 SUB_COUNT 的值精确记录；更大的值按最高位分段，每段 SUB_HALF 个线性桶
+#define SUB_BITS 7
+#define SUB_COUNT (1 << SUB_BITS)
+#define SUB_HALF (SUB_COUNT / 2)
+#define MAX_VALUE_BITS 44       // 约 4.8 小时，更大的值记入最后一个桶
+#define BUCKETS (SUB_COUNT + (MAX_VALUE_BITS - SUB_BITS) * SUB_HALF)
+
+struct histogram {
+    _Atomic uint64_t counts[BUCKETS];
+    _Atomic uint64_t total;
+    _Atomic uint64_t sum;
+    _Atomic uint64_t max;
+};
+
+static struct histogram histograms[LAT_STAGE_COUNT];
+
+static const char *stage_names[LAT_STAGE_COUNT] = {
+    [LAT_EXEC_TO_EVENT] = "exec_to_event",
+    [LAT_EXEC_TO_COLLECT] = "exec_to_collect",
+    [LAT_WINDOW] = "window",
+    [LAT_PIPE] = "pipe",
+    [LAT_INFERENCE] = "inference",
+    [LAT_OUTPUT] = "output",
+    [LAT_EXEC_TO_VERDICT] = "exec_to_verdict",
+    [LAT_EXEC_TO_CONTAIN] = "exec_to_contain",
+};
+
+uint64_t latency_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int bucket_index(uint64_t v) {
+    if (v < SUB_COUNT)
+        return v;
+    int shift = 63 - __builtin_clzll(v) - (SUB_BITS - 1);
+    int index = SUB_COUNT + (shift - 1) * SUB_HALF + (int)((v >> shift) - SUB_HALF);
+    return index < BUCKETS ? index : BUCKETS - 1;
+}
+
+// 桶内最大值
+static uint64_t bucket_value(int index) {
+    if (index < SUB_COUNT)
+        return index;
+    int shift = (index - SUB_COUNT) / SUB_HALF + 1;
+    uint64_t sub = (index - SUB_COUNT) % SUB_HALF + SUB_HALF;
+    return ((sub + 1) << shift) - 1;
+}
+
+void latency_record(enum latency_stage stage, uint64_t ns) {
+    struct histogram *h = &histograms[stage];
+    atomic_fetch_add_explicit(&h->counts[bucket_index(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->total, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, ns, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (ns > max &&
+           !atomic_compare_exchange_weak_explicit(&h->max, &max, ns, memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+}
+
+const char *latency_stage_name(enum latency_stage stage) {
+    return stage_names[stage];
+}
+
+uint64_t latency_count(enum latency_stage stage) {
+    return atomic_load_explicit(&histograms[stage].total, memory_order_relaxed);
+}
+
+uint64_t latency_sum(enum latency_stage stage) {
+    return atomic_load_explicit(&histograms[stage].sum, memory_order_relaxed);
+}
+
+uint64_t latency_max(enum latency_stage stage) {
+    return atomic_load_explicit(&histograms[stage].max, memory_order_relaxed);
+}
+
+uint64_t latency_percentile(enum latency_stage stage, double q) {
+    const struct histogram *h = &histograms[stage];
+    uint64_t total = latency_count(stage);
+    if (total == 0)
+        return 0;
+    uint64_t target = (uint64_t)(q * total);
+    if (target >= total)
+        target = total - 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += atomic_load_explicit(&h->counts[i], memory_order_relaxed);
+        if (seen > target) {
+            uint64_t value = bucket_value(i);
+            uint64_t max = latency_max(stage);
+            return value < max ? value : max;
+        }
+    }
+    return latency_max(stage);
+}
+
+void latency_reset(void) {
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        struct histogram *h = &histograms[s];
+        for (int i = 0; i < BUCKETS; i++)
+            atomic_store_explicit(&h->counts[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&h->total, 0, memory_order_relaxed);
+        atomic_store_explicit(&h->sum, 0, memory_order_relaxed);
+        atomic_store_explicit(&h->max, 0, memory_order_relaxed);
+    }
+}
+
+void latency_dump(void) {
+    log_msg(LOG_INFO, "%-16s %10s %10s %10s %10s %10s %10s (ms)\n",
+            "stage", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        uint64_t count = latency_count(s);
+        if (count == 0)
+            continue;
+        log_msg(LOG_INFO, "%-16s %10" PRIu64 " %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+                stage_names[s], count,
+                latency_percentile(s, 0.50) / 1e6, latency_percentile(s, 0.90) / 1e6,
+                latency_percentile(s, 0.99) / 1e6, latency_percentile(s, 0.999) / 1e6,
+                latency_max(s) / 1e6);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 流水线各阶段延迟直方图（HDR 风格对数-线性分桶，约 1.6% 相对误差）。
+// 时间戳统一使用 CLOCK_MONOTONIC，与 BPF 的 bpf_ktime_get_ns 同一时基
+
+enum latency_stage {
+    LAT_EXEC_TO_EVENT = 0,  // execve 进入 -> 用户态收到 perf buffer 事件
+    LAT_EXEC_TO_COLLECT,    // execve 进入 -> 采集线程启用计数器
+    LAT_WINDOW,             // 窗口第一个样本 -> 窗口写入管道
+    LAT_PIPE,               // 窗口写入管道 -> 接收线程读出
+    LAT_INFERENCE,          // 前向推理
+    LAT_OUTPUT,             // 结果发布、处置与日志入队
+    LAT_EXEC_TO_VERDICT,    // execve 进入 -> 首次推理结果
+    LAT_EXEC_TO_CONTAIN,    // execve 进入 -> 处置完成
+    LAT_STAGE_COUNT
+};
+
+uint64_t latency_now(void);
+
+// 可在任意线程调用，只做原子加
+void latency_record(enum latency_stage stage, uint64_t ns);
+
+const char *latency_stage_name(enum latency_stage stage);
+uint64_t latency_count(enum latency_stage stage);
+uint64_t latency_sum(enum latency_stage stage);
+uint64_t latency_max(enum latency_stage stage);
+// q 取 0~1，返回所在桶的上界（纳秒）
+uint64_t latency_percentile(enum latency_stage stage, double q);
+
+// 清空所有直方图（基准测试在各轮之间调用，不能与 latency_record 并发）
+void latency_reset(void);
+
+// 输出各阶段 count/p50/p90/p99/p99.9/max
+void latency_dump(void);
+
+#endif
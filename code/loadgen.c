@@ -0,0 +1,517 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <math.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// 合成负载生成器：按给定速率和种子启动可复现的进程群体（exec 突发、CPU 常驻、
+// 分支密集、缓存抖动、fork 树），用于在任意 Linux 机器上测量采集开销和检测延迟。
+// 每个负载进程都经 execve 启动（/proc/self/exe --worker ...），与真实样本一样会被 BPF 捕获
+
+#define MAX_WORKLOADS 16
+#define MAX_HOGS 256
+#define WORKER_FLAG "--worker"
+
+enum work_kind {
+    WORK_EXEC,      // 短命进程，可成批启动
+    WORK_HOG,       // 常驻 CPU 死循环
+    WORK_BRANCHY,   // 不可预测分支密集
+    WORK_CACHE,     // 随机指针追逐，缓存/TLB 抖动
+    WORK_FORKTREE,  // fork 树，每个节点都 execve
+    WORK_KIND_COUNT,
+};
+
+static const char *kind_names[WORK_KIND_COUNT] = {
+    [WORK_EXEC] = "exec",
+    [WORK_HOG] = "hog",
+    [WORK_BRANCHY] = "branchy",
+    [WORK_CACHE] = "cache",
+    [WORK_FORKTREE] = "forktree",
+};
+
+struct workload {
+    enum work_kind kind;
+    double rate;        // 每秒启动次数（hog 为常驻进程数）
+    int burst;          // 每次启动的进程数
+    int life_ms;        // 每个进程的运行时间
+    int kb;             // cache 的工作集大小
+    int depth;          // forktree 深度与分叉数
+    int fanout;
+    uint64_t next_ns;   // 下一次启动的时间（相对开始）
+    uint64_t spawned;
+    uint64_t failed;
+};
+
+static volatile sig_atomic_t exiting = 0;
+static char self_exe[PATH_MAX];
+static volatile uint64_t sink;
+
+static void sig_handler(int sig) {
+    (void)sig;
+    exiting = 1;
+}
+
+static int self_exe_init(void) {
+    ssize_t len = readlink("/proc/self/exe", self_exe, sizeof(self_exe) - 1);
+    if (len < 0)
+        return -1;
+    self_exe[len] = '\0';
+    return 0;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t xorshift64(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static enum work_kind kind_parse(const char *name) {
+    for (int k = 0; k < WORK_KIND_COUNT; k++) {
+        if (strcmp(name, kind_names[k]) == 0)
+            return k;
+    }
+    return WORK_KIND_COUNT;
+}
+
+/* ---------------- 负载进程 ---------------- */
+
+// 每检查一次时钟执行的迭代数，使检查开销可忽略
+#define CHECK_EVERY 65536
+
+static void work_hog(uint64_t deadline) {
+    uint64_t acc = 1;
+    while (now_ns() < deadline) {
+        for (int i = 0; i < CHECK_EVERY; i++)
+            acc = acc * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    sink = acc;
+}
+
+static void work_branchy(uint64_t deadline, uint64_t seed) {
+    uint64_t state = seed | 1, acc = 0;
+    while (now_ns() < deadline) {
+        for (int i = 0; i < CHECK_EVERY; i++) {
+            uint64_t r = xorshift64(&state);
+            // 分支方向取决于随机位，预测器无法学习
+            if (r & 1)
+                acc += r >> 3;
+            else if (r & 2)
+                acc ^= r;
+            else
+                acc -= r >> 7;
+        }
+    }
+    sink = acc;
+}
+
+static void work_cache(uint64_t deadline, uint64_t seed, int kb) {
+    // 以缓存行为节点构造单个随机环（Sattolo 算法），逐跳访问无法被预取
+    size_t nodes = (size_t)kb * 1024 / 64;
+    if (nodes < 2)
+        nodes = 2;
+    size_t *ring = malloc(nodes * 64);
+    if (!ring) {
+        work_hog(deadline);
+        return;
+    }
+    size_t stride = 64 / sizeof(size_t);
+    for (size_t i = 0; i < nodes; i++)
+        ring[i * stride] = i;
+    uint64_t state = seed | 1;
+    for (size_t i = nodes - 1; i > 0; i--) {
+        size_t j = xorshift64(&state) % i;
+        size_t tmp = ring[i * stride];
+        ring[i * stride] = ring[j * stride];
+        ring[j * stride] = tmp;
+    }
+    size_t pos = 0;
+    while (now_ns() < deadline) {
+        for (int i = 0; i < CHECK_EVERY; i++)
+            pos = ring[pos * stride];
+    }
+    sink = pos;
+    free(ring);
+}
+
+static int exec_worker(enum work_kind kind, int life_ms, int p1, int p2, uint64_t seed);
+
+static void work_forktree(uint64_t deadline, uint64_t seed, int life_ms, int depth, int fanout) {
+    if (depth > 0) {
+        for (int i = 0; i < fanout; i++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                exec_worker(WORK_FORKTREE, life_ms, depth - 1, fanout, seed * 31 + i + 1);
+                _exit(127);
+            }
+        }
+    }
+    work_branchy(deadline, seed);
+    while (wait(NULL) > 0)
+        ;
+}
+
+static int worker_main(int argc, char **argv) {
+    // --worker KIND LIFE_MS P1 P2 SEED
+    if (argc != 7) {
+        fprintf(stderr, "Usage: %s %s KIND LIFE_MS P1 P2 SEED\n", argv[0], WORKER_FLAG);
+        return 2;
+    }
+    enum work_kind kind = kind_parse(argv[2]);
+    int life_ms = atoi(argv[3]);
+    int p1 = atoi(argv[4]);
+    int p2 = atoi(argv[5]);
+    uint64_t seed = strtoull(argv[6], NULL, 10);
+    uint64_t deadline = now_ns() + (uint64_t)life_ms * 1000000ULL;
+
+    switch (kind) {
+    case WORK_EXEC:
+        // 只做一次 execve 和少量工作，主要压测 exec 路径
+        if (life_ms > 0)
+            work_hog(deadline);
+        break;
+    case WORK_HOG:
+        work_hog(life_ms > 0 ? deadline : UINT64_MAX);
+        break;
+    case WORK_BRANCHY:
+        work_branchy(deadline, seed);
+        break;
+    case WORK_CACHE:
+        work_cache(deadline, seed, p1);
+        break;
+    case WORK_FORKTREE:
+        work_forktree(deadline, seed, life_ms, p1, p2);
+        break;
+    default:
+        fprintf(stderr, "Unknown worker kind: %s\n", argv[2]);
+        return 2;
+    }
+    return 0;
+}
+
+static int exec_worker(enum work_kind kind, int life_ms, int p1, int p2, uint64_t seed) {
+    char life[16], a[16], b[16], s[24];
+    snprintf(life, sizeof(life), "%d", life_ms);
+    snprintf(a, sizeof(a), "%d", p1);
+    snprintf(b, sizeof(b), "%d", p2);
+    snprintf(s, sizeof(s), "%" PRIu64, seed);
+    char *args[] = { "loadgen", WORKER_FLAG, (char *)kind_names[kind], life, a, b, s, NULL };
+    execv(self_exe, args);
+    return -1;
+}
+
+/* ---------------- 调度 ---------------- */
+
+static void worker_params(const struct workload *w, int *p1, int *p2) {
+    *p1 = w->kind == WORK_CACHE ? w->kb : w->depth;
+    *p2 = w->fanout;
+}
+
+static pid_t spawn(const struct workload *w, int life_ms, uint64_t seed) {
+    int p1, p2;
+    worker_params(w, &p1, &p2);
+    pid_t pid = fork();
+    if (pid == 0) {
+        exec_worker(w->kind, life_ms, p1, p2, seed);
+        _exit(127);
+    }
+    return pid;
+}
+
+// 解析 kind:key=value,...，例如 exec:rate=500,burst=20 或 cache:rate=5,life=200,kb=65536
+static int workload_parse(struct workload *w, const char *spec) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", spec);
+    char *params = strchr(buf, ':');
+    if (params)
+        *params++ = '\0';
+
+    memset(w, 0, sizeof(*w));
+    w->kind = kind_parse(buf);
+    if (w->kind == WORK_KIND_COUNT) {
+        fprintf(stderr, "Unknown workload kind: %s\n", buf);
+        return -1;
+    }
+    w->rate = 1;
+    w->burst = 1;
+    // exec 默认立即退出，hog 默认运行到结束
+    w->life_ms = w->kind == WORK_EXEC || w->kind == WORK_HOG ? 0 : 100;
+    w->kb = 32768;
+    w->depth = 3;
+    w->fanout = 2;
+
+    char *save = NULL;
+    for (char *kv = params ? strtok_r(params, ",", &save) : NULL; kv; kv = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(kv, '=');
+        if (!eq) {
+            fprintf(stderr, "Invalid workload parameter: %s\n", kv);
+            return -1;
+        }
+        *eq++ = '\0';
+        if (strcmp(kv, "rate") == 0 || strcmp(kv, "count") == 0)
+            w->rate = atof(eq);
+        else if (strcmp(kv, "burst") == 0)
+            w->burst = atoi(eq);
+        else if (strcmp(kv, "life") == 0)
+            w->life_ms = atoi(eq);
+        else if (strcmp(kv, "kb") == 0)
+            w->kb = atoi(eq);
+        else if (strcmp(kv, "depth") == 0)
+            w->depth = atoi(eq);
+        else if (strcmp(kv, "fanout") == 0)
+            w->fanout = atoi(eq);
+        else {
+            fprintf(stderr, "Unknown workload parameter: %s\n", kv);
+            return -1;
+        }
+    }
+    if (w->rate <= 0 || w->burst <= 0 || w->life_ms < 0 || w->kb <= 0 ||
+        w->depth < 0 || w->fanout <= 0) {
+        fprintf(stderr, "Invalid workload: %s\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+// 下一次启动的间隔：固定速率，或 -P 时为指数分布（泊松到达）
+static uint64_t next_interval(const struct workload *w, int poisson, uint64_t *rng) {
+    double mean = 1e9 * w->burst / w->rate;
+    if (!poisson)
+        return (uint64_t)mean;
+    double u = (double)(xorshift64(rng) >> 11) / (double)(1ULL << 53);
+    return (uint64_t)(-log(1.0 - u) * mean);
+}
+
+static void reap(void) {
+    while (waitpid(-1, NULL, WNOHANG) > 0)
+        ;
+}
+
+// 生成 collect_data/program/run_sample.sh 可直接执行的样本目录：DIR/1 .. DIR/N，
+// 每个样本按种子从各负载中选一种，exec 本程序的 worker 模式
+static int write_samples(const char *spec, const struct workload *workloads, int count, uint64_t seed) {
+    char dir[PATH_MAX];
+    char *colon = strrchr(spec, ':');
+    int n = colon ? atoi(colon + 1) : 0;
+    if (!colon || n <= 0 || (size_t)(colon - spec) >= sizeof(dir)) {
+        fprintf(stderr, "Invalid sample spec (expected DIR:N): %s\n", spec);
+        return -1;
+    }
+    snprintf(dir, sizeof(dir), "%.*s", (int)(colon - spec), spec);
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "mkdir %s failed: %s\n", dir, strerror(errno));
+        return -1;
+    }
+
+    uint64_t rng = seed | 1;
+    for (int i = 1; i <= n; i++) {
+        const struct workload *w = &workloads[xorshift64(&rng) % count];
+        int p1, p2;
+        worker_params(w, &p1, &p2);
+        // hog 样本也限定运行时间，避免样本在采集结束后残留
+        int life_ms = w->kind == WORK_HOG && w->life_ms == 0 ? 1000 : w->life_ms;
+
+        char path[PATH_MAX + 16];
+        snprintf(path, sizeof(path), "%s/%d", dir, i);
+        FILE *f = fopen(path, "w");
+        if (!f) {
+            fprintf(stderr, "Failed to create %s: %s\n", path, strerror(errno));
+            return -1;
+        }
+        fprintf(f, "#!/bin/sh\nexec %s %s %s %d %d %d %" PRIu64 "\n",
+                self_exe, WORKER_FLAG, kind_names[w->kind], life_ms, p1, p2, xorshift64(&rng));
+        fclose(f);
+        chmod(path, 0755);
+    }
+    printf("Wrote %d samples to %s\n", n, dir);
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [options] WORKLOAD...\n", prog);
+    printf("Workloads (kind:key=value,...):\n");
+    printf("  exec:rate=R[,burst=B][,life=MS]         R short-lived execs per second, B at a time\n");
+    printf("  hog:count=N[,life=MS]                   N resident CPU spinners (default: whole run)\n");
+    printf("  branchy:rate=R[,life=MS]                unpredictable-branch kernels\n");
+    printf("  cache:rate=R[,life=MS][,kb=KB]          random pointer chase over a KB working set\n");
+    printf("  forktree:rate=R[,life=MS][,depth=D][,fanout=F]  fork trees, every node execs\n");
+    printf("Options:\n");
+    printf("  -d SECONDS  Run time (default: 10)\n");
+    printf("  -s SEED     Random seed (default: 1)\n");
+    printf("  -P          Poisson arrivals instead of a fixed rate\n");
+    printf("  -o FILE     Log every spawn as '<offset ns> <pid> <kind>' (bench_replay -t format)\n");
+    printf("  -g DIR:N    Write N sample scripts for run_sample.sh instead of running\n");
+    printf("  -h          Show this help message\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], WORKER_FLAG) == 0) {
+        if (self_exe_init() != 0)
+            return 127;
+        return worker_main(argc, argv);
+    }
+
+    double duration_s = 10;
+    uint64_t seed = 1;
+    int poisson = 0;
+    const char *log_path = NULL;
+    const char *sample_spec = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:s:Po:g:h")) != -1) {
+        switch (opt) {
+        case 'd':
+            duration_s = atof(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'P':
+            poisson = 1;
+            break;
+        case 'o':
+            log_path = optarg;
+            break;
+        case 'g':
+            sample_spec = optarg;
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            return 0;
+        default:
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    struct workload workloads[MAX_WORKLOADS];
+    int count = 0;
+    for (int i = optind; i < argc; i++) {
+        if (count == MAX_WORKLOADS) {
+            fprintf(stderr, "Too many workloads (max %d)\n", MAX_WORKLOADS);
+            return 1;
+        }
+        if (workload_parse(&workloads[count++], argv[i]) != 0)
+            return 1;
+    }
+    if (count == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (self_exe_init() != 0) {
+        perror("readlink /proc/self/exe");
+        return 1;
+    }
+
+    if (sample_spec)
+        return write_samples(sample_spec, workloads, count, seed) == 0 ? 0 : 1;
+
+    FILE *log = NULL;
+    if (log_path) {
+        log = fopen(log_path, "w");
+        if (!log) {
+            fprintf(stderr, "Failed to open %s: %s\n", log_path, strerror(errno));
+            return 1;
+        }
+        fprintf(log, "# loadgen seed=%" PRIu64 "%s\n", seed, poisson ? " poisson" : "");
+    }
+
+    signal(SIGINT, sig_handler);
+    signal(SIGTERM, sig_handler);
+
+    uint64_t rng = seed | 1;
+    uint64_t spawn_seed = seed;
+    pid_t hogs[MAX_HOGS];
+    int hog_count = 0;
+    uint64_t start = now_ns();
+    uint64_t end = (uint64_t)(duration_s * 1e9);
+
+    for (int i = 0; i < count; i++) {
+        struct workload *w = &workloads[i];
+        if (w->kind != WORK_HOG) {
+            w->next_ns = next_interval(w, poisson, &rng) / 2;
+            continue;
+        }
+        // 常驻进程一开始就全部启动，运行到结束
+        for (int k = 0; k < (int)w->rate && hog_count < MAX_HOGS; k++) {
+            pid_t pid = spawn(w, w->life_ms, spawn_seed++);
+            if (pid < 0) {
+                w->failed++;
+                continue;
+            }
+            hogs[hog_count++] = pid;
+            w->spawned++;
+            if (log)
+                fprintf(log, "%" PRIu64 " %d %s\n", now_ns() - start, pid, kind_names[w->kind]);
+        }
+        w->next_ns = UINT64_MAX;
+    }
+
+    while (!exiting) {
+        uint64_t due = end;
+        for (int i = 0; i < count; i++) {
+            if (workloads[i].next_ns < due)
+                due = workloads[i].next_ns;
+        }
+        if (due >= end)
+            break;
+
+        // 按绝对时间等待，避免启动耗时累积成速率漂移
+        uint64_t abs_due = start + due;
+        struct timespec ts = { .tv_sec = abs_due / 1000000000ULL, .tv_nsec = abs_due % 1000000000ULL };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+        uint64_t now = now_ns() - start;
+        for (int i = 0; i < count; i++) {
+            struct workload *w = &workloads[i];
+            while (w->next_ns <= now) {
+                for (int b = 0; b < w->burst; b++) {
+                    pid_t pid = spawn(w, w->life_ms, spawn_seed++);
+                    if (pid < 0) {
+                        w->failed++;
+                        continue;
+                    }
+                    w->spawned++;
+                    if (log)
+                        fprintf(log, "%" PRIu64 " %d %s\n", now_ns() - start, pid, kind_names[w->kind]);
+                }
+                w->next_ns += next_interval(w, poisson, &rng);
+            }
+        }
+        reap();
+    }
+
+    for (int i = 0; i < hog_count; i++)
+        kill(hogs[i], SIGTERM);
+    while (wait(NULL) > 0 || errno == EINTR)
+        ;
+    double elapsed = (now_ns() - start) / 1e9;
+
+    printf("%-10s %10s %10s %12s\n", "workload", "spawned", "failed", "rate/s");
+    for (int i = 0; i < count; i++) {
+        const struct workload *w = &workloads[i];
+        printf("%-10s %10" PRIu64 " %10" PRIu64 " %12.1f\n", kind_names[w->kind],
+               w->spawned, w->failed, w->kind == WORK_HOG ? 0 : w->spawned / elapsed);
+    }
+    printf("Elapsed: %.2fs, seed %" PRIu64 "\n", elapsed, seed);
+    if (log)
+        fclose(log);
+    return 0;
+}
@@ -0,0 +1,226 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+#include "logger.h"
+#include "selfprof.h"
+
+#define LOG_BATCH 64
+
+struct log_record {
+    atomic_size_t seq;
+    int level;
+    int len;
+    struct timespec ts;
+    char text[LOG_TEXT_SIZE];
+};
+
+int log_level = LOG_INFO;
+
+static struct log_record queue[LOG_QUEUE_SIZE];
+static atomic_size_t enqueue_pos;
+static size_t dequeue_pos;
+static atomic_ullong dropped;
+static atomic_int running;
+static int out_fd = STDOUT_FILENO;
+static pthread_t writer_tid;
+static atomic_int started;
+// 日志线程空闲时阻塞在 eventfd 上；idle 为 1 时第一个入队的生产者负责唤醒
+static int wake_fd = -1;
+static atomic_int idle;
+// 正在 log_write 中的生产者。logger_stop 等它归零后才停止日志线程并关闭 wake_fd
+static atomic_int producers;
+
+static const char *level_names[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+// 队列满时丢弃并计数，生产者永不阻塞
+static void enqueue(int level, const char *fmt, va_list ap) {
+    struct log_record *rec;
+    size_t pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        rec = &queue[pos & (LOG_QUEUE_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    rec->level = level;
+    clock_gettime(CLOCK_REALTIME, &rec->ts);
+    int len = vsnprintf(rec->text, sizeof(rec->text), fmt, ap);
+    if (len < 0)
+        len = 0;
+    if (len >= (int)sizeof(rec->text))
+        len = sizeof(rec->text) - 1;
+    rec->len = len;
+
+    atomic_store_explicit(&rec->seq, pos + 1, memory_order_release);
+
+    // 与日志线程"置 idle 后再检查队列"配对：发布记录与检查 idle 之间需要全序
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&idle, memory_order_relaxed) &&
+        atomic_exchange_explicit(&idle, 0, memory_order_relaxed)) {
+        uint64_t one = 1;
+        if (write(wake_fd, &one, sizeof(one)) < 0) {
+            // 计数器溢出之外不会失败，日志线程已有待处理的唤醒
+        }
+    }
+}
+
+void log_write(int level, const char *fmt, ...) {
+    va_list ap;
+
+    // 先登记再检查 started，与 logger_stop "先清 started 再等 producers 归零"配对（均为 seq_cst）
+    atomic_fetch_add(&producers, 1);
+    if (!atomic_load(&started)) {
+        atomic_fetch_sub(&producers, 1);
+        // 日志线程未启动（启动前或已停止）时直接写 stderr
+        va_start(ap, fmt);
+        vfprintf(stderr, fmt, ap);
+        va_end(ap);
+        return;
+    }
+    va_start(ap, fmt);
+    enqueue(level, fmt, ap);
+    va_end(ap);
+    atomic_fetch_sub_explicit(&producers, 1, memory_order_release);
+}
+
+// 队列头部是否有已发布的记录
+static int queue_ready(void) {
+    struct log_record *rec = &queue[dequeue_pos & (LOG_QUEUE_SIZE - 1)];
+    size_t seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)(dequeue_pos + 1) >= 0;
+}
+
+// 取出最多 LOG_BATCH 条记录，一次 writev 写出
+static int flush_batch(void) {
+    struct iovec iov[LOG_BATCH * 2];
+    char prefixes[LOG_BATCH][48];
+    struct log_record *recs[LOG_BATCH];
+    int count = 0;
+
+    while (count < LOG_BATCH) {
+        struct log_record *rec = &queue[dequeue_pos & (LOG_QUEUE_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(dequeue_pos + 1) < 0)
+            break;
+
+        struct tm tm;
+        localtime_r(&rec->ts.tv_sec, &tm);
+        int plen = strftime(prefixes[count], sizeof(prefixes[count]), "%H:%M:%S", &tm);
+        plen += snprintf(prefixes[count] + plen, sizeof(prefixes[count]) - plen, ".%03ld %-5s ",
+                         rec->ts.tv_nsec / 1000000, level_names[rec->level]);
+        iov[count * 2].iov_base = prefixes[count];
+        iov[count * 2].iov_len = plen;
+        iov[count * 2 + 1].iov_base = rec->text;
+        iov[count * 2 + 1].iov_len = rec->len;
+        recs[count++] = rec;
+        dequeue_pos++;
+    }
+
+    if (count > 0) {
+        if (writev(out_fd, iov, count * 2) < 0) {
+            // 输出失败时无处报告，丢弃本批
+        }
+        // 写完后才归还槽位，iov 仍引用记录内容
+        for (int i = 0; i < count; i++) {
+            size_t slot_pos = dequeue_pos - count + i;
+            atomic_store_explicit(&recs[i]->seq, slot_pos + LOG_QUEUE_SIZE, memory_order_release);
+        }
+    }
+    return count;
+}
+
+static void *writer_thread(void *arg) {
+    (void)arg;
+    selfprof_thread_begin(PROF_OUTPUT);
+    while (atomic_load(&running)) {
+        if (flush_batch() > 0)
+            continue;
+        // 先声明空闲再检查一次队列，避免在两步之间入队的记录无人唤醒
+        atomic_store(&idle, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (queue_ready() || !atomic_load(&running)) {
+            atomic_store(&idle, 0);
+            continue;
+        }
+        uint64_t count;
+        if (read(wake_fd, &count, sizeof(count)) < 0) {
+            // 被信号打断时重新检查
+        }
+        atomic_store(&idle, 0);
+    }
+    while (flush_batch() > 0)
+        ;
+    selfprof_thread_end();
+    return NULL;
+}
+
+int logger_start(int level, int fd) {
+    for (size_t i = 0; i < LOG_QUEUE_SIZE; i++)
+        atomic_init(&queue[i].seq, i);
+    atomic_init(&enqueue_pos, 0);
+    dequeue_pos = 0;
+    log_level = level;
+    out_fd = fd;
+    wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        perror("eventfd logger");
+        return -1;
+    }
+    atomic_store(&idle, 0);
+    atomic_store(&running, 1);
+
+    if (pthread_create(&writer_tid, NULL, writer_thread, NULL) != 0) {
+        perror("pthread_create logger");
+        close(wake_fd);
+        wake_fd = -1;
+        return -1;
+    }
+    atomic_store_explicit(&started, 1, memory_order_release);
+    return 0;
+}
+
+void logger_stop(void) {
+    if (!atomic_load(&started))
+        return;
+    // 先停止接收新记录，等已进入的生产者发布完，再让日志线程排空队列。
+    // 生产者不阻塞，等待很短
+    atomic_store(&started, 0);
+    while (atomic_load(&producers) > 0)
+        sched_yield();
+    atomic_store(&running, 0);
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0) {
+        // 同上
+    }
+    pthread_join(writer_tid, NULL);
+    close(wake_fd);
+    wake_fd = -1;
+
+    unsigned long long n = atomic_load(&dropped);
+    if (n)
+        fprintf(stderr, "logger dropped %llu records\n", n);
+}
+
+unsigned long long logger_dropped(void) {
+    return atomic_load(&dropped);
+}
@@ -0,0 +1,32 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// 异步日志：生产者把正文格式化进定长记录并压入无锁 MPSC 队列（参数可能指向调用者的
+// 临时缓冲区，不能延后到后台线程格式化），后台线程加时间和级别前缀，用 writev 批量写出；
+// 队列空闲时后台线程阻塞在 eventfd 上。低于当前级别的日志在调用点直接跳过，不做任何格式化
+
+enum log_level {
+    LOG_DEBUG = 0,
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR,
+};
+
+#define LOG_QUEUE_SIZE 1024     // 必须是 2 的幂
+#define LOG_TEXT_SIZE 1008
+
+extern int log_level;
+
+int logger_start(int level, int fd);
+void logger_stop(void);
+unsigned long long logger_dropped(void);
+
+void log_write(int level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+#define log_msg(level, ...)                 \
+    do {                                    \
+        if ((level) >= log_level)           \
+            log_write((level), __VA_ARGS__); \
+    } while (0)
+
+#endif
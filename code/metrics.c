@@ -0,0 +1,325 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "metrics.h"
+#include "latency.h"
+#include "logger.h"
+#include "selfprof.h"
+
+#define MAX_ERRNO 134
+#define METRICS_BUF_SIZE 32768
+#define MAX_LOST_CPUS 1024
+
+struct metric_cell metric_values[METRIC_COUNT];
+static _Atomic uint64_t perf_open_errors[MAX_ERRNO + 1];
+static _Atomic uint64_t perf_lost[MAX_LOST_CPUS];
+
+static const struct {
+    const char *name;
+    const char *help;
+    int gauge;
+} metric_info[METRIC_COUNT] = {
+    [METRIC_EXECS] = { "kleb_execs_total", "execve events received from BPF", 0 },
+    [METRIC_EXECS_DEDUPED] = { "kleb_execs_deduped_total", "execve events skipped as recently seen", 0 },
+    [METRIC_EXECS_DROPPED] = { "kleb_execs_dropped_total", "execve events not collected due to resource limits", 0 },
+    [METRIC_EXECS_RECOVERED] = { "kleb_execs_recovered_total", "processes recovered by /proc scan after lost events", 0 },
+    [METRIC_PERF_BUFFER_PAGES] = { "kleb_perf_buffer_pages", "exec perf buffer pages per CPU", 1 },
+    [METRIC_COLLECTORS_ACTIVE] = { "kleb_collectors_active", "running collector threads", 1 },
+    [METRIC_PERF_FDS_OPEN] = { "kleb_perf_fds_open", "open perf event file descriptors", 1 },
+    [METRIC_WINDOWS_SENT] = { "kleb_windows_sent_total", "counter windows written to pipes", 0 },
+    [METRIC_WINDOWS_RECEIVED] = { "kleb_windows_received_total", "counter windows read by the inference thread", 0 },
+    [METRIC_WINDOWS_DROPPED] = { "kleb_windows_dropped_total", "counter windows lost on write or rejected on parse", 0 },
+    [METRIC_INFERENCES] = { "kleb_inferences_total", "model inferences", 0 },
+    [METRIC_VERDICTS_MALICIOUS] = { "kleb_verdicts_malicious_total", "malicious verdicts", 0 },
+    [METRIC_VERDICTS_DROPPED] = { "kleb_verdicts_dropped_total", "verdict records dropped for slow subscribers", 0 },
+    [METRIC_CONTAINED] = { "kleb_contained_total", "targets contained by the response stage", 0 },
+    [METRIC_CONTAIN_REQUESTED] = { "kleb_contain_requested_total", "PIDs queued for a BPF signal by the response stage", 0 },
+};
+
+static int listen_fd = -1;
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static atomic_int running;
+static pthread_t metrics_tid;
+
+void metrics_perf_lost(int cpu, uint64_t count) {
+    if (cpu < 0 || cpu >= MAX_LOST_CPUS)
+        cpu = MAX_LOST_CPUS - 1;
+    atomic_fetch_add_explicit(&perf_lost[cpu], count, memory_order_relaxed);
+}
+
+void metrics_perf_open_failed(int err) {
+    if (err < 0 || err > MAX_ERRNO)
+        err = 0;
+    atomic_fetch_add_explicit(&perf_open_errors[err], 1, memory_order_relaxed);
+}
+
+struct out_buf {
+    char *data;
+    size_t len;
+};
+
+__attribute__((format(printf, 2, 3)))
+static void out_printf(struct out_buf *out, const char *fmt, ...) {
+    if (out->len >= METRICS_BUF_SIZE)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(out->data + out->len, METRICS_BUF_SIZE - out->len, fmt, ap);
+    va_end(ap);
+    if (n > 0)
+        out->len += n;
+    if (out->len > METRICS_BUF_SIZE)
+        out->len = METRICS_BUF_SIZE;
+}
+
+// 与 collect_data/program/perf_monitor.c 相同：CPU 取 /proc/self/stat 的 utime+stime，
+// 内存取 /proc/self/status 的 VmRSS/VmSize
+static void format_process(struct out_buf *out) {
+    char line[1024];
+    FILE *file = fopen("/proc/self/stat", "r");
+    if (file) {
+        if (fgets(line, sizeof(line), file)) {
+            // comm 可能包含空格，从最后一个 ')' 之后开始数字段（state 为第 3 个字段）
+            char *p = strrchr(line, ')');
+            unsigned long utime = 0, stime = 0;
+            if (p && sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                            &utime, &stime) == 2) {
+                out_printf(out, "# HELP process_cpu_seconds_total user and system CPU time\n"
+                                "# TYPE process_cpu_seconds_total counter\n"
+                                "process_cpu_seconds_total %.2f\n",
+                           (double)(utime + stime) / sysconf(_SC_CLK_TCK));
+            }
+        }
+        fclose(file);
+    }
+
+    file = fopen("/proc/self/status", "r");
+    if (file) {
+        unsigned long vm_rss = 0, vm_size = 0;
+        while (fgets(line, sizeof(line), file)) {
+            if (strncmp(line, "VmRSS:", 6) == 0)
+                sscanf(line + 6, "%lu", &vm_rss);
+            else if (strncmp(line, "VmSize:", 7) == 0)
+                sscanf(line + 7, "%lu", &vm_size);
+        }
+        fclose(file);
+        out_printf(out, "# HELP process_resident_memory_bytes resident set size\n"
+                        "# TYPE process_resident_memory_bytes gauge\n"
+                        "process_resident_memory_bytes %lu\n"
+                        "# HELP process_virtual_memory_bytes virtual memory size\n"
+                        "# TYPE process_virtual_memory_bytes gauge\n"
+                        "process_virtual_memory_bytes %lu\n",
+                   vm_rss * 1024, vm_size * 1024);
+    }
+}
+
+static void format_metrics(struct out_buf *out) {
+    int64_t values[METRIC_COUNT];
+    for (int m = 0; m < METRIC_COUNT; m++) {
+        values[m] = atomic_load_explicit(&metric_values[m].value, memory_order_relaxed);
+        out_printf(out, "# HELP %s %s\n# TYPE %s %s\n%s %" PRId64 "\n",
+                   metric_info[m].name, metric_info[m].help, metric_info[m].name,
+                   metric_info[m].gauge ? "gauge" : "counter", metric_info[m].name, values[m]);
+    }
+
+    // 管道中尚未被推理线程读出的窗口
+    int64_t backlog = values[METRIC_WINDOWS_SENT] - values[METRIC_WINDOWS_RECEIVED];
+    out_printf(out, "# HELP kleb_pipe_backlog_windows windows written but not yet read\n"
+                    "# TYPE kleb_pipe_backlog_windows gauge\n"
+                    "kleb_pipe_backlog_windows %" PRId64 "\n", backlog > 0 ? backlog : 0);
+
+    out_printf(out, "# HELP kleb_log_dropped_total log records dropped on a full queue\n"
+                    "# TYPE kleb_log_dropped_total counter\n"
+                    "kleb_log_dropped_total %llu\n", logger_dropped());
+
+    out_printf(out, "# HELP kleb_perf_buffer_lost_total exec events lost on perf buffer overflow\n"
+                    "# TYPE kleb_perf_buffer_lost_total counter\n");
+    for (int c = 0; c < MAX_LOST_CPUS; c++) {
+        uint64_t count = atomic_load_explicit(&perf_lost[c], memory_order_relaxed);
+        if (count)
+            out_printf(out, "kleb_perf_buffer_lost_total{cpu=\"%d\"} %" PRIu64 "\n", c, count);
+    }
+
+    out_printf(out, "# HELP kleb_perf_open_failures_total perf_event_open failures by errno\n"
+                    "# TYPE kleb_perf_open_failures_total counter\n");
+    for (int e = 0; e <= MAX_ERRNO; e++) {
+        uint64_t count = atomic_load_explicit(&perf_open_errors[e], memory_order_relaxed);
+        if (count) {
+            const char *name = e ? strerrorname_np(e) : NULL;
+            out_printf(out, "kleb_perf_open_failures_total{errno=\"%s\"} %" PRIu64 "\n",
+                       name ? name : "unknown", count);
+        }
+    }
+
+    out_printf(out, "# HELP kleb_stage_latency_seconds pipeline stage latency\n"
+                    "# TYPE kleb_stage_latency_seconds summary\n");
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        const char *stage = latency_stage_name(s);
+        for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+            out_printf(out, "kleb_stage_latency_seconds{stage=\"%s\",quantile=\"%g\"} %.9f\n",
+                       stage, quantiles[q], latency_percentile(s, quantiles[q]) / 1e9);
+        }
+        out_printf(out, "kleb_stage_latency_seconds_sum{stage=\"%s\"} %.9f\n"
+                        "kleb_stage_latency_seconds_count{stage=\"%s\"} %" PRIu64 "\n",
+                   stage, latency_sum(s) / 1e9, stage, latency_count(s));
+    }
+
+    if (selfprof_enabled()) {
+        out_printf(out, "# HELP kleb_cpu_seconds_total daemon CPU time by pipeline stage\n"
+                        "# TYPE kleb_cpu_seconds_total counter\n");
+        for (int r = 0; r < PROF_ROLE_COUNT; r++)
+            out_printf(out, "kleb_cpu_seconds_total{stage=\"%s\"} %.6f\n",
+                       selfprof_role_name(r), selfprof_cpu_ns(r) / 1e9);
+    }
+
+    format_process(out);
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void serve_client(int fd, char *buffer) {
+    // 客户端在 100ms 内发来 GET 请求时按 HTTP 响应，否则直接输出文本
+    char request[1024];
+    ssize_t req_len = 0;
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    if (poll(&pfd, 1, 100) > 0)
+        req_len = recv(fd, request, sizeof(request) - 1, 0);
+    int http = req_len >= 4 && strncmp(request, "GET ", 4) == 0;
+
+    struct out_buf out = { buffer, 0 };
+    format_metrics(&out);
+
+    if (http) {
+        char header[128];
+        int n = snprintf(header, sizeof(header),
+                         "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: %zu\r\n\r\n", out.len);
+        if (write_all(fd, header, n) != 0)
+            return;
+    }
+    write_all(fd, out.data, out.len);
+}
+
+static void *metrics_thread(void *arg) {
+    char *buffer = malloc(METRICS_BUF_SIZE);
+    if (!buffer) {
+        log_msg(LOG_ERROR, "malloc metrics buffer: %s\n", strerror(errno));
+        return NULL;
+    }
+    selfprof_thread_begin(PROF_OTHER);
+    while (atomic_load(&running)) {
+        struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+        if (poll(&pfd, 1, 200) <= 0)
+            continue;
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd == -1)
+            continue;
+        serve_client(fd, buffer);
+        close(fd);
+    }
+    free(buffer);
+    selfprof_thread_end();
+    return NULL;
+}
+
+static int listen_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror("socket");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, 8) == -1) {
+        fprintf(stderr, "Failed to listen on 127.0.0.1:%d: %s\n", port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Metrics socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, 8) == -1) {
+        fprintf(stderr, "Failed to listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    strcpy(socket_path, path);
+    return fd;
+}
+
+int metrics_start(const char *addr) {
+    if (addr[0] == ':') {
+        int port = atoi(addr + 1);
+        if (port <= 0 || port > 65535) {
+            fprintf(stderr, "Invalid metrics port: %s\n", addr);
+            return -1;
+        }
+        listen_fd = listen_tcp(port);
+    } else {
+        listen_fd = listen_unix(addr);
+    }
+    if (listen_fd == -1)
+        return -1;
+
+    atomic_store(&running, 1);
+    if (pthread_create(&metrics_tid, NULL, metrics_thread, NULL) != 0) {
+        perror("pthread_create");
+        atomic_store(&running, 0);
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void metrics_stop(void) {
+    if (!atomic_exchange(&running, 0))
+        return;
+    pthread_join(metrics_tid, NULL);
+    close(listen_fd);
+    listen_fd = -1;
+    if (socket_path[0])
+        unlink(socket_path);
+}
@@ -0,0 +1,54 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// 守护进程内部指标。热路径只做 relaxed 原子加，抓取线程只读，互不加锁
+
+enum metric {
+    METRIC_EXECS = 0,           // 收到的 execve 事件
+    METRIC_EXECS_DEDUPED,       // 被 is_pid_recent 去重的事件
+    METRIC_EXECS_DROPPED,       // 因 PID 上限、管道或线程创建失败而未采集的事件
+    METRIC_EXECS_RECOVERED,     // perf buffer 丢事件后通过扫描 /proc 补回的进程
+    METRIC_PERF_BUFFER_PAGES,   // perf buffer 每 CPU 页数（gauge）
+    METRIC_COLLECTORS_ACTIVE,   // 运行中的采集线程（gauge）
+    METRIC_PERF_FDS_OPEN,       // 打开的 perf 事件 fd（gauge）
+    METRIC_WINDOWS_SENT,        // 写入管道的窗口
+    METRIC_WINDOWS_RECEIVED,    // 接收线程读出的窗口
+    METRIC_WINDOWS_DROPPED,     // 写管道失败或解析失败的窗口
+    METRIC_INFERENCES,
+    METRIC_VERDICTS_MALICIOUS,
+    METRIC_VERDICTS_DROPPED,    // 结果流慢订阅者丢弃的记录
+    METRIC_CONTAINED,           // 已处置的目标
+    METRIC_CONTAIN_REQUESTED,   // 已写入 BPF signal_pids、等待 BPF 发信号的进程
+    METRIC_COUNT
+};
+
+struct metric_cell {
+    _Atomic int64_t value;
+    char pad[64 - sizeof(int64_t)];     // 各计数器独占缓存行，避免伪共享
+};
+
+extern struct metric_cell metric_values[METRIC_COUNT];
+
+static inline void metrics_add(enum metric m, int64_t delta) {
+    atomic_fetch_add_explicit(&metric_values[m].value, delta, memory_order_relaxed);
+}
+
+static inline void metrics_set(enum metric m, int64_t value) {
+    atomic_store_explicit(&metric_values[m].value, value, memory_order_relaxed);
+}
+
+// 按 CPU 统计 perf buffer 丢失的事件
+void metrics_perf_lost(int cpu, uint64_t count);
+
+// 按 errno 统计 perf_event_open 失败
+void metrics_perf_open_failed(int err);
+
+// addr 为 Unix 套接字路径，或 ":PORT" 表示监听 127.0.0.1:PORT。
+// 连接后发送 GET 请求得到 HTTP 响应，否则直接得到文本格式指标
+int metrics_start(const char *addr);
+void metrics_stop(void);
+
+#endif
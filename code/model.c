@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+#include "model.h"
+
+// 批量推理每块的样本数：块内隐藏层激活（8 x 128 x 4 字节）留在 L1
+#define BATCH_TILE 8
+
+static void transpose(const float *matrix, float *out, int rows, int cols) {
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            out[j * rows + i] = matrix[i * cols + j];
+}
+
+// ReLU激活函数
+static float relu(float x) {
+    return x > 0 ? x : 0;
+}
+
+// 矩阵-向量乘法
+void kleb_matmul(const float* matrix, const float* vector, float* result, int rows, int cols) {
+    for (int i = 0; i < rows; i++) {
+        result[i] = 0;
+        for (int j = 0; j < cols; j++) {
+            result[i] += matrix[i * cols + j] * vector[j];
+        }
+    }
+}
+
+// 加载模型权重
+int kleb_load_weights(struct model *model, const char* filepath) {
+    FILE* file = fopen(filepath, "rb");
+    if (!file) {
+        fprintf(stderr, "无法打开权重文件: %s\n", filepath);
+        return -1;
+    }
+
+    size_t read_count = 0;
+    read_count += fread(model->fc1_weight, sizeof(float), INPUT_DIM * HIDDEN1_DIM, file);
+    read_count += fread(model->fc1_bias, sizeof(float), HIDDEN1_DIM, file);
+    read_count += fread(model->fc2_weight, sizeof(float), HIDDEN1_DIM * HIDDEN2_DIM, file);
+    read_count += fread(model->fc2_bias, sizeof(float), HIDDEN2_DIM, file);
+    read_count += fread(model->fc3_weight, sizeof(float), HIDDEN2_DIM * OUTPUT_DIM, file);
+    read_count += fread(model->fc3_bias, sizeof(float), OUTPUT_DIM, file);
+
+    fclose(file);
+    if (read_count != INPUT_DIM * HIDDEN1_DIM + HIDDEN1_DIM + 
+                     HIDDEN1_DIM * HIDDEN2_DIM + HIDDEN2_DIM + 
+                     HIDDEN2_DIM * OUTPUT_DIM + OUTPUT_DIM) {
+        fprintf(stderr, "权重文件读取失败: %s\n", filepath);
+        return -1;
+    }
+    transpose(model->fc1_weight, model->fc1_weight_t, HIDDEN1_DIM, INPUT_DIM);
+    transpose(model->fc2_weight, model->fc2_weight_t, HIDDEN2_DIM, HIDDEN1_DIM);
+    transpose(model->fc3_weight, model->fc3_weight_t, OUTPUT_DIM, HIDDEN2_DIM);
+    return 0;
+}
+
+// 前向传播
+void kleb_forward(const struct model *model, const float* input, float* output) {
+    float hidden1[HIDDEN1_DIM];
+    float hidden2[HIDDEN2_DIM];
+
+    kleb_matmul(model->fc1_weight, input, hidden1, HIDDEN1_DIM, INPUT_DIM);
+    for (int i = 0; i < HIDDEN1_DIM; i++) {
+        hidden1[i] = relu(hidden1[i] + model->fc1_bias[i]);
+    }
+
+    kleb_matmul(model->fc2_weight, hidden1, hidden2, HIDDEN2_DIM, HIDDEN1_DIM);
+    for (int i = 0; i < HIDDEN2_DIM; i++) {
+        hidden2[i] = relu(hidden2[i] + model->fc2_bias[i]);
+    }
+
+    kleb_matmul(model->fc3_weight, hidden2, output, OUTPUT_DIM, HIDDEN2_DIM);
+    for (int i = 0; i < OUTPUT_DIM; i++) {
+        output[i] += model->fc3_bias[i];
+    }
+}
+
+// 一层全连接：out[b] = bias + W x[b]，按输入维度外层循环，
+// 每个输入分量对应的一行转置权重在块内所有样本间复用，最内层沿输出维度连续访问
+static void dense_tile(const float *restrict weight_t, const float *restrict bias,
+                       const float *restrict in, float *restrict out,
+                       int n, int rows, int cols, int relu_out) {
+    for (int b = 0; b < n; b++)
+        memcpy(out + b * rows, bias, rows * sizeof(float));
+    for (int j = 0; j < cols; j++) {
+        const float *w = weight_t + j * rows;
+        for (int b = 0; b < n; b++) {
+            float x = in[b * cols + j];
+            float *o = out + b * rows;
+            for (int i = 0; i < rows; i++)
+                o[i] += w[i] * x;
+        }
+    }
+    if (relu_out) {
+        for (int k = 0; k < n * rows; k++)
+            out[k] = out[k] > 0 ? out[k] : 0;
+    }
+}
+
+void kleb_forward_batch(const struct model *model, const float *inputs, float *outputs, int batch) {
+    float hidden1[BATCH_TILE * HIDDEN1_DIM];
+    float hidden2[BATCH_TILE * HIDDEN2_DIM];
+
+    for (int start = 0; start < batch; start += BATCH_TILE) {
+        int n = batch - start < BATCH_TILE ? batch - start : BATCH_TILE;
+        dense_tile(model->fc1_weight_t, model->fc1_bias, inputs + start * INPUT_DIM, hidden1,
+                   n, HIDDEN1_DIM, INPUT_DIM, 1);
+        dense_tile(model->fc2_weight_t, model->fc2_bias, hidden1, hidden2, n, HIDDEN2_DIM, HIDDEN1_DIM, 1);
+        dense_tile(model->fc3_weight_t, model->fc3_bias, hidden2, outputs + start * OUTPUT_DIM,
+                   n, OUTPUT_DIM, HIDDEN2_DIM, 0);
+    }
+}
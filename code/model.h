@@ -0,0 +1,48 @@
+#ifndef MODEL_H
+#define MODEL_H
+
+// DQN 推理网络 40 -> 128 -> 64 -> 2（全连接 + ReLU），权重由 judge/train.py 导出
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define INPUT_DIM 40
+#define HIDDEN1_DIM 128
+#define HIDDEN2_DIM 64
+#define OUTPUT_DIM 2
+
+// 每次推理的浮点运算数（乘加各计一次）
+#define FORWARD_FLOPS (2 * (INPUT_DIM * HIDDEN1_DIM + HIDDEN1_DIM * HIDDEN2_DIM + HIDDEN2_DIM * OUTPUT_DIM))
+
+// 模型权重和偏置，另存一份转置权重（cols x rows）供 kleb_forward_batch 使用。
+// 加载后只读，可被多个线程同时用于推理
+struct model {
+    float fc1_weight[INPUT_DIM * HIDDEN1_DIM];
+    float fc1_bias[HIDDEN1_DIM];
+    float fc2_weight[HIDDEN1_DIM * HIDDEN2_DIM];
+    float fc2_bias[HIDDEN2_DIM];
+    float fc3_weight[HIDDEN2_DIM * OUTPUT_DIM];
+    float fc3_bias[OUTPUT_DIM];
+    float fc1_weight_t[INPUT_DIM * HIDDEN1_DIM];
+    float fc2_weight_t[HIDDEN1_DIM * HIDDEN2_DIM];
+    float fc3_weight_t[HIDDEN2_DIM * OUTPUT_DIM];
+};
+
+int kleb_load_weights(struct model *model, const char *filepath);
+
+// 矩阵-向量乘法，matrix 按行存储（rows x cols）
+void kleb_matmul(const float *matrix, const float *vector, float *result, int rows, int cols);
+
+// 单个样本前向传播
+void kleb_forward(const struct model *model, const float *input, float *output);
+
+// 批量前向传播：inputs 为 batch x INPUT_DIM，outputs 为 batch x OUTPUT_DIM。
+// 使用转置后的权重，按小批量分块，每行权重在块内所有样本间复用，内层循环可向量化
+void kleb_forward_batch(const struct model *model, const float *inputs, float *outputs, int batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
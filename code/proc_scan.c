@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <ctype.h>
+#include <time.h>
+#include "proc_scan.h"
+
+uint64_t boottime_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// /proc/<pid>/stat 第 22 个字段 starttime（开机以来的时钟滴答数）
+static int read_start_ticks(const char *pid_str, unsigned long long *ticks) {
+    char path[64], line[1024];
+    snprintf(path, sizeof(path), "/proc/%s/stat", pid_str);
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return -1;
+    char *ok = fgets(line, sizeof(line), file);
+    fclose(file);
+    if (!ok)
+        return -1;
+
+    // comm 可能包含空格和括号，从最后一个 ')' 之后开始数字段
+    char *p = strrchr(line, ')');
+    if (!p)
+        return -1;
+    if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+               ticks) != 1)
+        return -1;
+    return 0;
+}
+
+int proc_scan_recent(uint64_t since_boot_ns, void (*fn)(uint32_t pid, void *ctx), void *ctx) {
+    DIR *dir = opendir("/proc");
+    if (!dir) {
+        perror("opendir /proc");
+        return -1;
+    }
+
+    long hz = sysconf(_SC_CLK_TCK);
+    // 启动时间精度只有一个时钟滴答，向前放宽一个滴答
+    unsigned long long since_ticks = since_boot_ns / (1000000000ull / hz);
+    if (since_ticks > 0)
+        since_ticks--;
+    uint32_t self = getpid();
+    int found = 0;
+
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        if (!isdigit((unsigned char)de->d_name[0]))
+            continue;
+        uint32_t pid = strtoul(de->d_name, NULL, 10);
+        if (pid == self)
+            continue;
+        unsigned long long ticks;
+        if (read_start_ticks(de->d_name, &ticks) != 0 || ticks < since_ticks)
+            continue;
+        fn(pid, ctx);
+        found++;
+    }
+    closedir(dir);
+    return found;
+}
@@ -0,0 +1,12 @@
+#ifndef PROC_SCAN_H
+#define PROC_SCAN_H
+
+#include <stdint.h>
+
+// 扫描 /proc，对启动时间不早于 since_boot_ns（CLOCK_BOOTTIME 纳秒）的进程调用 fn。
+// 用于 perf buffer 丢失 execve 事件后补回漏掉的进程，返回找到的进程数
+int proc_scan_recent(uint64_t since_boot_ns, void (*fn)(uint32_t pid, void *ctx), void *ctx);
+
+uint64_t boottime_now(void);
+
+#endif
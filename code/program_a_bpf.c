@@ -4,6 +4,7 @@
 #include <bpf/bpf_helpers.h>
 #include <bpf/bpf_tracing.h>
 #include <bpf/bpf_core_read.h>
+#include "exec_event.h"
 
 // 定义 map：用于发送事件到用户空间
 struct {
@@ -13,14 +14,39 @@ struct {
     __type(value, u32);
 } events SEC(".maps");
 
+// 待处置进程：PID -> 信号，由用户态响应阶段写入
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, 1024);
+    __type(key, u32);
+    __type(value, u32);
+} signal_pids SEC(".maps");
+
 // 跟踪 execve 系统调用
 SEC("tracepoint/syscalls/sys_enter_execve")
 int trace_execve(struct trace_event_raw_sys_enter *ctx) {
-    u32 pid = bpf_get_current_pid_tgid() >> 32;  // 获取当前进程的 PID
+    struct exec_event event = {
+        .pid = bpf_get_current_pid_tgid() >> 32,  // 获取当前进程的 PID
+        .exec_ns = bpf_ktime_get_ns(),            // 端到端延迟统计的起点
+    };
 
     // 向 perf event 输出事件
-    bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, &pid, sizeof(pid));
+    bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, &event, sizeof(event));
+
+    return 0;
+}
+
+// 目标进程下一次进入系统调用时在其上下文中发送信号，
+// 不依赖用户态 kill() 的调度时机
+SEC("tracepoint/raw_syscalls/sys_enter")
+int enforce_signal(struct trace_event_raw_sys_enter *ctx) {
+    u32 pid = bpf_get_current_pid_tgid() >> 32;
+    u32 *sig = bpf_map_lookup_elem(&signal_pids, &pid);
+    if (!sig)
+        return 0;
 
+    if (bpf_send_signal(*sig) == 0)
+        bpf_map_delete_elem(&signal_pids, &pid);
     return 0;
 }
 
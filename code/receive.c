@@ -8,320 +8,174 @@
 #include <inttypes.h>
 #include <time.h>
 #include <math.h>
-#include "collect.h"
+#include <errno.h>
+#include <limits.h>
+#include "receive.h"
 #include "common.h"
-
-#define INPUT_DIM 40
-#define HIDDEN1_DIM 128
-#define HIDDEN2_DIM 64
-#define OUTPUT_DIM 2
-#define ROWS_PER_INFERENCE 10
-#define COLS_PER_ROW 4
-#define MAX_ROWS 90
-
-// 模型权重和偏置
-float fc1_weight[INPUT_DIM * HIDDEN1_DIM];
-float fc1_bias[HIDDEN1_DIM];
-float fc2_weight[HIDDEN1_DIM * HIDDEN2_DIM];
-float fc2_bias[HIDDEN2_DIM];
-float fc3_weight[HIDDEN2_DIM * OUTPUT_DIM];
-float fc3_bias[OUTPUT_DIM];
-
-// 数据存储结构
-struct pid_data {
-    uint32_t pid;
-    time_t timestamp;
-    char **data;
-    size_t data_count;
-    size_t data_capacity;
-    struct pid_data *next;
-};
-
-// 哈希表存储PID数据
-#define HASH_SIZE 1024
-struct pid_data *data_table[HASH_SIZE] = {0};
-
-// ReLU激活函数
-float relu(float x) {
-    return x > 0 ? x : 0;
-}
-
-// 矩阵-向量乘法
-void matmul(const float* matrix, const float* vector, float* result, int rows, int cols) {
-    for (int i = 0; i < rows; i++) {
-        result[i] = 0;
-        for (int j = 0; j < cols; j++) {
-            result[i] += matrix[i * cols + j] * vector[j];
-        }
-    }
-}
-
-// 加载模型权重
-int load_weights(const char* filepath) {
-    FILE* file = fopen(filepath, "rb");
-    if (!file) {
-        printf("无法打开权重文件: %s\n", filepath);
-        return -1;
-    }
-
-    size_t read_count = 0;
-    read_count += fread(fc1_weight, sizeof(float), INPUT_DIM * HIDDEN1_DIM, file);
-    read_count += fread(fc1_bias, sizeof(float), HIDDEN1_DIM, file);
-    read_count += fread(fc2_weight, sizeof(float), HIDDEN1_DIM * HIDDEN2_DIM, file);
-    read_count += fread(fc2_bias, sizeof(float), HIDDEN2_DIM, file);
-    read_count += fread(fc3_weight, sizeof(float), HIDDEN2_DIM * OUTPUT_DIM, file);
-    read_count += fread(fc3_bias, sizeof(float), OUTPUT_DIM, file);
-
-    fclose(file);
-    if (read_count != INPUT_DIM * HIDDEN1_DIM + HIDDEN1_DIM + 
-                     HIDDEN1_DIM * HIDDEN2_DIM + HIDDEN2_DIM + 
-                     HIDDEN2_DIM * OUTPUT_DIM + OUTPUT_DIM) {
-        printf("权重文件读取失败\n");
-        return -1;
-    }
-    printf("模型权重加载成功\n");
-    return 0;
-}
-
-// 前向传播
-void forward(float* input, float* output) {
-    float hidden1[HIDDEN1_DIM];
-    float hidden2[HIDDEN2_DIM];
-
-    matmul(fc1_weight, input, hidden1, HIDDEN1_DIM, INPUT_DIM);
-    for (int i = 0; i < HIDDEN1_DIM; i++) {
-        hidden1[i] = relu(hidden1[i] + fc1_bias[i]);
-    }
-
-    matmul(fc2_weight, hidden1, hidden2, HIDDEN2_DIM, HIDDEN1_DIM);
-    for (int i = 0; i < HIDDEN2_DIM; i++) {
-        hidden2[i] = relu(hidden2[i] + fc2_bias[i]);
-    }
-
-    matmul(fc3_weight, hidden2, output, OUTPUT_DIM, HIDDEN2_DIM);
-    for (int i = 0; i < OUTPUT_DIM; i++) {
-        output[i] += fc3_bias[i];
-    }
-}
-
-// 计算哈希
-static unsigned int hash_pid(uint32_t pid) {
-    return pid % HASH_SIZE;
-}
-
-// 查找或创建PID数据节点
-static struct pid_data *get_pid_data(uint32_t pid) {
-    unsigned int index = hash_pid(pid);
-    struct pid_data *entry = data_table[index];
-    
-    while (entry) {
-        if (entry->pid == pid)
-            return entry;
-        entry = entry->next;
-    }
-
-    struct pid_data *new_entry = calloc(1, sizeof(struct pid_data));
-    if (!new_entry) {
-        perror("calloc pid_data");
-        return NULL;
-    }
-    
-    new_entry->pid = pid;
-    new_entry->timestamp = time(NULL);
-    new_entry->data_capacity = 10;
-    new_entry->data = calloc(new_entry->data_capacity, sizeof(char *));
-    if (!new_entry->data) {
-        perror("calloc data array");
-        free(new_entry);
-        return NULL;
-    }
-    
-    new_entry->next = data_table[index];
-    data_table[index] = new_entry;
-    return new_entry;
-}
-
-// 清理超过10秒的数据
-static void cleanup_old_data() {
-    time_t now = time(NULL);
-    for (int i = 0; i < HASH_SIZE; i++) {
-        struct pid_data *entry = data_table[i];
-        struct pid_data *prev = NULL;
-        
-        while (entry) {
-            if (now - entry->timestamp >= 10) {
-                // 释放数据数组
-                for (size_t j = 0; j < entry->data_count; j++) {
-                    free(entry->data[j]);
-                }
-                free(entry->data);
-                
-                // 从链表中移除
-                if (prev) {
-                    prev->next = entry->next;
-                } else {
-                    data_table[i] = entry->next;
-                }
-                
-                struct pid_data *temp = entry;
-                entry = entry->next;
-                free(temp);
-            } else {
-                prev = entry;
-                entry = entry->next;
-            }
-        }
-    }
+#include "logger.h"
+#include "verdict_stream.h"
+#include "respond.h"
+#include "latency.h"
+#include "metrics.h"
+#include "kleb.h"
+#include "selfprof.h"
+
+#define RECV_BUF_SIZE (2 * PIPE_BUF)
+#define EXPIRE_SECONDS 10
+
+// 发布、处置并输出一条推理结果
+static void emit_verdict(const struct kleb_verdict *v) {
+    latency_record(LAT_INFERENCE, v->infer_ns);
+    metrics_add(METRIC_INFERENCES, 1);
+    if (v->window == 1 && v->exec_ns)
+        latency_record(LAT_EXEC_TO_VERDICT, v->time_ns - v->exec_ns);
+    const char* label = v->prediction == 1 ? "恶意" : "良性";
+    if (v->prediction == 1)
+        metrics_add(METRIC_VERDICTS_MALICIOUS, 1);
+    selfprof_switch(PROF_OUTPUT);
+    verdict_publish(v->pid, v->cgroup_id, v->window, v->prediction, v->score);
+    respond_verdict(v->pid, v->cgroup_id, v->prediction, v->score);
+    if (v->cgroup_id)
+        log_msg(LOG_INFO, "cgroup %" PRIu64 " 推理结果 (第 %u 次接收): %s (0=良性, 1=恶意, 预测值=%d)\n",
+               v->cgroup_id, v->window, label, v->prediction);
+    else
+        log_msg(LOG_INFO, "PID %u 推理结果 (第 %u 次接收): %s (0=良性, 1=恶意, 预测值=%d)\n", 
+               v->pid, v->window, label, v->prediction);
+    latency_record(LAT_OUTPUT, latency_now() - v->time_ns);
+    selfprof_switch(PROF_INFERENCE);
 }
 
-static int add_data_to_pid(uint32_t pid, const char *buffer, size_t len) {
-    struct pid_data *entry = get_pid_data(pid);
-    if (!entry)
-        return -1;
-
-    // 动态扩展数据数组
-    if (entry->data_count >= entry->data_capacity) {
-        entry->data_capacity *= 2;
-        char **new_data = realloc(entry->data, entry->data_capacity * sizeof(char *));
-        if (!new_data) {
-            perror("realloc data array");
-            return -1;
-        }
-        entry->data = new_data;
-    }
-
-    // 存储新数据
-    entry->data[entry->data_count] = strndup(buffer, len);
-    if (!entry->data[entry->data_count]) {
-        perror("strndup");
-        return -1;
-    }
-    
-    entry->data_count++;
-    entry->timestamp = time(NULL);
-
-    // 每次接收到数据时进行推理
-    float accumulated_data[INPUT_DIM] = {0}; // 初始化为 0
-    size_t valid_values = 0;
-
-    // 使用所有累积的数据，最多 MAX_ROWS 行
-    size_t start_idx = entry->data_count > MAX_ROWS ? entry->data_count - MAX_ROWS : 0;
-    for (size_t i = start_idx; i < entry->data_count && valid_values < INPUT_DIM; i++) {
-        char *line = entry->data[i];
-        char *token = strtok(line, "\n");
-        int col_idx = 0;
-        float values[COLS_PER_ROW];
-
-        // 跳过 PID 行
-        if (strstr(line, "[PID:") != NULL) {
-            continue;
-        }
-
-        // 解析每行中的值
-        while (token && col_idx < COLS_PER_ROW && valid_values < INPUT_DIM) {
-            if (sscanf(token, "  [%*d] %f\t", &values[col_idx]) == 1) {
-                accumulated_data[valid_values++] = values[col_idx];
-                col_idx++;
-            }
-            token = strtok(NULL, "\n");
-        }
-    }
-
-    // 如果数据不足 INPUT_DIM，填充 0
-    while (valid_values < INPUT_DIM) {
-        accumulated_data[valid_values++] = 0;
-    }
-
-    // 执行推理
-    float output[OUTPUT_DIM];
-    forward(accumulated_data, output);
-    int prediction = output[0] > output[1] ? 0 : 1;
-    const char* label = prediction == 1 ? "恶意" : "良性";
-    printf("PID %u 推理结果 (第 %zu 次接收): %s (0=良性, 1=恶意, 预测值=%d)\n", 
-           pid, entry->data_count, label, prediction);
+// 每个管道的重组缓冲区。一次 read 可能在窗口中间截断，未读完的窗口留到下一次读取
+struct recv_buf {
+    int fd;                     // 缓冲区内容所属的读端，槽位换了读端时丢弃旧内容
+    size_t len;
+    char data[RECV_BUF_SIZE];
+};
 
-    return 0;
-}
-// 释放所有数据
-static void cleanup_all_data() {
-    for (int i = 0; i < HASH_SIZE; i++) {
-        struct pid_data *entry = data_table[i];
-        while (entry) {
-            for (size_t j = 0; j < entry->data_count; j++) {
-                free(entry->data[j]);
-            }
-            free(entry->data);
-            struct pid_data *temp = entry;
-            entry = entry->next;
-            free(temp);
-        }
-        data_table[i] = NULL;
-    }
+// 解析一个窗口、推理并输出结果
+static void handle_blob(struct kleb_ctx *ctx, const char *blob, uint64_t recv_ns) {
+    struct kleb_window_info info;
+    metrics_add(METRIC_WINDOWS_RECEIVED, 1);
+    if (kleb_feed_window(ctx, blob, &info) != 0) {
+        metrics_add(METRIC_WINDOWS_DROPPED, 1);
+        log_msg(LOG_WARN, "%s，丢弃窗口\n", kleb_error(ctx));
+        return;
+    }
+    if (info.sent_ns)
+        latency_record(LAT_PIPE, recv_ns - info.sent_ns);
+
+    struct kleb_verdict v;
+    while (kleb_poll(ctx, &v, 1) == 1)
+        emit_verdict(&v);
 }
 
 // 接收线程
 void *receive_thread(void *arg) {
+    struct kleb_ctx *ctx = arg;
     struct pollfd *pfds = NULL;
+    struct recv_buf *bufs = NULL;
     int nfds = 0;
+    unsigned int seen_generation = 0;
 
-    // 加载模型权重
-    if (load_weights("model_weights.bin") != 0) {
-        printf("模型权重加载失败，退出接收线程\n");
-        return NULL;
-    }
+    selfprof_thread_begin(PROF_INFERENCE);
 
     while (!exiting) {
+        // 槽位新增、复用或释放后重建 poll 集合；fd 为 -1 的项被 poll 忽略
         pthread_mutex_lock(&pipe_mutex);
-        if (nfds < pipe_count) {
-            pfds = realloc(pfds, pipe_count * sizeof(struct pollfd));
-            if (!pfds) {
-                perror("realloc pollfd");
-                pthread_mutex_unlock(&pipe_mutex);
-                break;
+        if (nfds != pipe_count || seen_generation != pipe_generation) {
+            if (nfds < pipe_count) {
+                struct pollfd *grown = realloc(pfds, pipe_count * sizeof(struct pollfd));
+                if (!grown) {
+                    log_msg(LOG_ERROR, "realloc pollfd: %s\n", strerror(errno));
+                    pthread_mutex_unlock(&pipe_mutex);
+                    break;
+                }
+                pfds = grown;
+                struct recv_buf *grown_bufs = realloc(bufs, pipe_count * sizeof(struct recv_buf));
+                if (!grown_bufs) {
+                    log_msg(LOG_ERROR, "realloc recv_buf: %s\n", strerror(errno));
+                    pthread_mutex_unlock(&pipe_mutex);
+                    break;
+                }
+                bufs = grown_bufs;
+                for (int i = nfds; i < pipe_count; i++) {
+                    bufs[i].fd = -1;
+                    bufs[i].len = 0;
+                }
             }
-            for (int i = nfds; i < pipe_count; i++) {
+            for (int i = 0; i < pipe_count; i++) {
                 pfds[i].fd = pipe_fds[i][0];
                 pfds[i].events = POLLIN;
+                if (bufs[i].fd != pfds[i].fd) {
+                    bufs[i].fd = pfds[i].fd;
+                    bufs[i].len = 0;
+                }
             }
             nfds = pipe_count;
+            seen_generation = pipe_generation;
         }
         pthread_mutex_unlock(&pipe_mutex);
 
         if (nfds == 0) {
             usleep(100000);
-            cleanup_old_data();
+            kleb_expire(ctx, EXPIRE_SECONDS);
             continue;
         }
 
         int ret = poll(pfds, nfds, 100);
         if (ret < 0) {
-            perror("poll");
+            log_msg(LOG_ERROR, "poll: %s\n", strerror(errno));
             break;
         }
 
         for (int i = 0; i < nfds; i++) {
-            if (pfds[i].revents & POLLIN) {
-                char buffer[1024];
-                ssize_t len = read(pfds[i].fd, buffer, sizeof(buffer) - 1);
-                if (len > 0) {
-                    buffer[len] = '\0';
-                    printf("Received raw data:\n%s\n", buffer);
-                    
-                    // 从buffer中提取PID
-                    uint32_t pid;
-                    if (sscanf(buffer, "[PID: %u]", &pid) == 1) {
-                        if (add_data_to_pid(pid, buffer, len) == 0) {
-                            printf("Stored data for PID %u, total entries: %zu\n", 
-                                   pid, get_pid_data(pid)->data_count);
-                        }
+            if (pfds[i].revents & (POLLIN | POLLHUP)) {
+                struct recv_buf *rb = &bufs[i];
+                ssize_t len = read(pfds[i].fd, rb->data + rb->len, sizeof(rb->data) - rb->len);
+                if (len == 0) {
+                    // 采集线程已结束且数据已读完，释放读端；不完整的窗口随之丢弃
+                    if (rb->len) {
+                        metrics_add(METRIC_WINDOWS_DROPPED, 1);
+                        log_msg(LOG_WARN, "管道关闭时有 %zu 字节不完整的窗口，丢弃\n", rb->len);
+                    }
+                    pthread_mutex_lock(&pipe_mutex);
+                    close(pfds[i].fd);
+                    pipe_fds[i][0] = -1;
+                    pipe_generation++;
+                    pthread_mutex_unlock(&pipe_mutex);
+                    pfds[i].fd = -1;
+                    rb->fd = -1;
+                    rb->len = 0;
+                } else if (len > 0) {
+                    uint64_t recv_ns = latency_now();
+                    rb->len += (size_t)len;
+
+                    // 一次读取可能包含多个窗口，只处理以 '\0' 结尾的完整窗口
+                    char *blob = rb->data;
+                    char *end = rb->data + rb->len;
+                    char *term;
+                    while ((term = memchr(blob, '\0', end - blob)) != NULL) {
+                        log_msg(LOG_DEBUG, "Received raw data:\n%s\n", blob);
+                        handle_blob(ctx, blob, recv_ns);
+                        blob = term + 1;
+                    }
+                    rb->len = end - blob;
+                    if (rb->len == sizeof(rb->data)) {
+                        // 单个窗口不超过 PIPE_BUF，缓冲区满仍无结尾说明数据已损坏
+                        metrics_add(METRIC_WINDOWS_DROPPED, 1);
+                        log_msg(LOG_WARN, "管道数据缺少窗口结尾，丢弃 %zu 字节\n", rb->len);
+                        rb->len = 0;
+                    } else if (rb->len) {
+                        memmove(rb->data, blob, rb->len);
                     }
                 }
             }
         }
-        cleanup_old_data();
+        kleb_expire(ctx, EXPIRE_SECONDS);
     }
 
     free(pfds);
-    cleanup_all_data();
+    free(bufs);
+    selfprof_thread_end();
     return NULL;
 }
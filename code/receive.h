@@ -0,0 +1,8 @@
+#ifndef RECEIVE_H
+#define RECEIVE_H
+
+// 接收线程：轮询所有采集管道，把窗口交给 arg 指向的 struct kleb_ctx 推理，
+// 发布、处置并输出结果，直到 exiting 置位
+void *receive_thread(void *arg);
+
+#endif
@@ -0,0 +1,298 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <bpf/bpf.h>
+#include "respond.h"
+#include "common.h"
+#include "logger.h"
+#include "latency.h"
+#include "metrics.h"
+
+#define EXEC_TABLE_SIZE 4096
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+struct exec_slot {
+    uint32_t pid;
+    uint64_t exec_ns;
+    int contained;
+};
+
+static struct respond_config config;
+static struct exec_slot exec_table[EXEC_TABLE_SIZE];
+static pthread_mutex_t exec_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// 只由接收线程在 respond_verdict 中读写 contained
+static struct {
+    uint64_t id;
+    const char *path;
+    int contained;      // 已处置（或因含检测器自身而拒绝处置），之后的判定不再重复
+} cgroups[MAX_CGROUPS];
+static int cgroup_count;
+
+static const char *action_names[] = {
+    [RESPOND_NONE] = "none",
+    [RESPOND_STOP] = "stop",
+    [RESPOND_KILL] = "kill",
+    [RESPOND_FREEZE] = "freeze",
+    [RESPOND_BPF_STOP] = "bpf-stop",
+    [RESPOND_BPF_KILL] = "bpf-kill",
+};
+
+int respond_parse_action(const char *name, enum respond_action *action) {
+    for (size_t i = 0; i < sizeof(action_names) / sizeof(action_names[0]); i++) {
+        if (strcmp(name, action_names[i]) == 0) {
+            *action = i;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Unknown response action: %s\n", name);
+    return -1;
+}
+
+int respond_init(const struct respond_config *cfg) {
+    config = *cfg;
+    if ((config.action == RESPOND_BPF_STOP || config.action == RESPOND_BPF_KILL) &&
+        config.signal_map_fd < 0) {
+        fprintf(stderr, "BPF response requires the signal_pids map\n");
+        return -1;
+    }
+    if (config.threshold < 0 || config.threshold > 1) {
+        fprintf(stderr, "Response threshold must be within [0, 1]\n");
+        return -1;
+    }
+    return 0;
+}
+
+void respond_register_cgroup(uint64_t cgroup_id, const char *path) {
+    if (cgroup_count < MAX_CGROUPS) {
+        cgroups[cgroup_count].id = cgroup_id;
+        cgroups[cgroup_count].path = path;
+        cgroups[cgroup_count].contained = 0;
+        cgroup_count++;
+    }
+}
+
+void respond_note_exec(uint32_t pid, uint64_t exec_ns) {
+    if (config.action == RESPOND_NONE)
+        return;
+    pthread_mutex_lock(&exec_mutex);
+    struct exec_slot *slot = &exec_table[pid % EXEC_TABLE_SIZE];
+    slot->pid = pid;
+    slot->exec_ns = exec_ns;
+    slot->contained = 0;
+    pthread_mutex_unlock(&exec_mutex);
+}
+
+// 返回进程是否尚未处置，并取出 exec 时间。
+// 没有 exec 记录（/proc 扫描补回的进程，或槽位被同余的 PID 占用）时为该 PID 占用槽位，exec 时间为 0
+static int pending_exec(uint32_t pid, uint64_t *exec_ns) {
+    pthread_mutex_lock(&exec_mutex);
+    struct exec_slot *slot = &exec_table[pid % EXEC_TABLE_SIZE];
+    if (slot->pid != pid) {
+        slot->pid = pid;
+        slot->exec_ns = 0;
+        slot->contained = 0;
+    }
+    *exec_ns = slot->exec_ns;
+    int pending = !slot->contained;
+    pthread_mutex_unlock(&exec_mutex);
+    return pending;
+}
+
+// 处置成功后才标记，同一进程只处置一次；失败的处置在下一个恶意窗口重试
+static void mark_contained(uint32_t pid) {
+    pthread_mutex_lock(&exec_mutex);
+    struct exec_slot *slot = &exec_table[pid % EXEC_TABLE_SIZE];
+    if (slot->pid == pid)
+        slot->contained = 1;
+    pthread_mutex_unlock(&exec_mutex);
+}
+
+static int write_cgroup_file(const char *cgroup_dir, const char *file, const char *value) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", cgroup_dir, file);
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        log_msg(LOG_ERROR, "Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    ssize_t n = write(fd, value, strlen(value));
+    int saved = errno;
+    close(fd);
+    if (n < 0) {
+        log_msg(LOG_ERROR, "Failed to write %s: %s\n", path, strerror(saved));
+        return -1;
+    }
+    return 0;
+}
+
+// 读取 /proc/<pid>/cgroup 中的 cgroup v2 路径（"0::/path"）
+static int process_cgroup_dir(uint32_t pid, char *out, size_t out_len) {
+    char path[64], line[4096];
+    snprintf(path, sizeof(path), "/proc/%u/cgroup", pid);
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return -1;
+    int found = -1;
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, "0::", 3) == 0) {
+            line[strcspn(line, "\n")] = '\0';
+            // 不冻结根 cgroup
+            if (strcmp(line + 3, "/") != 0) {
+                snprintf(out, out_len, "%s%s", CGROUP_ROOT, line + 3);
+                found = 0;
+            }
+            break;
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+static int cgroup_index(uint64_t cgroup_id) {
+    for (int i = 0; i < cgroup_count; i++) {
+        if (cgroups[i].id == cgroup_id)
+            return i;
+    }
+    return -1;
+}
+
+// dir 是否为 inner 本身或其上级 cgroup
+static int cgroup_contains(const char *dir, const char *inner) {
+    size_t len = strlen(dir);
+    return strncmp(dir, inner, len) == 0 && (inner[len] == '\0' || inner[len] == '/');
+}
+
+// 检测器自身所在的 cgroup 或其上级被冻结/终止时检测器也会停住。
+// 监控路径来自命令行，可能是相对路径或带 "/"、".."，先规范化再比较
+static int contains_detector(const char *cgroup_dir) {
+    char self_dir[4096], real[PATH_MAX];
+    if (process_cgroup_dir((uint32_t)getpid(), self_dir, sizeof(self_dir)) != 0)
+        return 0;
+    if (!realpath(cgroup_dir, real))
+        return 0;
+    return cgroup_contains(real, self_dir);
+}
+
+static int contain_process(uint32_t pid) {
+    switch (config.action) {
+    case RESPOND_STOP:
+        return kill(pid, SIGSTOP);
+    case RESPOND_KILL:
+        return kill(pid, SIGKILL);
+    case RESPOND_FREEZE: {
+        char dir[4096];
+        if (process_cgroup_dir(pid, dir, sizeof(dir)) != 0) {
+            log_msg(LOG_WARN, "No freezable cgroup for PID %u, sending SIGSTOP\n", pid);
+            return kill(pid, SIGSTOP);
+        }
+        if (contains_detector(dir)) {
+            log_msg(LOG_WARN, "Cgroup of PID %u contains the detector, sending SIGSTOP\n", pid);
+            return kill(pid, SIGSTOP);
+        }
+        return write_cgroup_file(dir, "cgroup.freeze", "1");
+    }
+    case RESPOND_BPF_STOP:
+    case RESPOND_BPF_KILL: {
+        uint32_t sig = config.action == RESPOND_BPF_STOP ? SIGSTOP : SIGKILL;
+        return bpf_map_update_elem(config.signal_map_fd, &pid, &sig, BPF_ANY);
+    }
+    case RESPOND_NONE:
+    default:
+        return 0;
+    }
+}
+
+// 对 cgroup：kill 使用 cgroup.kill，其余动作冻结整个 cgroup
+static int contain_cgroup(const char *path) {
+    if (config.action == RESPOND_KILL || config.action == RESPOND_BPF_KILL)
+        return write_cgroup_file(path, "cgroup.kill", "1");
+    return write_cgroup_file(path, "cgroup.freeze", "1");
+}
+
+int respond_verdict(uint32_t pid, uint64_t cgroup_id, int prediction, const float output[2]) {
+    if (config.action == RESPOND_NONE || prediction != 1)
+        return 0;
+
+    // 两类 logits 的 softmax 概率
+    float confidence = 1.0f / (1.0f + expf(output[0] - output[1]));
+    if (confidence < config.threshold)
+        return 0;
+
+    const char *action = action_names[config.action];
+    if (cgroup_id) {
+        int idx = cgroup_index(cgroup_id);
+        if (idx < 0) {
+            log_msg(LOG_WARN, "Unknown cgroup %" PRIu64 ", cannot contain\n", cgroup_id);
+            return 0;
+        }
+        if (cgroups[idx].contained)
+            return 0;
+        if (contains_detector(cgroups[idx].path)) {
+            log_msg(LOG_WARN, "Cgroup %" PRIu64 " contains the detector, refusing to %s it\n",
+                    cgroup_id, action);
+            cgroups[idx].contained = 1;
+            return 0;
+        }
+        if (config.dry_run) {
+            log_msg(LOG_WARN, "[dry-run] would %s cgroup %" PRIu64 " (confidence %.3f)\n",
+                    action, cgroup_id, confidence);
+            cgroups[idx].contained = 1;
+            return 1;
+        }
+        if (contain_cgroup(cgroups[idx].path) != 0)
+            return 0;
+        cgroups[idx].contained = 1;
+        metrics_add(METRIC_CONTAINED, 1);
+        log_msg(LOG_WARN, "Contained cgroup %" PRIu64 " via %s (confidence %.3f)\n",
+                cgroup_id, action, confidence);
+        return 1;
+    }
+
+    uint64_t exec_ns;
+    if (!pending_exec(pid, &exec_ns))
+        return 0;
+
+    if (config.dry_run) {
+        log_msg(LOG_WARN, "[dry-run] would %s PID %u (confidence %.3f)\n", action, pid, confidence);
+        mark_contained(pid);
+        return 1;
+    }
+    if (contain_process(pid) != 0) {
+        log_msg(LOG_ERROR, "Failed to %s PID %u: %s\n", action, pid, strerror(errno));
+        return 0;
+    }
+    mark_contained(pid);
+
+    // BPF 动作此时只写入了 map，信号在目标下一次系统调用时才发出：只计为已请求，不统计处置耗时
+    if (config.action == RESPOND_BPF_STOP || config.action == RESPOND_BPF_KILL) {
+        metrics_add(METRIC_CONTAIN_REQUESTED, 1);
+        log_msg(LOG_WARN, "Requested %s for PID %u (confidence %.3f)\n", action, pid, confidence);
+        return 1;
+    }
+
+    metrics_add(METRIC_CONTAINED, 1);
+    uint64_t elapsed = exec_ns ? latency_now() - exec_ns : 0;
+    if (exec_ns)
+        latency_record(LAT_EXEC_TO_CONTAIN, elapsed);
+    log_msg(LOG_WARN, "Contained PID %u via %s (confidence %.3f), %.2f ms after exec\n",
+            pid, action, confidence, elapsed / 1e6);
+    return 1;
+}
+
+void respond_report(void) {
+    uint64_t count = latency_count(LAT_EXEC_TO_CONTAIN);
+    if (count == 0)
+        return;
+    log_msg(LOG_INFO, "Time to containment: %" PRIu64 " processes, mean %.2f ms, max %.2f ms\n",
+            count, latency_sum(LAT_EXEC_TO_CONTAIN) / 1e6 / count, latency_max(LAT_EXEC_TO_CONTAIN) / 1e6);
+}
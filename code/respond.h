@@ -0,0 +1,38 @@
+#ifndef RESPOND_H
+#define RESPOND_H
+
+#include <stdint.h>
+
+// 响应阶段：推理判定为恶意且置信度不低于阈值时立即处置目标
+
+enum respond_action {
+    RESPOND_NONE = 0,
+    RESPOND_STOP,       // 用户态 SIGSTOP
+    RESPOND_KILL,       // 用户态 SIGKILL
+    RESPOND_FREEZE,     // 写 cgroup.freeze 冻结进程所在 cgroup；该 cgroup 含检测器自身时改为 SIGSTOP
+    RESPOND_BPF_STOP,   // 由 BPF 在目标下一次系统调用时 bpf_send_signal(SIGSTOP)
+    RESPOND_BPF_KILL,   // 同上，SIGKILL
+};
+
+struct respond_config {
+    enum respond_action action;
+    float threshold;    // 恶意类 softmax 概率阈值
+    int dry_run;        // 只记录将要执行的动作
+    int signal_map_fd;  // BPF signal_pids map，BPF 动作需要
+};
+
+int respond_parse_action(const char *name, enum respond_action *action);
+int respond_init(const struct respond_config *config);
+
+// 注册 cgroup 监控路径，用于对 cgroup 判定执行冻结/终止
+void respond_register_cgroup(uint64_t cgroup_id, const char *path);
+
+// 记录进程 exec 时间（BPF 记录的 CLOCK_MONOTONIC 纳秒），用于统计 exec 到处置的耗时
+void respond_note_exec(uint32_t pid, uint64_t exec_ns);
+
+// 推理后调用；返回 1 表示已处置（dry-run 下为将处置，BPF 动作为已写入 signal_pids）
+int respond_verdict(uint32_t pid, uint64_t cgroup_id, int prediction, const float output[2]);
+
+void respond_report(void);
+
+#endif
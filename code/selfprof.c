@@ -0,0 +1,315 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "common.h"
+#include "logger.h"
+#include "selfprof.h"
+
+// 登记槽位：运行中的线程各占一个，采样线程通过其 CPU 时钟读取尚未结算的时间
+#define MAX_PROF_THREADS (MAX_PIDS + MAX_CGROUPS + 16)
+
+struct prof_slot {
+    _Atomic int used;
+    _Atomic int role;
+    clockid_t clock;
+    _Atomic uint64_t base_ns;       // 登记时的线程 CPU 时间
+    _Atomic uint64_t charged_ns;    // 已结算到角色累计中的部分
+};
+
+struct prof_sample {
+    struct timespec timestamp;
+    double cpu_usage;                   // 进程 CPU（单核百分比，getrusage）
+    double role_usage[PROF_ROLE_COUNT];
+    unsigned long ram_usage;            // KB
+    unsigned long virtual_mem;          // KB
+};
+
+static const char *role_names[PROF_ROLE_COUNT] = {
+    [PROF_BPF_POLL] = "bpf_poll",
+    [PROF_COLLECT] = "collect",
+    [PROF_INFERENCE] = "inference",
+    [PROF_OUTPUT] = "output",
+    [PROF_OTHER] = "other",
+};
+
+static atomic_int enabled;
+static atomic_int running;
+static pthread_t sampler_tid;
+static int interval_ms;
+static const char *csv_path;
+static int statm_fd = -1;
+static long page_kb;
+
+static struct prof_slot slots[MAX_PROF_THREADS];
+static atomic_uint slot_hint;
+static _Atomic uint64_t role_ns[PROF_ROLE_COUNT];
+static uint64_t start_cpu_ns;
+
+static struct prof_sample samples[MAX_PROF_SAMPLES];
+static size_t sample_count;
+
+static __thread int tl_active;
+static __thread int tl_slot = -1;
+static __thread enum prof_role tl_role;
+static __thread uint64_t tl_last_ns;
+
+static uint64_t ts_ns(const struct timespec *ts) {
+    return (uint64_t)ts->tv_sec * 1000000000ULL + ts->tv_nsec;
+}
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts_ns(&ts);
+}
+
+static uint64_t process_cpu_ns(void) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+    return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000ULL +
+           (uint64_t)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000ULL;
+}
+
+int selfprof_enabled(void) {
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+const char *selfprof_role_name(enum prof_role role) {
+    return role < PROF_ROLE_COUNT ? role_names[role] : "unknown";
+}
+
+void selfprof_thread_begin(enum prof_role role) {
+    if (!selfprof_enabled() || tl_active)
+        return;
+    tl_active = 1;
+    tl_role = role;
+    tl_last_ns = thread_cpu_ns();
+    tl_slot = -1;
+
+    clockid_t clock;
+    if (pthread_getcpuclockid(pthread_self(), &clock) != 0)
+        return;
+    // 槽位满时仍按线程本地状态结算，只是采样线程看不到其未结算部分
+    unsigned int start = atomic_fetch_add_explicit(&slot_hint, 1, memory_order_relaxed);
+    for (int i = 0; i < MAX_PROF_THREADS; i++) {
+        struct prof_slot *slot = &slots[(start + i) % MAX_PROF_THREADS];
+        int expected = 0;
+        if (atomic_load_explicit(&slot->used, memory_order_relaxed) ||
+            !atomic_compare_exchange_strong(&slot->used, &expected, -1))
+            continue;
+        slot->clock = clock;
+        atomic_store_explicit(&slot->base_ns, tl_last_ns, memory_order_relaxed);
+        atomic_store_explicit(&slot->charged_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&slot->role, role, memory_order_relaxed);
+        atomic_store_explicit(&slot->used, 1, memory_order_release);
+        tl_slot = (start + i) % MAX_PROF_THREADS;
+        return;
+    }
+}
+
+void selfprof_switch(enum prof_role role) {
+    if (!tl_active || role == tl_role)
+        return;
+    uint64_t now = thread_cpu_ns();
+    uint64_t delta = now - tl_last_ns;
+    atomic_fetch_add_explicit(&role_ns[tl_role], delta, memory_order_relaxed);
+    if (tl_slot >= 0) {
+        atomic_fetch_add_explicit(&slots[tl_slot].charged_ns, delta, memory_order_relaxed);
+        atomic_store_explicit(&slots[tl_slot].role, role, memory_order_relaxed);
+    }
+    tl_last_ns = now;
+    tl_role = role;
+}
+
+void selfprof_thread_end(void) {
+    if (!tl_active)
+        return;
+    uint64_t delta = thread_cpu_ns() - tl_last_ns;
+    atomic_fetch_add_explicit(&role_ns[tl_role], delta, memory_order_relaxed);
+    if (tl_slot >= 0)
+        atomic_store_explicit(&slots[tl_slot].used, 0, memory_order_release);
+    tl_slot = -1;
+    tl_active = 0;
+}
+
+// 各角色累计 CPU：已结算部分 + 运行中线程自上次结算以来的部分（近似快照）
+static void snapshot(uint64_t out[PROF_ROLE_COUNT]) {
+    for (int r = 0; r < PROF_ROLE_COUNT; r++)
+        out[r] = atomic_load_explicit(&role_ns[r], memory_order_relaxed);
+    for (int i = 0; i < MAX_PROF_THREADS; i++) {
+        struct prof_slot *slot = &slots[i];
+        if (atomic_load_explicit(&slot->used, memory_order_acquire) != 1)
+            continue;
+        uint64_t charged = atomic_load_explicit(&slot->charged_ns, memory_order_relaxed);
+        int role = atomic_load_explicit(&slot->role, memory_order_relaxed);
+        struct timespec ts;
+        // 线程可能刚刚退出，此时时钟读取失败，其时间已在退出时结算
+        if (clock_gettime(slot->clock, &ts) != 0)
+            continue;
+        uint64_t pending = ts_ns(&ts) - atomic_load_explicit(&slot->base_ns, memory_order_relaxed);
+        if (pending > charged)
+            out[role] += pending - charged;
+    }
+}
+
+uint64_t selfprof_cpu_ns(enum prof_role role) {
+    uint64_t totals[PROF_ROLE_COUNT];
+    snapshot(totals);
+    return totals[role];
+}
+
+// /proc/self/statm 保持打开，每次 pread 读取，只解析前两个字段
+static void read_memory(unsigned long *rss_kb, unsigned long *vm_kb) {
+    char buf[128];
+    *rss_kb = *vm_kb = 0;
+    if (statm_fd == -1)
+        return;
+    ssize_t len = pread(statm_fd, buf, sizeof(buf) - 1, 0);
+    if (len <= 0)
+        return;
+    buf[len] = '\0';
+    char *end;
+    unsigned long size = strtoul(buf, &end, 10);
+    unsigned long resident = strtoul(end, NULL, 10);
+    *vm_kb = size * page_kb;
+    *rss_kb = resident * page_kb;
+}
+
+static void *sampler_thread(void *arg) {
+    (void)arg;
+    selfprof_thread_begin(PROF_OTHER);
+
+    uint64_t prev_roles[PROF_ROLE_COUNT];
+    snapshot(prev_roles);
+    uint64_t prev_cpu = process_cpu_ns();
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    uint64_t prev_wall = ts_ns(&next);
+
+    while (atomic_load(&running)) {
+        next.tv_nsec += (long)interval_ms * 1000000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        if (!atomic_load(&running))
+            break;
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t wall = ts_ns(&now) - prev_wall;
+        uint64_t roles[PROF_ROLE_COUNT];
+        snapshot(roles);
+        uint64_t cpu = process_cpu_ns();
+
+        struct prof_sample *sample = &samples[sample_count % MAX_PROF_SAMPLES];
+        clock_gettime(CLOCK_REALTIME, &sample->timestamp);
+        sample->cpu_usage = wall ? 100.0 * (cpu - prev_cpu) / wall : 0;
+        for (int r = 0; r < PROF_ROLE_COUNT; r++) {
+            // 快照是近似值，相邻两次之间可能出现微小回退
+            uint64_t delta = roles[r] > prev_roles[r] ? roles[r] - prev_roles[r] : 0;
+            sample->role_usage[r] = wall ? 100.0 * delta / wall : 0;
+            prev_roles[r] = roles[r];
+        }
+        read_memory(&sample->ram_usage, &sample->virtual_mem);
+        sample_count++;
+
+        prev_cpu = cpu;
+        prev_wall = ts_ns(&now);
+    }
+
+    selfprof_thread_end();
+    return NULL;
+}
+
+int selfprof_start(int interval, const char *path) {
+    if (interval <= 0) {
+        fprintf(stderr, "Invalid profiling interval: %d\n", interval);
+        return -1;
+    }
+    interval_ms = interval;
+    csv_path = path;
+    page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    statm_fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    if (statm_fd == -1)
+        fprintf(stderr, "Failed to open /proc/self/statm: %s\n", strerror(errno));
+    start_cpu_ns = process_cpu_ns();
+
+    atomic_store(&enabled, 1);
+    atomic_store(&running, 1);
+    if (pthread_create(&sampler_tid, NULL, sampler_thread, NULL) != 0) {
+        perror("pthread_create");
+        atomic_store(&running, 0);
+        atomic_store(&enabled, 0);
+        if (statm_fd != -1)
+            close(statm_fd);
+        statm_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static void save_csv(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        log_msg(LOG_ERROR, "Failed to open %s: %s\n", path, strerror(errno));
+        return;
+    }
+    fprintf(file, "Timestamp,CPU(%%)");
+    for (int r = 0; r < PROF_ROLE_COUNT; r++)
+        fprintf(file, ",%s(%%)", role_names[r]);
+    fprintf(file, ",RAM(KB),VirtualMem(KB)\n");
+
+    size_t count = sample_count < MAX_PROF_SAMPLES ? sample_count : MAX_PROF_SAMPLES;
+    size_t first = sample_count - count;
+    for (size_t i = 0; i < count; i++) {
+        const struct prof_sample *s = &samples[(first + i) % MAX_PROF_SAMPLES];
+        char time_str[32];
+        struct tm local_time;
+        localtime_r(&s->timestamp.tv_sec, &local_time);
+        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &local_time);
+        fprintf(file, "%s.%03ld,%.2f", time_str, s->timestamp.tv_nsec / 1000000, s->cpu_usage);
+        for (int r = 0; r < PROF_ROLE_COUNT; r++)
+            fprintf(file, ",%.2f", s->role_usage[r]);
+        fprintf(file, ",%lu,%lu\n", s->ram_usage, s->virtual_mem);
+    }
+    fclose(file);
+    log_msg(LOG_INFO, "Self-profile (%zu samples) saved to %s\n", count, path);
+}
+
+void selfprof_stop(void) {
+    if (!atomic_exchange(&running, 0))
+        return;
+    pthread_join(sampler_tid, NULL);
+
+    uint64_t roles[PROF_ROLE_COUNT], attributed = 0;
+    snapshot(roles);
+    uint64_t total = process_cpu_ns() - start_cpu_ns;
+    log_msg(LOG_INFO, "Self-profile CPU time (total %.3fs):\n", total / 1e9);
+    for (int r = 0; r < PROF_ROLE_COUNT; r++) {
+        attributed += roles[r];
+        log_msg(LOG_INFO, "  %-12s %10.3fs %6.1f%%\n", role_names[r], roles[r] / 1e9,
+                total ? 100.0 * roles[r] / total : 0);
+    }
+    // 未登记线程（如 libbpf 内部）及登记前的时间
+    if (total > attributed)
+        log_msg(LOG_INFO, "  %-12s %10.3fs %6.1f%%\n", "unattributed", (total - attributed) / 1e9,
+                100.0 * (total - attributed) / total);
+
+    if (csv_path)
+        save_csv(csv_path);
+    if (statm_fd != -1)
+        close(statm_fd);
+    statm_fd = -1;
+}
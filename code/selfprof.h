@@ -0,0 +1,41 @@
+#ifndef SELFPROF_H
+#define SELFPROF_H
+
+#include <stdint.h>
+
+// 守护进程自身开销剖析：按线程 CPU 时钟（CLOCK_THREAD_CPUTIME_ID）把 CPU 时间
+// 归到各角色，后台线程定期采样，不重复打开和解析 /proc 文件。
+// 未启动时各登记函数立即返回
+
+#define MAX_PROF_SAMPLES 3600   // 最多保留最近 3600 个采样点（默认每秒 1 次）
+
+enum prof_role {
+    PROF_BPF_POLL = 0,  // 主线程：perf buffer 轮询与采集线程调度
+    PROF_COLLECT,       // 采集线程
+    PROF_INFERENCE,     // 接收线程：窗口解析与前向推理
+    PROF_OUTPUT,        // 结果发布、处置、日志与结果流线程
+    PROF_OTHER,         // 指标端点与剖析线程本身
+    PROF_ROLE_COUNT
+};
+
+// 登记调用线程，之后的 CPU 时间归到 role
+void selfprof_thread_begin(enum prof_role role);
+
+// 同一线程内切换归属角色（读一次线程 CPU 时钟）
+void selfprof_switch(enum prof_role role);
+
+// 线程退出前调用，结算剩余 CPU 时间并释放登记槽位
+void selfprof_thread_end(void);
+
+// 启动采样线程；csv_path 非空时 selfprof_stop 写出采样序列
+int selfprof_start(int interval_ms, const char *csv_path);
+
+// 停止采样，写出 CSV 并输出各角色 CPU 汇总
+void selfprof_stop(void);
+
+// 各角色累计 CPU 时间（含运行中线程未结算的部分）
+uint64_t selfprof_cpu_ns(enum prof_role role);
+const char *selfprof_role_name(enum prof_role role);
+int selfprof_enabled(void);
+
+#endif
@@ -9,104 +9,123 @@
 #include <bpf/libbpf.h>
 #include <bpf/bpf.h>
 #include <time.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sys/stat.h>
+#include <limits.h>
 #include "program_a_bpf.skel.h"
 #include "collect.h"
 #include "common.h"
+#include "event_set.h"
+#include "logger.h"
+#include "verdict_stream.h"
+#include "respond.h"
+#include "latency.h"
+#include "exec_event.h"
+#include "metrics.h"
+#include "proc_scan.h"
+#include "dispatch.h"
+#include "receive.h"
+#include "kleb.h"
+#include "selfprof.h"
 
-// 哈希表节点，用于存储 PID 和时间戳
-struct pid_entry {
-    uint32_t pid;
-    time_t timestamp;
-    struct pid_entry *next;
-};
+#define DEFAULT_WEIGHTS_PATH "model_weights.bin"
+#define PROFILE_INTERVAL_MS 1000
+
+static volatile sig_atomic_t dump_latency = 0;
 
-// 哈希表大小
-#define HASH_SIZE 1024
+// cgroup 监控模式
+static const char *cgroup_paths[MAX_CGROUPS];
+static int cgroup_count = 0;
+static int cgroup_only = 0;
 
-// 全局哈希表
-struct pid_entry *pid_table[HASH_SIZE] = {0};
+// 实际采集的事件集，须与模型特征模式一致
+static struct event_set active_events;
 
-// 定义全局变量（在 common.h 中声明）
-volatile sig_atomic_t exiting = 0;
-int pipe_fds[MAX_PIDS][2];
-int pipe_count = 0;
-pthread_mutex_t pipe_mutex = PTHREAD_MUTEX_INITIALIZER;
+// 溢出采样模式：事件集的第一个事件（默认 branches）每计数 sample_period 次采样一次，0 表示按 10ms 定时轮询
+static uint64_t sample_period = 0;
 
-// 哈希函数
-static unsigned int hash_pid(uint32_t pid) {
-    return pid % HASH_SIZE;
+// 采集线程函数（由 dispatch 在独立线程中调用）
+static void run_collector(uint32_t pid, uint64_t exec_ns, int pipe_fd, void *ctx) {
+    if (sample_period)
+        collect_perf_events_sampled(pid, &active_events, sample_period, exec_ns, pipe_fd);
+    else
+        collect_perf_events(pid, &active_events, exec_ns, pipe_fd);
 }
 
-// 检查 PID 是否在 5 秒内已处理
-static int is_pid_recent(uint32_t pid) {
-    unsigned int index = hash_pid(pid);
-    struct pid_entry *entry = pid_table[index];
-    time_t now = time(NULL);
+// cgroup 监控线程函数
+struct cgroup_thread_arg {
+    const char *path;
+    const struct event_set *events;
+    int pipe_fd;
+};
 
-    while (entry) {
-        if (entry->pid == pid) {
-            if (now - entry->timestamp < 5) {
-                return 1;
-            } else {
-                entry->timestamp = now;
-                return 0;
-            }
+void *cgroup_monitor_thread(void *arg) {
+    struct cgroup_thread_arg *carg = arg;
+    selfprof_thread_begin(PROF_COLLECT);
+    metrics_add(METRIC_COLLECTORS_ACTIVE, 1);
+    collect_cgroup_events(carg->path, carg->events, carg->pipe_fd);
+    metrics_add(METRIC_COLLECTORS_ACTIVE, -1);
+    selfprof_thread_end();
+    free(carg);
+    return NULL;
+}
+
+// 为每个 cgroup 创建管道和常驻采集线程
+static int start_cgroup_monitors() {
+    for (int i = 0; i < cgroup_count; i++) {
+        struct stat st;
+        if (stat(cgroup_paths[i], &st) == -1 || !S_ISDIR(st.st_mode)) {
+            fprintf(stderr, "Invalid cgroup path %s\n", cgroup_paths[i]);
+            return -1;
         }
-        entry = entry->next;
-    }
+        log_msg(LOG_INFO, "[cgroup] Monitoring %s (id %llu)\n", cgroup_paths[i], (unsigned long long)st.st_ino);
+        respond_register_cgroup(st.st_ino, cgroup_paths[i]);
 
-    struct pid_entry *new_entry = malloc(sizeof(struct pid_entry));
-    if (!new_entry) {
-        perror("malloc pid_entry");
-        return 0;
-    }
-    new_entry->pid = pid;
-    new_entry->timestamp = now;
-    new_entry->next = pid_table[index];
-    pid_table[index] = new_entry;
-    return 0;
-}
+        int fd[2];
+        if (dispatch_alloc_pipe(fd) == -1)
+            return -1;
 
-// 清理哈希表
-static void cleanup_pid_table() {
-    for (int i = 0; i < HASH_SIZE; i++) {
-        struct pid_entry *entry = pid_table[i];
-        while (entry) {
-            struct pid_entry *temp = entry;
-            entry = entry->next;
-            free(temp);
+        struct cgroup_thread_arg *carg = malloc(sizeof(*carg));
+        if (!carg) {
+            perror("malloc");
+            return -1;
         }
-        pid_table[i] = NULL;
-    }
-}
+        carg->path = cgroup_paths[i];
+        carg->events = &active_events;
+        carg->pipe_fd = fd[1];
 
-// 清理管道
-static void cleanup_pipes() {
-    pthread_mutex_lock(&pipe_mutex);
-    for (int i = 0; i < pipe_count; i++) {
-        close(pipe_fds[i][0]);
-        close(pipe_fds[i][1]);
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, cgroup_monitor_thread, carg) != 0) {
+            perror("pthread_create");
+            free(carg);
+            return -1;
+        }
+        pthread_detach(tid);
     }
-    pipe_count = 0;
-    pthread_mutex_unlock(&pipe_mutex);
+    return 0;
 }
 
-// Thread worker data
-struct thread_arg {
-    int pid;
-    const char **events;
-    int pipe_fd;
-};
-
-// 接收线程函数声明
-void *receive_thread(void *arg);
-
-// 监控线程函数
-void *monitor_thread(void *arg) {
-    struct thread_arg *targ = arg;
-    collect_perf_events(targ->pid, targ->events, targ->pipe_fd);
-    free(targ);
-    return NULL;
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-c cgroup_path]... [-C] [-p period] [-e events | -E file] [-m weights] [-v | -q] [-s socket [-j]]\n"
+            "          [-A action [-T threshold] [-n]] [-M metrics_addr] [-S profile.csv]\n"
+            "  -c PATH    monitor cgroup v2 directory PATH (repeatable)\n"
+            "  -C         cgroup-only: do not start per-process collectors\n"
+            "  -p PERIOD  sample every PERIOD counts of the first event (default set: branches) instead of every 10 ms\n"
+            "  -e LIST    comma-separated event list (default: events from the model schema)\n"
+            "  -E FILE    read the event list from FILE, one event per line\n"
+            "  -m PATH    model weights (default " DEFAULT_WEIGHTS_PATH "; schema is PATH with .schema suffix)\n"
+            "  -v         verbose: also log raw counter windows (debug level)\n"
+            "  -q         quiet: only log warnings and errors\n"
+            "  -s PATH    publish binary verdict records on Unix socket PATH\n"
+            "  -j         also publish JSON lines on PATH.json\n"
+            "  -A ACTION  contain malicious targets: stop, kill, freeze, bpf-stop, bpf-kill\n"
+            "  -T PROB    minimum malicious probability before acting (default 0.5)\n"
+            "  -n         dry run: log the response instead of performing it\n"
+            "  -M ADDR    serve Prometheus metrics on Unix socket ADDR, or on 127.0.0.1:PORT for ADDR :PORT\n"
+            "  -S FILE    profile the daemon's own CPU per stage every second, write FILE on exit\n",
+            prog);
 }
 
 // BPF and perf event handling
@@ -114,66 +133,236 @@ void handle_signal(int sig) {
     exiting = 1;
 }
 
+// SIGUSR1：输出各阶段延迟直方图
+static void handle_dump_signal(int sig) {
+    dump_latency = 1;
+}
+
+// perf buffer 容量按观测到的峰值 exec 速率自动调整（每 CPU 页数，2 的幂）
+#define PB_MIN_PAGES 8
+#define PB_MAX_PAGES 1024
+#define PB_POLL_MS 100
+// 每条记录：perf_event_header + raw size + exec_event，按 8 字节对齐
+#define PB_RECORD_BYTES 32
+// 扫描 /proc 时向前放宽的时间，覆盖 fork 到 execve 的间隔
+#define RESCAN_MARGIN_NS 1000000000ull
+
+static size_t pb_pages = PB_MIN_PAGES;
+static uint64_t lost_pending = 0;       // 上次扫描以来丢失的事件数
+static uint64_t rate_count = 0;         // 当前一秒内的事件数（含丢失）
+static uint64_t rate_start_ns = 0;
+static uint64_t peak_rate = 0;          // 每秒峰值事件数
+
 static void handle_event(void *ctx, int cpu, void *data, __u32 data_sz) {
-    if (data_sz < sizeof(uint32_t)) return;
-    uint32_t pid = *(uint32_t *)data;
+    if (data_sz < sizeof(struct exec_event)) return;
+    const struct exec_event *event = data;
+    uint32_t pid = event->pid;
+    latency_record(LAT_EXEC_TO_EVENT, latency_now() - event->exec_ns);
+    metrics_add(METRIC_EXECS, 1);
+    rate_count++;
 
-    if (is_pid_recent(pid)) {
+    if (cgroup_only)
         return;
-    }
+    int ret = dispatch_exec(pid, event->exec_ns);
+    if (ret == 1)
+        metrics_add(METRIC_EXECS_DEDUPED, 1);
+    else if (ret == 0)
+        log_msg(LOG_INFO, "[execve] Caught process PID: %d\n", pid);
+}
 
-    printf("[execve] Caught process PID: %d\n", pid);
+// 每 CPU 缓冲区溢出时内核丢弃事件，只报告丢失数量
+static void handle_lost(void *ctx, int cpu, __u64 cnt) {
+    metrics_perf_lost(cpu, cnt);
+    lost_pending += cnt;
+    rate_count += cnt;
+    log_msg(LOG_WARN, "[execve] Lost %llu events on CPU %d\n", (unsigned long long)cnt, cpu);
+}
 
-    int fd[2];
-    if (pipe(fd) == -1) {
-        perror("pipe");
+static void recover_pid(uint32_t pid, void *ctx) {
+    if (dispatch_exec(pid, 0) != 0)
         return;
-    }
+    metrics_add(METRIC_EXECS_RECOVERED, 1);
+    log_msg(LOG_INFO, "[execve] Recovered process PID: %u\n", pid);
+}
 
-    pthread_mutex_lock(&pipe_mutex);
-    if (pipe_count >= MAX_PIDS) {
-        fprintf(stderr, "Too many PIDs\n");
-        close(fd[0]);
-        close(fd[1]);
-        pthread_mutex_unlock(&pipe_mutex);
-        return;
-    }
-    pipe_fds[pipe_count][0] = fd[0];
-    pipe_fds[pipe_count][1] = fd[1];
-    pipe_count++;
-    pthread_mutex_unlock(&pipe_mutex);
-
-    pthread_t tid;
-    struct thread_arg *targ = malloc(sizeof(*targ));
-    if (!targ) {
-        perror("malloc");
-        close(fd[0]);
-        close(fd[1]);
-        return;
-    }
-    targ->pid = pid;
-    targ->events = NULL;
-    targ->pipe_fd = fd[1];
-    if (pthread_create(&tid, NULL, monitor_thread, targ) != 0) {
-        perror("pthread_create");
-        close(fd[0]);
-        close(fd[1]);
-        free(targ);
-    } else {
-        pthread_detach(tid);
+// 按峰值速率计算所需页数：一个轮询周期内全部事件都可能落在同一个 CPU 上，再留一倍余量
+static size_t pages_for_rate(uint64_t rate) {
+    uint64_t bytes = rate * PB_RECORD_BYTES * PB_POLL_MS / 1000 * 2;
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t pages = PB_MIN_PAGES;
+    while (pages < PB_MAX_PAGES && pages * (uint64_t)page_size < bytes)
+        pages *= 2;
+    return pages;
+}
+
+// 每秒更新峰值速率，需要时以更大的页数重建 perf buffer；返回 1 表示已重建
+static int resize_perf_buffer(struct perf_buffer **pb, int map_fd, const struct perf_buffer_opts *opts) {
+    uint64_t now = latency_now();
+    if (now - rate_start_ns < 1000000000ull)
+        return 0;
+    uint64_t rate = rate_count * 1000000000ull / (now - rate_start_ns);
+    rate_count = 0;
+    rate_start_ns = now;
+    if (rate > peak_rate)
+        peak_rate = rate;
+
+    size_t pages = pages_for_rate(peak_rate);
+    if (pages <= pb_pages)
+        return 0;
+
+    // 先取走旧缓冲区中的事件再释放它：perf_buffer__free 会删除 events 映射中各 CPU 的条目，
+    // 必须在新缓冲区写入映射之前完成，否则新缓冲区的条目也被删掉。重建期间的事件由随后的 /proc 扫描补回
+    perf_buffer__consume(*pb);
+    perf_buffer__free(*pb);
+    struct perf_buffer *bigger = perf_buffer__new(map_fd, pages, opts);
+    if (!bigger) {
+        log_msg(LOG_WARN, "Failed to grow perf buffer to %zu pages\n", pages);
+        // 按原大小重建；仍然失败时由主循环退出
+        *pb = perf_buffer__new(map_fd, pb_pages, opts);
+        return 1;
     }
+    *pb = bigger;
+    log_msg(LOG_INFO, "Perf buffer grown from %zu to %zu pages per CPU (peak %llu execs/s)\n",
+            pb_pages, pages, (unsigned long long)peak_rate);
+    pb_pages = pages;
+    metrics_set(METRIC_PERF_BUFFER_PAGES, pb_pages);
+    return 1;
 }
 
 int main(int argc, char **argv) {
     struct program_a_bpf *skel;
     int err;
+    int opt;
+    const char *weights_path = DEFAULT_WEIGHTS_PATH;
+    const char *event_list = NULL, *event_file = NULL;
+    int level = LOG_INFO;
+    const char *verdict_socket = NULL;
+    int verdict_json = 0;
+    const char *metrics_addr = NULL;
+    const char *profile_path = NULL;
+    struct respond_config respond = { .action = RESPOND_NONE, .threshold = 0.5f, .signal_map_fd = -1 };
+
+    while ((opt = getopt(argc, argv, "c:Cp:e:E:m:vqs:jA:T:nM:S:h")) != -1) {
+        switch (opt) {
+        case 'c':
+            if (cgroup_count >= MAX_CGROUPS) {
+                fprintf(stderr, "Too many cgroups (max %d)\n", MAX_CGROUPS);
+                return 1;
+            }
+            cgroup_paths[cgroup_count++] = optarg;
+            break;
+        case 'C':
+            cgroup_only = 1;
+            break;
+        case 'p':
+            sample_period = strtoull(optarg, NULL, 0);
+            if (sample_period == 0) {
+                fprintf(stderr, "Invalid sample period: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'e':
+            event_list = optarg;
+            break;
+        case 'E':
+            event_file = optarg;
+            break;
+        case 'm':
+            weights_path = optarg;
+            break;
+        case 'v':
+            level = LOG_DEBUG;
+            break;
+        case 'q':
+            level = LOG_WARN;
+            break;
+        case 's':
+            verdict_socket = optarg;
+            break;
+        case 'j':
+            verdict_json = 1;
+            break;
+        case 'A':
+            if (respond_parse_action(optarg, &respond.action) != 0)
+                return 1;
+            break;
+        case 'T':
+            respond.threshold = strtof(optarg, NULL);
+            break;
+        case 'n':
+            respond.dry_run = 1;
+            break;
+        case 'M':
+            metrics_addr = optarg;
+            break;
+        case 'S':
+            profile_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (verdict_json && !verdict_socket) {
+        fprintf(stderr, "-j requires -s socket\n");
+        return 1;
+    }
+    if (cgroup_only && cgroup_count == 0) {
+        fprintf(stderr, "-C requires at least one -c cgroup_path\n");
+        return 1;
+    }
+
+    // 模型特征模式决定默认事件集，显式指定的事件集必须与之一致
+    struct kleb_ctx *detector = kleb_create();
+    if (!detector) {
+        perror("kleb_create");
+        return 1;
+    }
+    if (kleb_load_model(detector, weights_path) != 0) {
+        fprintf(stderr, "Failed to initialize model: %s\n", kleb_error(detector));
+        return 1;
+    }
+    if (event_list || event_file) {
+        struct event_set events;
+        if (event_list ? event_set_parse(&events, event_list) : event_set_load(&events, event_file))
+            return 1;
+        if (kleb_set_events(detector, &events) != 0) {
+            fprintf(stderr, "%s\n", kleb_error(detector));
+            return 1;
+        }
+    }
+    active_events = *kleb_events(detector);
+    // 先于其他线程启动，使各线程创建时即可登记
+    if (profile_path && selfprof_start(PROFILE_INTERVAL_MS, profile_path) != 0)
+        return 1;
+    selfprof_thread_begin(PROF_BPF_POLL);
+    if (logger_start(level, STDOUT_FILENO) != 0)
+        return 1;
+    if (verdict_socket && verdict_stream_start(verdict_socket, verdict_json) != 0) {
+        logger_stop();
+        return 1;
+    }
+    if (metrics_addr && metrics_start(metrics_addr) != 0) {
+        verdict_stream_stop();
+        logger_stop();
+        return 1;
+    }
 
     struct rlimit rlim = {RLIM_INFINITY, RLIM_INFINITY};
     setrlimit(RLIMIT_MEMLOCK, &rlim);
 
-    skel = program_a_bpf__open_and_load();
+    skel = program_a_bpf__open();
     if (!skel) {
-        fprintf(stderr, "Failed to open and load BPF skeleton\n");
+        fprintf(stderr, "Failed to open BPF skeleton\n");
+        return 1;
+    }
+    // enforce_signal 挂在所有系统调用入口上，只有 bpf-stop / bpf-kill 需要，其余情况不加载
+    if (respond.action != RESPOND_BPF_STOP && respond.action != RESPOND_BPF_KILL)
+        bpf_program__set_autoload(skel->progs.enforce_signal, false);
+    err = program_a_bpf__load(skel);
+    if (err) {
+        fprintf(stderr, "Failed to load BPF skeleton\n");
+        program_a_bpf__destroy(skel);
         return 1;
     }
     err = program_a_bpf__attach(skel);
@@ -183,9 +372,21 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    respond.signal_map_fd = bpf_map__fd(skel->maps.signal_pids);
+    if (respond_init(&respond) != 0) {
+        program_a_bpf__destroy(skel);
+        metrics_stop();
+        verdict_stream_stop();
+        logger_stop();
+        return 1;
+    }
+
+    dispatch_init(run_collector, NULL);
+
     struct perf_buffer *pb = NULL;
-    struct perf_buffer_opts opts = { .sample_cb = handle_event, .ctx = NULL };
-    pb = perf_buffer__new(bpf_map__fd(skel->maps.events), 8, &opts);
+    struct perf_buffer_opts opts = { .sample_cb = handle_event, .lost_cb = handle_lost, .ctx = NULL };
+    int events_fd = bpf_map__fd(skel->maps.events);
+    pb = perf_buffer__new(events_fd, pb_pages, &opts);
     if (!pb) {
         fprintf(stderr, "Failed to create perf buffer\n");
         program_a_bpf__destroy(skel);
@@ -194,31 +395,69 @@ int main(int argc, char **argv) {
 
     // 启动接收线程
     pthread_t recv_tid;
-    if (pthread_create(&recv_tid, NULL, receive_thread, NULL) != 0) {
+    if (pthread_create(&recv_tid, NULL, receive_thread, detector) != 0) {
         fprintf(stderr, "Failed to create receive thread\n");
         perf_buffer__free(pb);
         program_a_bpf__destroy(skel);
         return 1;
     }
-    pthread_detach(recv_tid);
 
-    printf("Program is running. Press Ctrl+C to stop...\n");
+    if (start_cgroup_monitors() != 0) {
+        exiting = 1;
+        perf_buffer__free(pb);
+        program_a_bpf__destroy(skel);
+        dispatch_cleanup();
+        return 1;
+    }
+
+    log_msg(LOG_INFO, "Program is running. Press Ctrl+C to stop...\n");
     signal(SIGINT, handle_signal);
     signal(SIGTERM, handle_signal);
+    signal(SIGUSR1, handle_dump_signal);
+
+    metrics_set(METRIC_PERF_BUFFER_PAGES, pb_pages);
+    rate_start_ns = latency_now();
+    uint64_t last_drain = boottime_now();
 
+    // perf_buffer__poll 本身阻塞等待事件，循环中不再额外 sleep，避免缓冲区在两次轮询之间溢出
     while (!exiting) {
-        err = perf_buffer__poll(pb, 100);
+        err = perf_buffer__poll(pb, PB_POLL_MS);
         if (err < 0 && err != -EINTR) {
             fprintf(stderr, "Error polling perf buffer: %d\n", err);
             break;
         }
-        usleep(100000);
+
+        int rebuilt = resize_perf_buffer(&pb, events_fd, &opts);
+        if (!pb) {
+            fprintf(stderr, "Failed to recreate perf buffer\n");
+            break;
+        }
+        if ((lost_pending || rebuilt) && !cgroup_only) {
+            log_msg(LOG_WARN, "[execve] %llu events lost, rescanning /proc\n",
+                    (unsigned long long)lost_pending);
+            proc_scan_recent(last_drain - RESCAN_MARGIN_NS, recover_pid, NULL);
+        }
+        lost_pending = 0;
+        last_drain = boottime_now();
+
+        if (dump_latency) {
+            dump_latency = 0;
+            latency_dump();
+        }
     }
 
     perf_buffer__free(pb);
     program_a_bpf__destroy(skel);
-    cleanup_pid_table();
-    cleanup_pipes();
-    printf("Exiting.\n");
+    // 接收线程看到 exiting 后在一个 poll 周期内返回，之后才能关闭管道和释放检测器
+    pthread_join(recv_tid, NULL);
+    dispatch_cleanup();
+    kleb_destroy(detector);
+    metrics_stop();
+    verdict_stream_stop();
+    respond_report();
+    latency_dump();
+    selfprof_stop();
+    log_msg(LOG_INFO, "Exiting.\n");
+    logger_stop();
     return 0;
 }
@@ -0,0 +1,310 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include "verdict_stream.h"
+#include "logger.h"
+#include "metrics.h"
+#include "selfprof.h"
+
+enum { SLOT_FREE, SLOT_ACTIVE, SLOT_CLOSING };
+
+struct subscriber {
+    atomic_int state;
+    atomic_int busy;            // 正在入队的发布者数
+    int fd;
+    int json;
+    // 单生产者（推理线程）单消费者（流线程）环形队列
+    struct verdict_record queue[VERDICT_QUEUE_SIZE];
+    atomic_size_t head;
+    atomic_size_t tail;
+    atomic_ullong dropped;
+    // 当前正在发送的记录
+    char out[512];
+    size_t out_len;
+    size_t out_off;
+};
+
+static struct subscriber subscribers[MAX_SUBSCRIBERS];
+static int listen_fds[2] = { -1, -1 };
+static char socket_paths[2][sizeof(((struct sockaddr_un *)0)->sun_path)];
+static int wake_fd = -1;
+static atomic_int running;
+static atomic_ullong next_seq;
+static pthread_t stream_tid;
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror("socket");
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, 8) == -1) {
+        fprintf(stderr, "Failed to listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void verdict_publish(uint32_t pid, uint64_t cgroup_id, uint32_t window, int prediction,
+                     const float score[2]) {
+    if (!atomic_load_explicit(&running, memory_order_relaxed))
+        return;
+
+    struct verdict_record rec = {
+        .magic = VERDICT_MAGIC,
+        .version = VERDICT_VERSION,
+        .size = sizeof(struct verdict_record),
+        .seq = atomic_fetch_add_explicit(&next_seq, 1, memory_order_relaxed),
+        .cgroup_id = cgroup_id,
+        .pid = pid,
+        .window = window,
+        .prediction = prediction,
+        .score = { score[0], score[1] },
+        .reserved = 0,
+    };
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    rec.timestamp_ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+
+    int queued = 0;
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        struct subscriber *sub = &subscribers[i];
+        atomic_fetch_add_explicit(&sub->busy, 1, memory_order_acquire);
+        if (atomic_load_explicit(&sub->state, memory_order_acquire) == SLOT_ACTIVE) {
+            size_t head = atomic_load_explicit(&sub->head, memory_order_relaxed);
+            size_t tail = atomic_load_explicit(&sub->tail, memory_order_acquire);
+            if (head - tail >= VERDICT_QUEUE_SIZE) {
+                atomic_fetch_add_explicit(&sub->dropped, 1, memory_order_relaxed);
+                metrics_add(METRIC_VERDICTS_DROPPED, 1);
+            } else {
+                rec.dropped = atomic_load_explicit(&sub->dropped, memory_order_relaxed);
+                sub->queue[head & (VERDICT_QUEUE_SIZE - 1)] = rec;
+                atomic_store_explicit(&sub->head, head + 1, memory_order_release);
+                queued = 1;
+            }
+        }
+        atomic_fetch_sub_explicit(&sub->busy, 1, memory_order_release);
+    }
+
+    if (queued) {
+        uint64_t one = 1;
+        if (write(wake_fd, &one, sizeof(one)) < 0) {
+            // 计数器饱和时 eventfd 返回 EAGAIN，流线程已被唤醒
+        }
+    }
+}
+
+static void accept_subscriber(int listen_fd, int json) {
+    int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == -1)
+        return;
+
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        struct subscriber *sub = &subscribers[i];
+        if (atomic_load(&sub->state) != SLOT_FREE)
+            continue;
+        sub->fd = fd;
+        sub->json = json;
+        sub->out_len = sub->out_off = 0;
+        atomic_store(&sub->head, 0);
+        atomic_store(&sub->tail, 0);
+        atomic_store(&sub->dropped, 0);
+        atomic_store_explicit(&sub->state, SLOT_ACTIVE, memory_order_release);
+        log_msg(LOG_INFO, "Verdict subscriber connected (%s)\n", json ? "json" : "binary");
+        return;
+    }
+    log_msg(LOG_WARN, "Too many verdict subscribers (max %d)\n", MAX_SUBSCRIBERS);
+    close(fd);
+}
+
+static void close_subscriber(struct subscriber *sub) {
+    atomic_store_explicit(&sub->state, SLOT_CLOSING, memory_order_release);
+    // 等待正在入队的发布者离开
+    while (atomic_load_explicit(&sub->busy, memory_order_acquire) != 0)
+        ;
+    close(sub->fd);
+    sub->fd = -1;
+    log_msg(LOG_INFO, "Verdict subscriber disconnected, %llu records dropped\n",
+            (unsigned long long)atomic_load(&sub->dropped));
+    atomic_store_explicit(&sub->state, SLOT_FREE, memory_order_release);
+}
+
+static size_t format_record(const struct verdict_record *rec, int json, char *out, size_t out_size) {
+    if (!json) {
+        memcpy(out, rec, sizeof(*rec));
+        return sizeof(*rec);
+    }
+    int len = snprintf(out, out_size,
+                       "{\"seq\":%llu,\"dropped\":%llu,\"timestamp_ns\":%llu,\"pid\":%u,"
+                       "\"cgroup_id\":%llu,\"window\":%u,\"prediction\":%d,\"score\":[%g,%g]}\n",
+                       (unsigned long long)rec->seq, (unsigned long long)rec->dropped,
+                       (unsigned long long)rec->timestamp_ns, rec->pid,
+                       (unsigned long long)rec->cgroup_id, rec->window, rec->prediction,
+                       rec->score[0], rec->score[1]);
+    return len < (int)out_size ? (size_t)len : out_size - 1;
+}
+
+// 尽量把队列中的记录写给订阅者，套接字写满时保留进度等待下次
+static int drain_subscriber(struct subscriber *sub) {
+    for (;;) {
+        if (sub->out_off == sub->out_len) {
+            size_t tail = atomic_load_explicit(&sub->tail, memory_order_relaxed);
+            size_t head = atomic_load_explicit(&sub->head, memory_order_acquire);
+            if (tail == head)
+                return 0;
+            sub->out_len = format_record(&sub->queue[tail & (VERDICT_QUEUE_SIZE - 1)], sub->json,
+                                         sub->out, sizeof(sub->out));
+            sub->out_off = 0;
+            atomic_store_explicit(&sub->tail, tail + 1, memory_order_release);
+        }
+        ssize_t n = send(sub->fd, sub->out + sub->out_off, sub->out_len - sub->out_off, MSG_NOSIGNAL);
+        if (n < 0)
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 1 : -1;
+        sub->out_off += n;
+    }
+}
+
+static void *stream_thread(void *arg) {
+    (void)arg;
+    selfprof_thread_begin(PROF_OUTPUT);
+    struct pollfd pfds[3 + MAX_SUBSCRIBERS];
+    int slot_of[3 + MAX_SUBSCRIBERS];
+
+    while (atomic_load(&running)) {
+        int n = 0;
+        pfds[n++] = (struct pollfd){ .fd = wake_fd, .events = POLLIN };
+        for (int i = 0; i < 2; i++) {
+            if (listen_fds[i] >= 0)
+                pfds[n++] = (struct pollfd){ .fd = listen_fds[i], .events = POLLIN };
+        }
+        int first_sub = n;
+        for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+            struct subscriber *sub = &subscribers[i];
+            if (atomic_load(&sub->state) != SLOT_ACTIVE)
+                continue;
+            int pending = sub->out_off != sub->out_len ||
+                          atomic_load(&sub->head) != atomic_load(&sub->tail);
+            slot_of[n] = i;
+            // 订阅者不发数据，POLLIN 用于发现断开
+            pfds[n++] = (struct pollfd){ .fd = sub->fd, .events = POLLIN | (pending ? POLLOUT : 0) };
+        }
+
+        if (poll(pfds, n, 100) < 0 && errno != EINTR)
+            break;
+
+        if (pfds[0].revents & POLLIN) {
+            uint64_t count;
+            if (read(wake_fd, &count, sizeof(count)) < 0) {
+                // EAGAIN：已被其他事件消费
+            }
+        }
+        for (int i = 1; i < first_sub; i++) {
+            if (pfds[i].revents & POLLIN)
+                accept_subscriber(pfds[i].fd, pfds[i].fd == listen_fds[1]);
+        }
+        for (int i = first_sub; i < n; i++) {
+            struct subscriber *sub = &subscribers[slot_of[i]];
+            if (pfds[i].revents & (POLLHUP | POLLERR)) {
+                close_subscriber(sub);
+                continue;
+            }
+            if (pfds[i].revents & POLLIN) {
+                char discard[256];
+                ssize_t r = recv(sub->fd, discard, sizeof(discard), 0);
+                if (r == 0 || (r < 0 && errno != EAGAIN)) {
+                    close_subscriber(sub);
+                    continue;
+                }
+            }
+            if (drain_subscriber(sub) < 0)
+                close_subscriber(sub);
+        }
+    }
+    selfprof_thread_end();
+    return NULL;
+}
+
+int verdict_stream_start(const char *path, int json) {
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        atomic_init(&subscribers[i].state, SLOT_FREE);
+        subscribers[i].fd = -1;
+    }
+
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd == -1) {
+        perror("eventfd");
+        return -1;
+    }
+
+    snprintf(socket_paths[0], sizeof(socket_paths[0]), "%s", path);
+    listen_fds[0] = listen_unix(socket_paths[0]);
+    if (listen_fds[0] < 0)
+        goto fail;
+    if (json) {
+        snprintf(socket_paths[1], sizeof(socket_paths[1]), "%s.json", path);
+        listen_fds[1] = listen_unix(socket_paths[1]);
+        if (listen_fds[1] < 0)
+            goto fail;
+    }
+
+    atomic_store(&running, 1);
+    if (pthread_create(&stream_tid, NULL, stream_thread, NULL) != 0) {
+        fprintf(stderr, "Failed to create verdict stream thread\n");
+        atomic_store(&running, 0);
+        goto fail;
+    }
+    return 0;
+
+fail:
+    for (int i = 0; i < 2; i++) {
+        if (listen_fds[i] >= 0) {
+            close(listen_fds[i]);
+            unlink(socket_paths[i]);
+            listen_fds[i] = -1;
+        }
+    }
+    close(wake_fd);
+    wake_fd = -1;
+    return -1;
+}
+
+void verdict_stream_stop(void) {
+    if (!atomic_load(&running))
+        return;
+    atomic_store(&running, 0);
+    pthread_join(stream_tid, NULL);
+
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        if (atomic_load(&subscribers[i].state) == SLOT_ACTIVE)
+            close_subscriber(&subscribers[i]);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (listen_fds[i] >= 0) {
+            close(listen_fds[i]);
+            unlink(socket_paths[i]);
+            listen_fds[i] = -1;
+        }
+    }
+    close(wake_fd);
+    wake_fd = -1;
+}
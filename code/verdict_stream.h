@@ -0,0 +1,40 @@
+#ifndef VERDICT_STREAM_H
+#define VERDICT_STREAM_H
+
+#include <stdint.h>
+
+// 推理结果流：通过 Unix 域套接字发布给本地订阅者。
+// 每个订阅者有独立的有界队列，队列满时丢弃并计数，推理线程永不阻塞
+
+#define VERDICT_MAGIC 0x4b4c4256    // "VBLK"
+#define VERDICT_VERSION 1
+#define VERDICT_QUEUE_SIZE 256      // 每个订阅者，必须是 2 的幂
+#define MAX_SUBSCRIBERS 16
+
+// 二进制流中的定长记录（小端，按此布局直接读取）
+struct verdict_record {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;          // sizeof(struct verdict_record)
+    uint64_t seq;           // 发布序号，订阅者可据此发现缺口
+    uint64_t dropped;       // 该订阅者累计被丢弃的记录数
+    uint64_t timestamp_ns;  // CLOCK_REALTIME
+    uint64_t cgroup_id;     // 非 0 表示 cgroup 结果
+    uint32_t pid;
+    uint32_t window;        // 第几次接收
+    int32_t prediction;     // 0=良性, 1=恶意
+    float score[2];         // 模型输出
+    uint32_t reserved;      // 置 0；显式占位，记录内没有隐式填充
+};
+
+_Static_assert(sizeof(struct verdict_record) == 64, "verdict_record is a 64-byte wire format");
+
+// path 为二进制流套接字；json 非 0 时另在 path.json 上提供 JSON lines
+int verdict_stream_start(const char *path, int json);
+void verdict_stream_stop(void);
+
+// 由推理线程调用，只做入队
+void verdict_publish(uint32_t pid, uint64_t cgroup_id, uint32_t window, int prediction,
+                     const float score[2]);
+
+#endif
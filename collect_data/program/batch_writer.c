@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+#include "batch_writer.h"
+
+#define URING_ENTRIES 64
+
+struct bw_job {
+    int fd;
+    int close_fd;
+    const char *data;
+    size_t len;
+    void *release;
+};
+
+struct batch_writer {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;            // 有新数据或要求退出
+    pthread_cond_t done;            // 队列有空位或一批写完
+    struct bw_job queue[BATCH_WRITER_QUEUE];
+    size_t head, len;
+    uint64_t submitted, completed;
+    int stopping;
+    pthread_t thread;
+    struct bw_job batch[BATCH_WRITER_QUEUE];   // 只由写盘线程使用
+#ifdef HAVE_LIBURING
+    struct io_uring ring;
+    int uring;                      // 0 表示初始化失败或出错后退回 write
+#endif
+};
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            fprintf(stderr, "写入失败: %s\n", strerror(errno));
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void finish_job(struct bw_job *job) {
+    if (job->close_fd)
+        close(job->fd);
+    free(job->release);
+}
+
+#ifdef HAVE_LIBURING
+// 一批数据块链接成一条 io_uring 链，按顺序执行，一次提交。短写时链被中断，
+// 该块剩余部分和其后被取消的块按完成顺序同步补写，顺序不变
+static void write_batch_uring(struct batch_writer *w, struct bw_job *jobs, size_t n) {
+    size_t done = 0;
+    while (done < n && w->uring) {
+        size_t count = 0;
+        struct io_uring_sqe *last = NULL;
+        while (done + count < n) {
+            struct io_uring_sqe *sqe = io_uring_get_sqe(&w->ring);
+            if (!sqe)
+                break;
+            struct bw_job *job = &jobs[done + count++];
+            // 偏移 -1：从文件当前位置写，与 write 相同
+            io_uring_prep_write(sqe, job->fd, job->data, (unsigned)job->len, (uint64_t)-1);
+            io_uring_sqe_set_data(sqe, job);
+            sqe->flags |= IOSQE_IO_LINK;
+            last = sqe;
+        }
+        if (!last)
+            break;
+        last->flags &= ~IOSQE_IO_LINK;
+
+        int ret = io_uring_submit_and_wait(&w->ring, (unsigned)count);
+        if (ret < 0) {
+            fprintf(stderr, "io_uring 提交失败，改用 write: %s\n", strerror(-ret));
+            w->uring = 0;
+            break;
+        }
+        for (size_t i = 0; i < count; i++) {
+            struct io_uring_cqe *cqe;
+            if (io_uring_wait_cqe(&w->ring, &cqe) != 0)
+                break;
+            struct bw_job *job = io_uring_cqe_get_data(cqe);
+            int res = cqe->res;
+            io_uring_cqe_seen(&w->ring, cqe);
+            size_t written = res > 0 ? (size_t)res : 0;
+            if (written < job->len)
+                write_all(job->fd, job->data + written, job->len - written);
+        }
+        done += count;
+    }
+    for (; done < n; done++)
+        write_all(jobs[done].fd, jobs[done].data, jobs[done].len);
+}
+#endif
+
+static void write_batch(struct batch_writer *w, struct bw_job *jobs, size_t n) {
+#ifdef HAVE_LIBURING
+    if (w->uring) {
+        write_batch_uring(w, jobs, n);
+        return;
+    }
+#else
+    (void)w;
+#endif
+    for (size_t i = 0; i < n; i++)
+        write_all(jobs[i].fd, jobs[i].data, jobs[i].len);
+}
+
+static void *writer_thread(void *arg) {
+    struct batch_writer *w = arg;
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        while (w->len == 0 && !w->stopping)
+            pthread_cond_wait(&w->wake, &w->lock);
+        if (w->len == 0)
+            break;
+
+        // 取出队列中的全部数据块，写盘期间不持锁
+        size_t n = w->len;
+        for (size_t i = 0; i < n; i++)
+            w->batch[i] = w->queue[(w->head + i) % BATCH_WRITER_QUEUE];
+        w->head = (w->head + n) % BATCH_WRITER_QUEUE;
+        w->len = 0;
+        pthread_cond_broadcast(&w->done);
+        pthread_mutex_unlock(&w->lock);
+
+        write_batch(w, w->batch, n);
+        for (size_t i = 0; i < n; i++)
+            finish_job(&w->batch[i]);
+
+        pthread_mutex_lock(&w->lock);
+        w->completed += n;
+        pthread_cond_broadcast(&w->done);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+struct batch_writer *batch_writer_create(void) {
+    struct batch_writer *w = calloc(1, sizeof(*w));
+    if (!w) {
+        perror("calloc");
+        return NULL;
+    }
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->wake, NULL);
+    pthread_cond_init(&w->done, NULL);
+#ifdef HAVE_LIBURING
+    int ret = io_uring_queue_init(URING_ENTRIES, &w->ring, 0);
+    if (ret < 0)
+        fprintf(stderr, "io_uring 不可用，改用 write: %s\n", strerror(-ret));
+    w->uring = ret == 0;
+#endif
+    if (pthread_create(&w->thread, NULL, writer_thread, w) != 0) {
+        perror("pthread_create");
+#ifdef HAVE_LIBURING
+        if (w->uring)
+            io_uring_queue_exit(&w->ring);
+#endif
+        free(w);
+        return NULL;
+    }
+    return w;
+}
+
+void batch_writer_destroy(struct batch_writer *w) {
+    if (!w)
+        return;
+    pthread_mutex_lock(&w->lock);
+    w->stopping = 1;
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->thread, NULL);
+#ifdef HAVE_LIBURING
+    if (w->uring)
+        io_uring_queue_exit(&w->ring);
+#endif
+    pthread_cond_destroy(&w->wake);
+    pthread_cond_destroy(&w->done);
+    pthread_mutex_destroy(&w->lock);
+    free(w);
+}
+
+int batch_writer_submit(struct batch_writer *w, int fd, const char *data, size_t len, void *release,
+                        int close_fd) {
+    struct bw_job job = { .fd = fd, .close_fd = close_fd, .data = data, .len = len, .release = release };
+    if (!w) {
+        int ret = write_all(fd, data, len);
+        finish_job(&job);
+        return ret;
+    }
+    pthread_mutex_lock(&w->lock);
+    while (w->len == BATCH_WRITER_QUEUE)
+        pthread_cond_wait(&w->done, &w->lock);
+    w->queue[(w->head + w->len) % BATCH_WRITER_QUEUE] = job;
+    w->len++;
+    w->submitted++;
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+    return 0;
+}
+
+void batch_writer_drain(struct batch_writer *w) {
+    if (!w)
+        return;
+    pthread_mutex_lock(&w->lock);
+    uint64_t target = w->submitted;
+    while (w->completed < target)
+        pthread_cond_wait(&w->done, &w->lock);
+    pthread_mutex_unlock(&w->lock);
+}
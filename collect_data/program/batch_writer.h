@@ -0,0 +1,28 @@
+#ifndef BATCH_WRITER_H
+#define BATCH_WRITER_H
+
+#include <stddef.h>
+
+// 进程内一个写盘线程。采集线程把格式化好的数据块交给它，不在采样循环里做任何 I/O；
+// 写盘线程每次取出队列中的全部数据块一起写。编译时定义 HAVE_LIBURING 则一批数据块
+// 用一次 io_uring 提交（按提交顺序链接执行），否则逐块 write。
+// 同一 fd 的数据块按提交顺序写入。
+
+#define BATCH_WRITER_QUEUE 1024     // 队列满时提交者等待
+
+struct batch_writer;
+
+struct batch_writer *batch_writer_create(void);
+// 写完队列中的全部数据后结束写盘线程
+void batch_writer_destroy(struct batch_writer *w);
+
+// 提交 [data, data+len)，写完之前调用者不能修改这段内存。
+// release 非空时写完后 free(release)；close_fd 非 0 时写完后关闭 fd。
+// w 为 NULL 时在调用线程中同步完成
+int batch_writer_submit(struct batch_writer *w, int fd, const char *data, size_t len, void *release,
+                        int close_fd);
+
+// 等待此前提交的数据全部写完
+void batch_writer_drain(struct batch_writer *w);
+
+#endif // BATCH_WRITER_H
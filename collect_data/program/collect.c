@@ -11,44 +11,36 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
+#include <limits.h>
+#include <pthread.h>
 #include "perf_monitor.h"
+#include "proc_reader.h"
+#include "batch_writer.h"
+#include "collect.h"
 
-#define TOTAL_EVENTS 4
 #define SAMPLE_INTERVAL_MS 10
-#define TOTAL_SAMPLES 1000
 #define PRINT_EVERY 500
+#define CSV_BATCH_ROWS 100      // 每 100 行（1 秒）交给写盘线程一次
 
-typedef struct {
-    const char *name;
-    __u32 type;
-    __u64 config;
-} EventDef;
-
-static const EventDef default_events[TOTAL_EVENTS] = {
-    { "branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
-    { "cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
-    { "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
-    { "bus-cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BUS_CYCLES },
-};
+// 所有采集线程共用一个写盘线程，第一次输出时创建；创建失败时为 NULL，退回同步写
+static struct batch_writer *output_writer;
+static pthread_once_t output_writer_once = PTHREAD_ONCE_INIT;
 
-int parse_event(const char *name, __u32 *type, __u64 *config) {
-    if (strcmp(name, "branches") == 0) {
-        *type = PERF_TYPE_HARDWARE;
-        *config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
-    } else if (strcmp(name, "cache-references") == 0) {
-        *type = PERF_TYPE_HARDWARE;
-        *config = PERF_COUNT_HW_CACHE_REFERENCES;
-    } else if (strcmp(name, "cache-misses") == 0) {
-        *type = PERF_TYPE_HARDWARE;
-        *config = PERF_COUNT_HW_CACHE_MISSES;
-    } else if (strcmp(name, "bus-cycles") == 0) {
-        *type = PERF_TYPE_HARDWARE;
-        *config = PERF_COUNT_HW_BUS_CYCLES;
-    } else {
-        fprintf(stderr, "不支持的事件名称: %s\n", name);
-        return -1;
-    }
-    return 0;
+static void output_writer_init(void) {
+    output_writer = batch_writer_create();
+}
+
+// 十进制格式化，返回长度，不补 '\0'
+static size_t format_u64(char *p, uint64_t v) {
+    char tmp[20];
+    size_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    for (size_t i = 0; i < n; i++)
+        p[i] = tmp[n - 1 - i];
+    return n;
 }
 
 struct perf_event_attr create_event_attr(__u32 type, __u64 config) {
@@ -62,37 +54,82 @@ struct perf_event_attr create_event_attr(__u32 type, __u64 config) {
     return attr;
 }
 
-void collect_perf_events(int target_pid, const char *events[4], const char *sample_dir) {
-    PerformanceMonitor* monitor = perf_monitor_create(1000);
-    if (!monitor) {
-        fprintf(stderr, "创建性能监控器失败\n");
-        return;
+static const char *resource_names[RESOURCE_COLUMNS] = {
+    "proc_cpu_us", "proc_minflt", "proc_majflt", "proc_rss_kb",
+};
+
+int collect_columns(const struct event_set *events, int resources, struct event_set *columns) {
+    *columns = *events;
+    if (!resources)
+        return 0;
+    if (events->count + RESOURCE_COLUMNS > MAX_EVENTS) {
+        fprintf(stderr, "记录资源列时最多 %d 个事件\n", MAX_EVENTS - RESOURCE_COLUMNS);
+        return -1;
     }
-    perf_monitor_start(monitor);
-
-    int fds[TOTAL_EVENTS];
-    uint64_t values[TOTAL_EVENTS][TOTAL_SAMPLES] = {0};
-    const char *used_names[TOTAL_EVENTS];
-    __u32 types[TOTAL_EVENTS];
-    __u64 configs[TOTAL_EVENTS];
-
-    for (int i = 0; i < TOTAL_EVENTS; i++) {
-        if (!events || !events[i]) {
-            types[i] = default_events[i].type;
-            configs[i] = default_events[i].config;
-            used_names[i] = default_events[i].name;
-        } else {
-            if (parse_event(events[i], &types[i], &configs[i]) != 0) {
-                perf_monitor_destroy(monitor);
-                return;
-            }
-            used_names[i] = events[i];
+    for (int i = 0; i < RESOURCE_COLUMNS; i++) {
+        EventDef *ev = &columns->events[columns->count++];
+        memset(ev, 0, sizeof(*ev));
+        snprintf(ev->name, sizeof(ev->name), "%s", resource_names[i]);
+    }
+    return 0;
+}
+
+void collect_perf_events(int target_pid, const struct event_set *events,
+                         const struct collect_output *out, int total_samples, int monitor_usage) {
+    const char *sample_dir = out->dir;
+    struct event_set fallback;
+    if (!events) {
+        event_set_default(&fallback);
+        events = &fallback;
+    }
+    int n = events->count;
+    int columns = n;
+    if (out->resources) {
+        if (n + RESOURCE_COLUMNS > MAX_EVENTS) {
+            fprintf(stderr, "记录资源列时最多 %d 个事件\n", MAX_EVENTS - RESOURCE_COLUMNS);
+            return;
         }
+        columns = n + RESOURCE_COLUMNS;
+    }
+
+    if (total_samples <= 0 || total_samples > TOTAL_SAMPLES)
+        total_samples = TOTAL_SAMPLES;
 
-        struct perf_event_attr attr = create_event_attr(types[i], configs[i]);
+    PerformanceMonitor* monitor = NULL;
+    if (monitor_usage) {
+        monitor = perf_monitor_create_pid(target_pid, SAMPLE_INTERVAL_MS);
+        if (!monitor) {
+            fprintf(stderr, "创建性能监控器失败\n");
+            return;
+        }
+        perf_monitor_start(monitor);
+    }
+
+    int fds[MAX_EVENTS];
+    uint64_t values[MAX_EVENTS][TOTAL_SAMPLES] = {0};
+    const char *used_names[MAX_EVENTS];
+    for (int i = 0; i < columns - n; i++)
+        used_names[n + i] = resource_names[i];
+
+    // 目标进程的 /proc 文件在采集期间保持打开，每行用 pread 读取
+    struct proc_reader proc;
+    proc.count = 0;
+    proc.sys_fd = -1;
+    if (out->resources && (proc_reader_init(&proc) != 0 || proc_reader_add(&proc, target_pid) < 0)) {
+        proc_reader_close(&proc);
+        perf_monitor_destroy(monitor);
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        used_names[i] = events->events[i].name;
+        struct perf_event_attr attr = create_event_attr(events->events[i].type, events->events[i].config);
         fds[i] = syscall(__NR_perf_event_open, &attr, target_pid, -1, -1, 0);
         if (fds[i] == -1) {
             fprintf(stderr, "perf_event_open 失败 for %s: %s\n", used_names[i], strerror(errno));
+            while (--i >= 0)
+                close(fds[i]);
+            proc_reader_close(&proc);
             perf_monitor_destroy(monitor);
             return;
         }
@@ -101,85 +138,155 @@ void collect_perf_events(int target_pid, const char *events[4], const char *samp
         ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
     }
 
-    // 创建样本子目录
-    if (mkdir(sample_dir, 0755) == -1 && errno != EEXIST) {
+    // 创建样本子目录（写入数据集时不需要 CSV，只在记录资源占用时用到）
+    if ((!out->dataset || monitor) && mkdir(sample_dir, 0755) == -1 && errno != EEXIST) {
         fprintf(stderr, "创建样本目录 %s 失败: %s\n", sample_dir, strerror(errno));
-        for (int i = 0; i < TOTAL_EVENTS; i++) {
+        for (int i = 0; i < n; i++) {
             ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
             close(fds[i]);
         }
+        proc_reader_close(&proc);
         perf_monitor_destroy(monitor);
         return;
     }
 
-    // 性能计数器数据文件名
-    char filename[128];
+    pthread_once(&output_writer_once, output_writer_init);
+
+    // 性能计数器数据文件名。CSV 在预先分配的缓冲区中格式化（表头加 total_samples 行的上限），
+    // 每 CSV_BATCH_ROWS 行把新增部分交给写盘线程，采样循环中没有 I/O
+    char filename[PATH_MAX];
     snprintf(filename, sizeof(filename), "%s/perf_output_%d.csv", sample_dir, target_pid);
-    FILE *fp = fopen(filename, "w");
-    if (!fp) {
-        fprintf(stderr, "打开文件 %s 失败: %s\n", filename, strerror(errno));
-        for (int i = 0; i < TOTAL_EVENTS; i++) {
-            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
-            close(fds[i]);
+    int csv_fd = -1;
+    char *csv = NULL;
+    size_t csv_len = 0, csv_flushed = 0;
+    if (!out->dataset) {
+        size_t capacity = 8 + (size_t)columns * EVENT_NAME_LEN + (size_t)total_samples * (12 + (size_t)columns * 21);
+        csv_fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        csv = csv_fd >= 0 ? malloc(capacity) : NULL;
+        if (!csv) {
+            fprintf(stderr, "打开文件 %s 失败: %s\n", filename, strerror(errno));
+            if (csv_fd >= 0)
+                close(csv_fd);
+            for (int i = 0; i < n; i++) {
+                ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                close(fds[i]);
+            }
+            proc_reader_close(&proc);
+            perf_monitor_destroy(monitor);
+            return;
         }
-        perf_monitor_destroy(monitor);
-        return;
+        csv_len = (size_t)sprintf(csv, "sample");
+        for (int i = 0; i < columns; i++)
+            csv_len += (size_t)sprintf(csv + csv_len, ",%s", used_names[i]);
+        csv[csv_len++] = '\n';
     }
 
-    fprintf(fp, "sample");
-    for (int i = 0; i < TOTAL_EVENTS; i++) {
-        fprintf(fp, ",%s", used_names[i]);
-    }
-    fprintf(fp, "\n");
+    // 进度行同样预先分配，每行占独立的一段，交给写盘线程后不再改动；分配失败时不输出进度
+    size_t progress_size = 64 + (size_t)columns * (EVENT_NAME_LEN + 22);
+    char *progress = malloc((size_t)(total_samples / PRINT_EVERY + 1) * progress_size);
 
-    uint64_t prev_values[TOTAL_EVENTS] = {0};
+    uint64_t prev_values[MAX_EVENTS] = {0};
+    struct proc_stat prev_stat = {0};
+    int proc_alive = out->resources;
+    int rows = 0;
 
-    for (int sample = 0; sample < TOTAL_SAMPLES; sample++) {
-        usleep(SAMPLE_INTERVAL_MS * 1000);
-        uint64_t current_values[TOTAL_EVENTS];
+    // 按绝对时间睡眠，读计数器和格式化的耗时不累积到采样间隔上
+    struct timespec next_tick;
+    clock_gettime(CLOCK_MONOTONIC, &next_tick);
 
-        for (int i = 0; i < TOTAL_EVENTS; i++) {
+    for (int sample = 0; sample < total_samples; sample++, rows++) {
+        next_tick.tv_nsec += SAMPLE_INTERVAL_MS * 1000000L;
+        if (next_tick.tv_nsec >= 1000000000L) {
+            next_tick.tv_sec++;
+            next_tick.tv_nsec -= 1000000000L;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next_tick, NULL) == EINTR)
+            ;
+        uint64_t current_values[MAX_EVENTS];
+
+        int failed = 0;
+        for (int i = 0; i < n && !failed; i++) {
             ssize_t ret = read(fds[i], &current_values[i], sizeof(current_values[i]));
             if (ret != sizeof(current_values[i])) {
                 fprintf(stderr, "读取性能事件 %s 失败: %s\n", used_names[i], strerror(errno));
-                fclose(fp);
-                for (int j = 0; j < TOTAL_EVENTS; j++) {
-                    ioctl(fds[j], PERF_EVENT_IOC_DISABLE, 0);
-                    close(fds[j]);
-                }
-                perf_monitor_destroy(monitor);
-                return;
+                failed = 1;
             }
         }
+        // 已采集的行照常保存
+        if (failed)
+            break;
 
-        fprintf(fp, "%d", sample);
-        for (int i = 0; i < TOTAL_EVENTS; i++) {
+        for (int i = 0; i < n; i++) {
             uint64_t delta = sample == 0 ? 0 : current_values[i] - prev_values[i];
             values[i][sample] = delta;
             prev_values[i] = current_values[i];
-            fprintf(fp, ",%" PRIu64, delta);
         }
-        fprintf(fp, "\n");
+        // 进程退出后资源列为 0，与计数器不再增长一致
+        struct proc_stat st;
+        if (proc_alive && proc_reader_read(&proc, 0, &st) == 0) {
+            if (sample > 0) {
+                values[n][sample] = (st.cpu_ns - prev_stat.cpu_ns) / 1000;
+                values[n + 1][sample] = st.minflt - prev_stat.minflt;
+                values[n + 2][sample] = st.majflt - prev_stat.majflt;
+            }
+            values[n + 3][sample] = st.rss_kb;
+            prev_stat = st;
+        } else {
+            proc_alive = 0;
+        }
+        if (csv) {
+            csv_len += format_u64(csv + csv_len, (uint64_t)sample);
+            for (int i = 0; i < columns; i++) {
+                csv[csv_len++] = ',';
+                csv_len += format_u64(csv + csv_len, values[i][sample]);
+            }
+            csv[csv_len++] = '\n';
+            if ((sample + 1) % CSV_BATCH_ROWS == 0) {
+                batch_writer_submit(output_writer, csv_fd, csv + csv_flushed, csv_len - csv_flushed, NULL, 0);
+                csv_flushed = csv_len;
+            }
+        }
 
-        if ((sample + 1) % PRINT_EVERY == 0) {
+        // 进度只输出每列的合计，同样交给写盘线程，不阻塞采样
+        if (progress && (sample + 1) % PRINT_EVERY == 0) {
             int start = sample + 1 - PRINT_EVERY;
-            printf("\n[PID: %d] 样本 %d–%d:\n", target_pid, start, sample);
-            for (int i = 0; i < TOTAL_EVENTS; i++) {
-                printf("事件: %-20s\n", used_names[i]);
-                for (int j = start; j <= sample; j++) {
-                    printf("  [%02d] %" PRIu64 "\t", j, values[i][j]);
-                }
-                printf("\n");
+            char *line = progress + (size_t)(sample / PRINT_EVERY) * progress_size;
+            int len = sprintf(line, "[PID: %d] 样本 %d–%d:", target_pid, start, sample);
+            for (int i = 0; i < columns; i++) {
+                uint64_t sum = 0;
+                for (int j = start; j <= sample; j++)
+                    sum += values[i][j];
+                // proc_rss_kb 不是增量，取最后一行
+                if (out->resources && i == columns - 1)
+                    sum = values[i][sample];
+                len += sprintf(line + len, " %s=%" PRIu64, used_names[i], sum);
             }
+            line[len++] = '\n';
+            batch_writer_submit(output_writer, STDOUT_FILENO, line, (size_t)len, NULL, 0);
         }
     }
 
-    fclose(fp);
-
-    for (int i = 0; i < TOTAL_EVENTS; i++) {
+    for (int i = 0; i < n; i++) {
         ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
         close(fds[i]);
     }
+    proc_reader_close(&proc);
+
+    // 剩余部分写完后由写盘线程释放缓冲区并关闭文件。采样已结束，在这里等它写完，
+    // 返回时文件已完整（作业按采集线程全部返回判断完成）
+    if (csv) {
+        batch_writer_submit(output_writer, csv_fd, csv + csv_flushed, csv_len - csv_flushed, csv, 1);
+        batch_writer_drain(output_writer);
+    } else if (rows > 0)
+        kds_append(out->dataset, out->sample_id, out->attempt, target_pid, out->hash, &values[0][0], TOTAL_SAMPLES, rows);
+    if (progress) {
+        if (!csv)
+            batch_writer_drain(output_writer);
+        free(progress);
+    }
+
+    if (!monitor)
+        return;
 
     // 性能监控数据文件名
     time_t now = time(NULL);
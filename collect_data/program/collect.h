@@ -1,6 +1,38 @@
 #ifndef COLLECT_H
 #define COLLECT_H
 
-void collect_perf_events(int target_pid, const char *events[4], const char *sample_dir);
+#include <stdint.h>
+#include "event_set.h"
+#include "dataset.h"
+
+#define TOTAL_SAMPLES 1000
+
+// 目标进程的资源列（来自 /proc/<pid>/stat 和 schedstat），每行与计数器同一时刻读取：
+//   proc_cpu_us   本行 CPU 时间增量（微秒）
+//   proc_minflt   本行次缺页数
+//   proc_majflt   本行主缺页数
+//   proc_rss_kb   常驻内存（KB）
+#define RESOURCE_COLUMNS 4
+
+// 采集结果的去向：dataset 非空时追加到数据集文件（一个分块），
+// 否则在 dir 下写 perf_output_<pid>.csv
+struct collect_output {
+    const char *dir;
+    struct kds_writer *dataset;
+    uint32_t sample_id;
+    uint8_t attempt;            // 第几次采集该样本（样本库的 attempts），写入分块供读取端去掉中断的尝试
+    const uint8_t *hash;        // 样本哈希（KDS_HASH_LEN 字节），未知为 NULL
+    int resources;              // 非 0 时在事件列之后追加 RESOURCE_COLUMNS 个资源列
+};
+
+// 输出的列：事件列，resources 非 0 时再加资源列。写数据集时用作 kds_writer_open 的列名。
+// 总列数超过 MAX_EVENTS 时返回 -1
+int collect_columns(const struct event_set *events, int resources, struct event_set *columns);
+
+// events 为 NULL 时使用默认事件集；每 10ms 采样一次，共 total_samples 次。
+// CSV 由进程内共用的写盘线程分批写入，返回时已写完。
+// monitor_usage 非 0 时同时以同样的间隔记录目标进程的资源占用，保存到 out->dir 下的 usage_*.csv
+void collect_perf_events(int target_pid, const struct event_set *events,
+                         const struct collect_output *out, int total_samples, int monitor_usage);
 
 #endif // COLLECT_H
@@ -0,0 +1,531 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <bpf/libbpf.h>
+#include <bpf/bpf.h>
+#include "program_a_bpf.skel.h"
+#include "collect.h"
+#include "sample_job.h"
+
+// 常驻采集服务：BPF 程序、perf buffer 和事件集只准备一次，通过本地套接字接受
+// "运行样本 X，数据写到 Y" 的作业。每个作业放在独立的 cgroup 中（-P 时改为进程组），
+// execve 事件按 cgroup 或父进程链归到作业，不再依赖全局的样本目录。
+//
+// 协议（按行，路径不能包含空白）：
+//   RUN <样本路径> <数据目录> [超时ms] [采样行数]
+//     -> OK <作业号>              作业开始（或排队）
+//     -> DONE <作业号> processes=<N> elapsed_ms=<MS> timed_out=<0|1>
+//     -> ERR <原因>
+//   STATUS -> STATUS running=<N> queued=<N> completed=<N>
+
+#define DEFAULT_SOCKET "/run/kleb_collect.sock"
+#define DEFAULT_CGROUP_BASE SAMPLE_CGROUP_ROOT "/kleb_collect"
+#define MAX_JOBS 256
+#define MAX_CLIENTS 32
+#define MAX_PENDING 256
+#define LINE_MAX_LEN 1024
+#define POLL_MS 10
+
+struct client {
+    int fd;                     // -1 表示空闲
+    unsigned int generation;    // 槽位复用后旧作业不再回复
+    char buf[LINE_MAX_LEN];
+    size_t len;
+};
+
+// 作业的请求方，与 jobs[] 下标对应
+struct job_owner {
+    int client;
+    unsigned int generation;
+};
+
+struct pending_job {
+    int id;
+    struct job_owner owner;
+    int timeout_ms;
+    int rows;
+    char sample_path[PATH_MAX];
+    char data_dir[PATH_MAX];
+};
+
+static volatile sig_atomic_t exiting = 0;
+static struct event_set active_events;
+static struct sample_job jobs[MAX_JOBS];
+static struct job_owner owners[MAX_JOBS];
+static int job_limit;
+static struct client clients[MAX_CLIENTS];
+static struct pending_job pending[MAX_PENDING];
+static size_t pending_head, pending_len;
+static const char *cgroup_base = DEFAULT_CGROUP_BASE;
+static int use_cgroup = 1, pin = 0, resources = 0;
+static struct kds_writer *dataset;
+static uint8_t *hashes;
+static uint32_t mapped;
+static int default_timeout_ms = 1000, default_rows = 10;
+static int next_id = 1, completed = 0;
+
+static void handle_signal(int sig) {
+    exiting = 1;
+}
+
+static void reply(const struct job_owner *owner, const char *fmt, ...) {
+    struct client *c = &clients[owner->client];
+    if (c->fd < 0 || c->generation != owner->generation)
+        return;
+    char line[LINE_MAX_LEN];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (len >= (int)sizeof(line))
+        len = sizeof(line) - 1;
+    // 回复很短，写不下说明客户端已不读取，直接断开
+    if (send(c->fd, line, len, MSG_NOSIGNAL | MSG_DONTWAIT) != len) {
+        close(c->fd);
+        c->fd = -1;
+    }
+}
+
+static void handle_event(void *ctx, int cpu, void *data, __u32 data_sz) {
+    if (data_sz < sizeof(struct sample_exec_event))
+        return;
+    const struct sample_exec_event *event = data;
+    struct sample_job *job = sample_job_find(jobs, job_limit, event);
+    if (job)
+        sample_job_collect(job, event->pid, &active_events);
+}
+
+static void handle_lost(void *ctx, int cpu, __u64 cnt) {
+    fprintf(stderr, "警告：CPU %d 丢失 %llu 个 execve 事件\n", cpu, (unsigned long long)cnt);
+}
+
+static int running_jobs(void) {
+    int n = 0;
+    for (int i = 0; i < job_limit; i++)
+        n += jobs[i].state != JOB_FREE;
+    return n;
+}
+
+// 语料库中的样本以样本号命名（rename.py），其他样本用作业号
+static uint32_t sample_id_for(const char *path, int job_id) {
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    char *end;
+    unsigned long id = strtoul(name, &end, 10);
+    return end != name && *end == '\0' ? id : (uint32_t)job_id;
+}
+
+// 把排队的作业放到空闲槽位上
+static void start_pending(void) {
+    for (int i = 0; i < job_limit && pending_len > 0; i++) {
+        if (jobs[i].state != JOB_FREE)
+            continue;
+        struct pending_job *p = &pending[pending_head];
+        pending_head = (pending_head + 1) % MAX_PENDING;
+        pending_len--;
+
+        struct sample_job *job = &jobs[i];
+        char name[32];
+        snprintf(name, sizeof(name), "job_%d", p->id);
+        job->id = p->id;
+        job->cpu = pin ? i % sysconf(_SC_NPROCESSORS_ONLN) : -1;
+        job->rows = p->rows;
+        job->timeout_ms = p->timeout_ms;
+        job->dataset = dataset;
+        job->resources = resources;
+        job->sample_id = sample_id_for(p->sample_path, p->id);
+        job->attempt = 0;
+        job->hash = job->sample_id < mapped ? hashes + (size_t)job->sample_id * KDS_HASH_LEN : NULL;
+        owners[i] = p->owner;
+        if (sample_job_start(job, use_cgroup ? cgroup_base : NULL, name, p->sample_path,
+                             p->data_dir) != 0) {
+            reply(&p->owner, "ERR %d 无法启动样本\n", p->id);
+            i--;
+            continue;
+        }
+        printf("作业 %d 开始: %s -> %s\n", p->id, p->sample_path, p->data_dir);
+    }
+}
+
+static void service_jobs(void) {
+    sample_jobs_reap(jobs, job_limit);
+    for (int i = 0; i < job_limit; i++) {
+        struct sample_job *job = &jobs[i];
+        if (job->state == JOB_FREE || !sample_job_service(job, exiting))
+            continue;
+        completed++;
+        printf("作业 %d 完成：%d 个进程，%ld ms%s\n", job->id, job->processes,
+               sample_job_elapsed_ms(job), job->timed_out ? "（超时终止）" : "");
+        reply(&owners[i], "DONE %d processes=%d elapsed_ms=%ld timed_out=%d\n", job->id,
+              job->processes, sample_job_elapsed_ms(job), job->timed_out);
+    }
+}
+
+static void handle_request(int client, char *line) {
+    struct job_owner owner = { client, clients[client].generation };
+    char cmd[16];
+    if (sscanf(line, "%15s", cmd) != 1)
+        return;
+    if (strcmp(cmd, "STATUS") == 0) {
+        reply(&owner, "STATUS running=%d queued=%zu completed=%d\n", running_jobs(), pending_len,
+              completed);
+        return;
+    }
+    if (strcmp(cmd, "RUN") != 0) {
+        reply(&owner, "ERR 未知命令 %s\n", cmd);
+        return;
+    }
+
+    struct pending_job p = { .owner = owner, .timeout_ms = default_timeout_ms, .rows = default_rows };
+    char sample_path[PATH_MAX], data_dir[PATH_MAX];
+    int fields = sscanf(line, "RUN %4095s %4095s %d %d", sample_path, data_dir, &p.timeout_ms, &p.rows);
+    if (fields < 2 || p.timeout_ms <= 0 || p.rows <= 0 || p.rows > TOTAL_SAMPLES) {
+        reply(&owner, "ERR 用法: RUN <样本路径> <数据目录> [超时ms] [采样行数]\n");
+        return;
+    }
+    if (access(sample_path, X_OK) != 0) {
+        reply(&owner, "ERR 样本 %s 不存在或不可执行\n", sample_path);
+        return;
+    }
+    if (pending_len == MAX_PENDING) {
+        reply(&owner, "ERR 排队作业已满\n");
+        return;
+    }
+    strcpy(p.sample_path, sample_path);
+    strcpy(p.data_dir, data_dir);
+    p.id = next_id++;
+    pending[(pending_head + pending_len) % MAX_PENDING] = p;
+    pending_len++;
+    reply(&owner, "OK %d\n", p.id);
+}
+
+static void read_client(int client) {
+    struct client *c = &clients[client];
+    ssize_t n = recv(c->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len, MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+        close(c->fd);
+        c->fd = -1;
+        return;
+    }
+    if (n < 0)
+        return;
+    c->len += n;
+    c->buf[c->len] = '\0';
+
+    char *line = c->buf, *nl;
+    while (c->fd >= 0 && (nl = strchr(line, '\n'))) {
+        *nl = '\0';
+        handle_request(client, line);
+        line = nl + 1;
+    }
+    if (c->fd < 0)
+        return;
+    c->len -= line - c->buf;
+    memmove(c->buf, line, c->len);
+    if (c->len == sizeof(c->buf) - 1) {
+        struct job_owner owner = { client, c->generation };
+        reply(&owner, "ERR 请求过长\n");
+        c->len = 0;
+    }
+}
+
+static void accept_client(int listen_fd) {
+    int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd == -1)
+        return;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0)
+            continue;
+        clients[i].fd = fd;
+        clients[i].generation++;
+        clients[i].len = 0;
+        return;
+    }
+    fprintf(stderr, "客户端过多（最多 %d）\n", MAX_CLIENTS);
+    close(fd);
+}
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "套接字路径过长: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror("socket");
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, 16) == -1) {
+        fprintf(stderr, "无法监听 %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    // 作业以本服务的权限运行样本，只允许属主连接
+    chmod(path, 0600);
+    return fd;
+}
+
+// 客户端模式：提交一个作业并等待完成，供脚本调用
+static int submit(const char *socket_path, int argc, char **argv) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        fprintf(stderr, "无法连接 %s: %s\n", socket_path, strerror(errno));
+        return 1;
+    }
+    char line[LINE_MAX_LEN];
+    int len = snprintf(line, sizeof(line), "RUN");
+    for (int i = 0; i < argc && len < (int)sizeof(line); i++)
+        len += snprintf(line + len, sizeof(line) - len, " %s", argv[i]);
+    if (len >= (int)sizeof(line) - 1) {
+        fprintf(stderr, "请求过长\n");
+        close(fd);
+        return 1;
+    }
+    line[len++] = '\n';
+    if (write(fd, line, len) != len) {
+        perror("write");
+        close(fd);
+        return 1;
+    }
+
+    FILE *in = fdopen(fd, "r");
+    int ret = 1;
+    while (in && fgets(line, sizeof(line), in)) {
+        fputs(line, stdout);
+        if (strncmp(line, "DONE ", 5) == 0) {
+            ret = 0;
+            break;
+        }
+        if (strncmp(line, "ERR ", 4) == 0)
+            break;
+    }
+    if (in)
+        fclose(in);
+    else
+        close(fd);
+    return ret;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "用法: %s [-l 套接字] [-j 并发数] [-t 超时ms] [-r 采样行数] [-C] [-P]\n"
+            "          [-g cgroup目录] [-e 事件列表 | -E 事件文件] [-U]\n"
+            "      %s -s [-l 套接字] <样本路径> <数据目录> [超时ms] [采样行数]\n"
+            "  -l PATH  监听的 UNIX 套接字（默认 " DEFAULT_SOCKET "）\n"
+            "  -j N     同时运行的作业数（默认 CPU 数），其余排队\n"
+            "  -t MS    作业默认运行上限（默认 1000）\n"
+            "  -r ROWS  作业默认采集行数，每行 10ms（默认 10）\n"
+            "  -C       每个作业绑定到独立的 CPU\n"
+            "  -P       不使用 cgroup，按父进程链把进程归到作业\n"
+            "  -U       每行在计数器之后追加进程的资源列（CPU 时间、缺页、RSS），事件最多 4 个\n"
+            "  -g DIR   作业 cgroup 的父目录（默认 " DEFAULT_CGROUP_BASE "）\n"
+            "  -D FILE  所有作业写入同一个列式数据集文件（.kds），数据目录只用于资源占用记录\n"
+            "  -z CODEC 数据集压缩方式 none / zstd / lz4\n"
+            "  -M FILE  md5_mapping.txt，按样本号把哈希写入数据集\n"
+            "  -s       客户端模式：提交一个作业并等待完成\n",
+            prog, prog);
+}
+
+int main(int argc, char **argv) {
+    const char *event_list = NULL, *event_file = NULL, *socket_path = DEFAULT_SOCKET;
+    const char *dataset_path = NULL, *mapping_path = NULL;
+    int codec = KDS_CODEC_NONE;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int client_mode = 0;
+    job_limit = ncpu > 0 ? (ncpu < MAX_JOBS ? ncpu : MAX_JOBS) : 4;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:j:t:r:CPg:e:E:UD:z:M:sh")) != -1) {
+        switch (opt) {
+        case 'l':
+            socket_path = optarg;
+            break;
+        case 'j':
+            job_limit = atoi(optarg);
+            break;
+        case 't':
+            default_timeout_ms = atoi(optarg);
+            break;
+        case 'r':
+            default_rows = atoi(optarg);
+            break;
+        case 'C':
+            pin = 1;
+            break;
+        case 'D':
+            dataset_path = optarg;
+            break;
+        case 'z':
+            if ((codec = kds_codec_parse(optarg)) < 0)
+                return 1;
+            break;
+        case 'M':
+            mapping_path = optarg;
+            break;
+        case 'P':
+            use_cgroup = 0;
+            break;
+        case 'g':
+            cgroup_base = optarg;
+            break;
+        case 'e':
+            event_list = optarg;
+            break;
+        case 'E':
+            event_file = optarg;
+            break;
+        case 'U':
+            resources = 1;
+            break;
+        case 's':
+            client_mode = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (client_mode) {
+        if (argc - optind < 2 || argc - optind > 4) {
+            usage(argv[0]);
+            return 1;
+        }
+        return submit(socket_path, argc - optind, argv + optind);
+    }
+    if (optind != argc || job_limit <= 0 || job_limit > MAX_JOBS || default_timeout_ms <= 0 ||
+        default_rows <= 0 || default_rows > TOTAL_SAMPLES) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (event_list) {
+        if (event_set_parse(&active_events, event_list) != 0)
+            return 1;
+    } else if (event_file) {
+        if (event_set_load(&active_events, event_file) != 0)
+            return 1;
+    } else {
+        event_set_default(&active_events);
+    }
+    struct event_set columns;
+    if (collect_columns(&active_events, resources, &columns) != 0)
+        return 1;
+    if (use_cgroup && sample_cgroup_base(cgroup_base, pin) != 0)
+        return 1;
+    if (mapping_path && !(hashes = kds_mapping_load(mapping_path, &mapped)))
+        return 1;
+    if (dataset_path && !(dataset = kds_writer_open(dataset_path, &columns, codec)))
+        return 1;
+    for (int i = 0; i < MAX_CLIENTS; i++)
+        clients[i].fd = -1;
+
+    struct rlimit rlim = {RLIM_INFINITY, RLIM_INFINITY};
+    setrlimit(RLIMIT_MEMLOCK, &rlim);
+
+    struct program_a_bpf *skel = program_a_bpf__open_and_load();
+    if (!skel) {
+        fprintf(stderr, "无法打开和加载 BPF 框架\n");
+        return 1;
+    }
+    if (program_a_bpf__attach(skel)) {
+        fprintf(stderr, "无法附加 BPF 程序\n");
+        program_a_bpf__destroy(skel);
+        return 1;
+    }
+    struct perf_buffer_opts opts = { .sample_cb = handle_event, .lost_cb = handle_lost };
+    struct perf_buffer *pb = perf_buffer__new(bpf_map__fd(skel->maps.events), 64, &opts);
+    if (!pb) {
+        fprintf(stderr, "无法创建性能缓冲区\n");
+        program_a_bpf__destroy(skel);
+        return 1;
+    }
+    int listen_fd = listen_unix(socket_path);
+    if (listen_fd < 0) {
+        perf_buffer__free(pb);
+        program_a_bpf__destroy(skel);
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+    signal(SIGPIPE, SIG_IGN);
+    printf("采集服务已启动，监听 %s，并发 %d，按%s归属进程\n", socket_path, job_limit,
+           use_cgroup ? " cgroup " : "父进程");
+
+    struct pollfd pfds[2 + MAX_CLIENTS];
+    int client_of[2 + MAX_CLIENTS];
+    for (;;) {
+        int n = 0;
+        pfds[n++] = (struct pollfd){ .fd = perf_buffer__epoll_fd(pb), .events = POLLIN };
+        if (!exiting)
+            pfds[n++] = (struct pollfd){ .fd = listen_fd, .events = POLLIN };
+        int first_client = n;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0)
+                continue;
+            client_of[n] = i;
+            pfds[n++] = (struct pollfd){ .fd = clients[i].fd, .events = POLLIN };
+        }
+
+        if (poll(pfds, n, POLL_MS) < 0 && errno != EINTR) {
+            perror("poll");
+            exiting = 1;
+        }
+        if (pfds[0].revents & POLLIN) {
+            int err = perf_buffer__consume(pb);
+            if (err < 0 && err != -EINTR) {
+                fprintf(stderr, "读取性能缓冲区出错: %d\n", err);
+                exiting = 1;
+            }
+        }
+        if (first_client == 2 && (pfds[1].revents & POLLIN))
+            accept_client(listen_fd);
+        for (int i = first_client; i < n; i++) {
+            if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR))
+                read_client(client_of[i]);
+        }
+
+        if (!exiting)
+            start_pending();
+        service_jobs();
+        if (exiting && running_jobs() == 0)
+            break;
+    }
+
+    // 未开始的作业不再运行
+    while (pending_len > 0) {
+        reply(&pending[pending_head].owner, "ERR %d 服务退出\n", pending[pending_head].id);
+        pending_head = (pending_head + 1) % MAX_PENDING;
+        pending_len--;
+    }
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0)
+            close(clients[i].fd);
+    }
+    close(listen_fd);
+    unlink(socket_path);
+    if (dataset && kds_writer_close(dataset) == 0)
+        printf("数据集已保存至 %s\n", dataset_path);
+    free(hashes);
+    perf_buffer__free(pb);
+    program_a_bpf__destroy(skel);
+    printf("退出，共完成 %d 个作业。\n", completed);
+    return 0;
+}
@@ -1,133 +1,140 @@
 #include "perf_monitor.h"
+#include "proc_reader.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
 #include <time.h>
+#include <pthread.h>
 
+// 槽位序号：写入第 pos 条期间为 2*pos+1，写完为 2*pos+2。读者复制前后各读一次序号，
+// 两次相同且等于期望值才算读到，否则说明该条已被覆盖
 typedef struct {
-    unsigned long user, system;
-    unsigned long long total_system;
-} CpuTime;
-
-typedef struct {
-    unsigned long resident;
-    unsigned long virtual_size;
-} MemoryUsage;
-
-static CpuTime get_process_cpu_time() {
-    FILE* stat = fopen("/proc/self/stat", "r");
-    if (!stat) {
-        fprintf(stderr, "Failed to open /proc/self/stat: %s\n", strerror(errno));
-        return (CpuTime){0, 0, 0};
-    }
-    char line[256];
-    if (!fgets(line, sizeof(line), stat)) {
-        fclose(stat);
-        fprintf(stderr, "Failed to read /proc/self/stat: %s\n", strerror(errno));
-        return (CpuTime){0, 0, 0};
-    }
-    fclose(stat);
-
-    char* token = strtok(line, " ");
-    for (int i = 0; i < 13 && token; i++) token = strtok(NULL, " "); // 跳到 utime
-    unsigned long utime = token ? strtoul(token, NULL, 10) : 0;
-    token = strtok(NULL, " "); // stime
-    unsigned long stime = token ? strtoul(token, NULL, 10) : 0;
-    return (CpuTime){utime, stime, 0};
+    atomic_uint_fast64_t seq;
+    PerformanceData data;
+} PerformanceSlot;
+
+// 单生产者（采样线程）环形缓冲区，读者（写盘线程、perf_monitor_latest、save_csv）不加锁
+struct PerformanceMonitor {
+    int interval_ms;
+    int pid;                    // 监控的进程，0 表示采集器自身
+    atomic_int running;
+    PerformanceSlot ring[PERF_RING_SIZE];
+    atomic_uint_fast64_t head;  // 已写入的总条数
+    pthread_t monitor_thread;
+
+    // 流式写盘，只由写盘线程访问
+    FILE* stream;
+    uint64_t tail;              // 已写盘的条数
+    uint64_t dropped;           // 写盘前已被覆盖的条数
+    atomic_int flushing;
+    pthread_t flush_thread;
+};
+
+// 采样线程写入下一条
+static void ring_push(PerformanceMonitor* monitor, const PerformanceData* data) {
+    uint64_t pos = atomic_load_explicit(&monitor->head, memory_order_relaxed);
+    PerformanceSlot* slot = &monitor->ring[pos & (PERF_RING_SIZE - 1)];
+    atomic_store_explicit(&slot->seq, 2 * pos + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->data = *data;
+    atomic_store_explicit(&slot->seq, 2 * pos + 2, memory_order_release);
+    atomic_store_explicit(&monitor->head, pos + 1, memory_order_release);
 }
 
-static CpuTime get_system_cpu_time() {
-    FILE* stat = fopen("/proc/stat", "r");
-    if (!stat) {
-        fprintf(stderr, "Failed to open /proc/stat: %s\n", strerror(errno));
-        return (CpuTime){0, 0, 0};
-    }
-    char line[256];
-    if (!fgets(line, sizeof(line), stat)) {
-        fclose(stat);
-        fprintf(stderr, "Failed to read /proc/stat: %s\n", strerror(errno));
-        return (CpuTime){0, 0, 0};
-    }
-    fclose(stat);
-
-    char* fields[10];
-    int field_count = 0;
-    char* token = strtok(line, " ");
-    while (token && field_count < 10) {
-        fields[field_count++] = token;
-        token = strtok(NULL, " ");
-    }
-    if (field_count < 5) {
-        fprintf(stderr, "/proc/stat has insufficient fields\n");
-        return (CpuTime){0, 0, 0};
-    }
+// 读取第 pos 条，尚未写完或已被覆盖时返回 -1
+static int ring_read(PerformanceMonitor* monitor, uint64_t pos, PerformanceData* out) {
+    PerformanceSlot* slot = &monitor->ring[pos & (PERF_RING_SIZE - 1)];
+    uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (seq != 2 * pos + 2) return -1;
+    *out = slot->data;
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq ? 0 : -1;
+}
 
-    unsigned long user = strtoul(fields[1], NULL, 10);
-    unsigned long nice = strtoul(fields[2], NULL, 10);
-    unsigned long system = strtoul(fields[3], NULL, 10);
-    unsigned long idle = strtoul(fields[4], NULL, 10);
-    return (CpuTime){0, 0, user + nice + system + idle};
+static void write_header(FILE* file) {
+    fprintf(file, "Timestamp,CPU(%%),RAM(KB),VirtualMem(KB)\n");
 }
 
-static double calculate_cpu_usage(const CpuTime* prev_proc, const CpuTime* curr_proc,
-                                 const CpuTime* prev_sys, const CpuTime* curr_sys) {
-    unsigned long proc_diff = (curr_proc->user + curr_proc->system) -
-                              (prev_proc->user + prev_proc->system);
-    unsigned long long sys_diff = curr_sys->total_system - prev_sys->total_system;
-    return (sys_diff == 0) ? 0.0 : (100.0 * proc_diff / sys_diff);
+static void write_row(FILE* file, const PerformanceData* data) {
+    char time_str[32];
+    struct tm local_time;
+    localtime_r(&data->timestamp.tv_sec, &local_time);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &local_time);
+    fprintf(file, "%s.%03ld,%.2f,%lu,%lu\n",
+            time_str,
+            data->timestamp.tv_nsec / 1000000,
+            data->cpu_usage,
+            data->ram_usage,
+            data->virtual_mem);
 }
 
-static MemoryUsage get_memory_usage() {
-    FILE* status = fopen("/proc/self/status", "r");
-    if (!status) {
-        fprintf(stderr, "Failed to open /proc/self/status: %s\n", strerror(errno));
-        return (MemoryUsage){0, 0};
+// 把 tail 之后的新采样写盘；落后超过一圈的部分已被覆盖，计入 dropped
+static void flush_stream(PerformanceMonitor* monitor) {
+    uint64_t head = atomic_load_explicit(&monitor->head, memory_order_acquire);
+    if (head - monitor->tail > PERF_RING_SIZE) {
+        monitor->dropped += head - monitor->tail - PERF_RING_SIZE;
+        monitor->tail = head - PERF_RING_SIZE;
     }
-    char line[256];
-    unsigned long vm_rss = 0, vm_size = 0;
-    while (fgets(line, sizeof(line), status)) {
-        if (strncmp(line, "VmRSS:", 6) == 0) {
-            sscanf(line + 6, "%lu", &vm_rss);
-        } else if (strncmp(line, "VmSize:", 7) == 0) {
-            sscanf(line + 7, "%lu", &vm_size);
-        }
+    for (; monitor->tail < head; monitor->tail++) {
+        PerformanceData data;
+        if (ring_read(monitor, monitor->tail, &data) == 0) write_row(monitor->stream, &data);
+        else monitor->dropped++;
     }
-    fclose(status);
-    return (MemoryUsage){vm_rss, vm_size};
+    fflush(monitor->stream);
+}
+
+static void* flush_thread_func(void* arg) {
+    PerformanceMonitor* monitor = (PerformanceMonitor*)arg;
+    while (monitor->flushing) {
+        // 分段睡眠，停止时不必等满一个写盘间隔
+        for (int i = 0; i < PERF_FLUSH_MS / 50 && monitor->flushing; i++) usleep(50 * 1000);
+        flush_stream(monitor);
+    }
+    return NULL;
 }
 
 static void* monitor_thread_func(void* arg) {
     PerformanceMonitor* monitor = (PerformanceMonitor*)arg;
-    CpuTime prev_proc_time = get_process_cpu_time();
-    CpuTime prev_sys_time = get_system_cpu_time();
+    // 读取器不到 1KB，放在线程栈上
+    struct proc_reader reader;
+    if (proc_reader_init(&reader) != 0) return NULL;
+    if (proc_reader_add(&reader, monitor->pid) < 0) {
+        proc_reader_close(&reader);
+        return NULL;
+    }
+
+    // 线程提前退出时不改 running，perf_monitor_stop 仍会 join
+    struct proc_stat prev;
+    int alive = (proc_reader_read(&reader, 0, &prev) == 0);
+    uint64_t prev_sys = proc_reader_system_ticks(&reader);
 
-    while (monitor->running) {
+    while (alive && monitor->running) {
         struct timespec start;
         clock_gettime(CLOCK_MONOTONIC, &start);
 
-        CpuTime curr_proc_time = get_process_cpu_time();
-        CpuTime curr_sys_time = get_system_cpu_time();
-        double cpu = calculate_cpu_usage(&prev_proc_time, &curr_proc_time,
-                                        &prev_sys_time, &curr_sys_time);
-        MemoryUsage mem = get_memory_usage();
-
-        pthread_mutex_lock(&monitor->data_mutex);
-        if (monitor->data_count < MAX_DATA_POINTS) {
-            monitor->data[monitor->data_count] = (PerformanceData){
-                .timestamp = {0, 0},
-                .cpu_usage = cpu,
-                .ram_usage = mem.resident,
-                .virtual_mem = mem.virtual_size
-            };
-            clock_gettime(CLOCK_REALTIME, &monitor->data[monitor->data_count].timestamp);
-            monitor->data_count++;
-        }
-        pthread_mutex_unlock(&monitor->data_mutex);
-
-        prev_proc_time = curr_proc_time;
-        prev_sys_time = curr_sys_time;
+        struct proc_stat curr;
+        if (proc_reader_read(&reader, 0, &curr) != 0) break;  // 目标进程已退出
+        uint64_t curr_sys = proc_reader_system_ticks(&reader);
+        // 进程 CPU 时间换算成滴答后与全系统滴答相比，与按 utime+stime 计算的口径一致
+        double proc_ticks = (double)(curr.cpu_ns - prev.cpu_ns) / reader.ns_per_tick;
+        uint64_t sys_diff = curr_sys - prev_sys;
+        double cpu = (sys_diff == 0) ? 0.0 : (100.0 * proc_ticks / sys_diff);
+
+        PerformanceData data = {
+            .timestamp = {0, 0},
+            .cpu_usage = cpu,
+            .ram_usage = curr.rss_kb,
+            .virtual_mem = curr.vsize / 1024
+        };
+        clock_gettime(CLOCK_REALTIME, &data.timestamp);
+        ring_push(monitor, &data);
+
+        prev = curr;
+        prev_sys = curr_sys;
 
         struct timespec end;
         clock_gettime(CLOCK_MONOTONIC, &end);
@@ -137,33 +144,48 @@ static void* monitor_thread_func(void* arg) {
             usleep((monitor->interval_ms - elapsed_ms) * 1000);
         }
     }
+    proc_reader_close(&reader);
     return NULL;
 }
 
 PerformanceMonitor* perf_monitor_create(int interval_ms) {
+    return perf_monitor_create_pid(0, interval_ms);
+}
+
+PerformanceMonitor* perf_monitor_create_pid(int pid, int interval_ms) {
     PerformanceMonitor* monitor = (PerformanceMonitor*)calloc(1, sizeof(PerformanceMonitor));
     if (!monitor) {
         fprintf(stderr, "Failed to allocate PerformanceMonitor: %s\n", strerror(errno));
         return NULL;
     }
     monitor->interval_ms = interval_ms;
+    monitor->pid = pid;
     monitor->running = 0;
-    monitor->data_count = 0;
-    if (pthread_mutex_init(&monitor->data_mutex, NULL) != 0) {
-        fprintf(stderr, "Failed to initialize mutex: %s\n", strerror(errno));
-        free(monitor);
-        return NULL;
-    }
     return monitor;
 }
 
 void perf_monitor_destroy(PerformanceMonitor* monitor) {
     if (!monitor) return;
     perf_monitor_stop(monitor);
-    pthread_mutex_destroy(&monitor->data_mutex);
+    if (monitor->stream) {
+        if (monitor->dropped)
+            fprintf(stderr, "Monitor stream lost %llu samples\n", (unsigned long long)monitor->dropped);
+        fclose(monitor->stream);
+    }
     free(monitor);
 }
 
+int perf_monitor_stream(PerformanceMonitor* monitor, const char* filename) {
+    if (!monitor || monitor->running || monitor->stream) return -1;
+    monitor->stream = fopen(filename, "w");
+    if (!monitor->stream) {
+        fprintf(stderr, "Failed to open %s: %s\n", filename, strerror(errno));
+        return -1;
+    }
+    write_header(monitor->stream);
+    return 0;
+}
+
 void perf_monitor_start(PerformanceMonitor* monitor) {
     if (!monitor || monitor->running) return;
     monitor->running = 1;
@@ -172,37 +194,52 @@ void perf_monitor_start(PerformanceMonitor* monitor) {
         monitor->running = 0;
         return;
     }
+    if (monitor->stream) {
+        monitor->flushing = 1;
+        if (pthread_create(&monitor->flush_thread, NULL, flush_thread_func, monitor) != 0) {
+            // 没有写盘线程时停止时一次写出环形缓冲区中剩余的部分
+            fprintf(stderr, "Failed to create flush thread: %s\n", strerror(errno));
+            monitor->flushing = 0;
+        }
+    }
 }
 
 void perf_monitor_stop(PerformanceMonitor* monitor) {
     if (!monitor || !monitor->running) return;
     monitor->running = 0;
     pthread_join(monitor->monitor_thread, NULL);
+    // 采样线程结束后再停写盘线程，最后一批采样也能写入
+    if (monitor->flushing) {
+        monitor->flushing = 0;
+        pthread_join(monitor->flush_thread, NULL);
+    }
+    if (monitor->stream) flush_stream(monitor);
+}
+
+int perf_monitor_latest(PerformanceMonitor* monitor, PerformanceData* out) {
+    if (!monitor) return -1;
+    // 读的同时被覆盖时重试，此时 head 已前进，再读一次即可
+    for (;;) {
+        uint64_t head = atomic_load_explicit(&monitor->head, memory_order_acquire);
+        if (head == 0) return -1;
+        if (ring_read(monitor, head - 1, out) == 0) return 0;
+    }
 }
 
 void perf_monitor_save_csv(PerformanceMonitor* monitor, const char* filename) {
     if (!monitor) return;
-    pthread_mutex_lock(&monitor->data_mutex);
     FILE* file = fopen(filename, "w");
     if (!file) {
         fprintf(stderr, "Failed to open %s: %s\n", filename, strerror(errno));
-        pthread_mutex_unlock(&monitor->data_mutex);
         return;
     }
 
-    fprintf(file, "Timestamp,CPU(%%),RAM(KB),VirtualMem(KB)\n");
-    for (int i = 0; i < monitor->data_count; i++) {
-        char time_str[32];
-        struct tm local_time;
-        localtime_r(&monitor->data[i].timestamp.tv_sec, &local_time);
-        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &local_time);
-        fprintf(file, "%s.%03ld,%.2f,%lu,%lu\n",
-                time_str,
-                monitor->data[i].timestamp.tv_nsec / 1000000,
-                monitor->data[i].cpu_usage,
-                monitor->data[i].ram_usage,
-                monitor->data[i].virtual_mem);
+    write_header(file);
+    uint64_t head = atomic_load_explicit(&monitor->head, memory_order_acquire);
+    uint64_t pos = head > PERF_RING_SIZE ? head - PERF_RING_SIZE : 0;
+    for (; pos < head; pos++) {
+        PerformanceData data;
+        if (ring_read(monitor, pos, &data) == 0) write_row(file, &data);
     }
     fclose(file);
-    pthread_mutex_unlock(&monitor->data_mutex);
 }
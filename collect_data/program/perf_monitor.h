@@ -2,9 +2,16 @@
 #define PERF_MONITOR_H
 
 #include <time.h>
-#include <pthread.h>
 
-#define MAX_DATA_POINTS 3600 // 最大存储1小时的数据（每秒1次）
+// 采样保存在环形缓冲区中，写满后覆盖最旧的一条，可以无限期运行。
+// 每 10ms 一次时保存最近 40 秒，每秒 1 次时约 68 分钟；更早的数据用流式写盘保留
+#define PERF_RING_SIZE 4096     // 2 的幂
+#define PERF_FLUSH_MS 1000      // 流式写盘的间隔
+
+// 结构体定义在 perf_monitor.c 中，C++ 代码（script/get_feature.cpp）可直接包含本头文件
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 typedef struct {
     struct timespec timestamp;
@@ -13,19 +20,24 @@ typedef struct {
     unsigned long virtual_mem;  // KB
 } PerformanceData;
 
-typedef struct {
-    int interval_ms;
-    int running;
-    PerformanceData data[MAX_DATA_POINTS];
-    int data_count;
-    pthread_mutex_t data_mutex;
-    pthread_t monitor_thread;
-} PerformanceMonitor;
+typedef struct PerformanceMonitor PerformanceMonitor;
 
+// 监控采集器自身
 PerformanceMonitor* perf_monitor_create(int interval_ms);
+// 监控指定进程，进程退出后停止记录
+PerformanceMonitor* perf_monitor_create_pid(int pid, int interval_ms);
 void perf_monitor_destroy(PerformanceMonitor* monitor);
 void perf_monitor_start(PerformanceMonitor* monitor);
 void perf_monitor_stop(PerformanceMonitor* monitor);
+// 开始前调用：另起线程每 PERF_FLUSH_MS 把新采样追加到 filename，停止时写完剩余部分。失败返回 -1
+int perf_monitor_stream(PerformanceMonitor* monitor, const char* filename);
+// 最近一次采样，还没有采样时返回 -1
+int perf_monitor_latest(PerformanceMonitor* monitor, PerformanceData* out);
+// 把环形缓冲区中仍保留的采样（最多 PERF_RING_SIZE 条）写入 filename
 void perf_monitor_save_csv(PerformanceMonitor* monitor, const char* filename);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // PERF_MONITOR_H
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include "proc_reader.h"
+
+// 读取常开 fd 的全部内容（从偏移 0 开始）并补 '\0'，返回长度，失败返回 -1
+static int pread_all(int fd, char *buf, size_t size) {
+    ssize_t n = pread(fd, buf, size - 1, 0);
+    if (n <= 0)
+        return -1;
+    buf[n] = '\0';
+    return (int)n;
+}
+
+// 跳过空格后解析一个十进制数，p 移到数字之后；负数（只出现在无关字段）按 0 处理
+static uint64_t scan_u64(const char **p) {
+    const char *s = *p;
+    while (*s == ' ')
+        s++;
+    int neg = (*s == '-');
+    if (neg)
+        s++;
+    uint64_t v = 0;
+    while (*s >= '0' && *s <= '9')
+        v = v * 10 + (uint64_t)(*s++ - '0');
+    *p = s;
+    return neg ? 0 : v;
+}
+
+static int open_proc_file(int pid, const char *name) {
+    char path[64];
+    if (pid > 0)
+        snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+    else
+        snprintf(path, sizeof(path), "/proc/self/%s", name);
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+int proc_reader_init(struct proc_reader *r) {
+    memset(r, 0, sizeof(*r));
+    long tick = sysconf(_SC_CLK_TCK);
+    r->ns_per_tick = tick > 0 ? 1000000000ULL / (uint64_t)tick : 10000000ULL;
+    r->page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    r->sys_fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+    if (r->sys_fd < 0) {
+        fprintf(stderr, "打开 /proc/stat 失败: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+void proc_reader_close(struct proc_reader *r) {
+    for (int i = 0; i < r->count; i++)
+        proc_reader_remove(r, i);
+    if (r->sys_fd >= 0)
+        close(r->sys_fd);
+    r->sys_fd = -1;
+    r->count = 0;
+}
+
+int proc_reader_add(struct proc_reader *r, int pid) {
+    if (r->count >= PROC_READER_MAX) {
+        fprintf(stderr, "/proc 读取器最多 %d 个进程\n", PROC_READER_MAX);
+        return -1;
+    }
+    struct proc_target *t = &r->targets[r->count];
+    t->pid = pid;
+    t->stat_fd = open_proc_file(pid, "stat");
+    if (t->stat_fd < 0) {
+        fprintf(stderr, "打开 /proc/%d/stat 失败: %s\n", pid, strerror(errno));
+        return -1;
+    }
+    // 未开启 CONFIG_SCHEDSTATS 的内核没有此文件，退回 utime+stime
+    t->schedstat_fd = open_proc_file(pid, "schedstat");
+    return r->count++;
+}
+
+void proc_reader_remove(struct proc_reader *r, int index) {
+    struct proc_target *t = &r->targets[index];
+    if (t->stat_fd >= 0)
+        close(t->stat_fd);
+    if (t->schedstat_fd >= 0)
+        close(t->schedstat_fd);
+    t->stat_fd = t->schedstat_fd = -1;
+}
+
+int proc_reader_read(struct proc_reader *r, int index, struct proc_stat *st) {
+    struct proc_target *t = &r->targets[index];
+    char buf[1024];
+    // 进程退出后 pread 返回 ESRCH 或 0
+    if (t->stat_fd < 0 || pread_all(t->stat_fd, buf, sizeof(buf)) < 0) {
+        proc_reader_remove(r, index);
+        return -1;
+    }
+
+    // comm 可能含空格和括号，从最后一个 ')' 之后开始数字段，下一个字段是第 3 个（state）
+    const char *p = strrchr(buf, ')');
+    if (!p || p[1] != ' ' || !p[2])
+        return -1;
+    p += 3;
+    uint64_t f[25] = {0};
+    for (int i = 4; i <= 24 && *p; i++)
+        f[i] = scan_u64(&p);
+    st->minflt = f[10];
+    st->majflt = f[12];
+    st->utime = f[14];
+    st->stime = f[15];
+    st->num_threads = f[20];
+    st->vsize = f[23];
+    st->rss_kb = f[24] * (uint64_t)r->page_kb;
+
+    st->cpu_ns = (st->utime + st->stime) * r->ns_per_tick;
+    if (t->schedstat_fd >= 0 && pread_all(t->schedstat_fd, buf, sizeof(buf)) > 0) {
+        const char *q = buf;
+        st->cpu_ns = scan_u64(&q);
+    }
+    return 0;
+}
+
+uint64_t proc_reader_system_ticks(struct proc_reader *r) {
+    // 只需要第一行；/proc/stat 在 CPU 多时很长，读 512 字节即可
+    char buf[512];
+    if (r->sys_fd < 0 || pread_all(r->sys_fd, buf, sizeof(buf)) < 0 || strncmp(buf, "cpu ", 4) != 0)
+        return 0;
+    const char *p = buf + 4;
+    uint64_t total = 0;
+    for (int i = 0; i < 4; i++)     // user nice system idle
+        total += scan_u64(&p);
+    return total;
+}
@@ -0,0 +1,59 @@
+#ifndef PROC_READER_H
+#define PROC_READER_H
+
+#include <stdint.h>
+
+// /proc 读取器，供资源监控（perf_monitor.c、collect.c、script/get_feature.cpp）共用。
+// 每个进程的 /proc/<pid>/stat 和 schedstat 在加入时打开一次，之后每轮用 pread 从偏移 0
+// 读到栈上的缓冲区，手工扫描数字字段，全程不分配堆内存。
+// 非线程安全，一个读取器只由一个线程使用；各采集线程按自己的采样节拍读取自己的目标。C++ 代码可直接包含本头文件。
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROC_READER_MAX 64
+
+// 一个进程在某一时刻的资源占用
+struct proc_stat {
+    uint64_t cpu_ns;            // 累计 CPU 时间（schedstat 不可用时由 utime+stime 换算，精度为时钟滴答）
+    uint64_t utime, stime;      // 时钟滴答
+    uint64_t minflt, majflt;
+    uint64_t vsize;             // 字节
+    uint64_t rss_kb;
+    uint64_t num_threads;
+};
+
+struct proc_target {
+    int pid;                    // 0 表示 /proc/self
+    int stat_fd;                // -1 表示空位或进程已退出
+    int schedstat_fd;           // -1 表示不可用
+};
+
+struct proc_reader {
+    int count;                  // 已使用的位置（含已退出的进程）
+    int sys_fd;                 // /proc/stat
+    long page_kb;
+    uint64_t ns_per_tick;
+    struct proc_target targets[PROC_READER_MAX];
+};
+
+int proc_reader_init(struct proc_reader *r);
+void proc_reader_close(struct proc_reader *r);
+
+// 加入一个进程，pid 为 0 时为读取器所在进程。返回位置下标，失败返回 -1
+int proc_reader_add(struct proc_reader *r, int pid);
+// 关闭该位置的 fd；位置不复用，下标保持不变
+void proc_reader_remove(struct proc_reader *r, int index);
+
+// 读取一个进程。进程已退出时关闭其 fd 并返回 -1
+int proc_reader_read(struct proc_reader *r, int index, struct proc_stat *st);
+
+// /proc/stat 第一行 user+nice+system+idle（时钟滴答），失败返回 0
+uint64_t proc_reader_system_ticks(struct proc_reader *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROC_READER_H
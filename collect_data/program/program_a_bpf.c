@@ -13,13 +13,22 @@ struct {
     __type(value, u32);
 } events SEC(".maps");
 
+// 输出给用户态的事件，pid 位于开头，只读取 PID 的旧用户态程序不受影响
+struct sample_exec_event {
+    u32 pid;
+    u32 pad;
+    u64 cgroup_id;      // 所在 cgroup v2 目录的 inode，run_samples 据此把进程归到样本
+};
+
 // 跟踪 execve 系统调用
 SEC("tracepoint/syscalls/sys_enter_execve")
 int trace_execve(struct trace_event_raw_sys_enter *ctx) {
-    u32 pid = bpf_get_current_pid_tgid() >> 32;  // 获取当前进程的 PID
+    struct sample_exec_event event = {};
+    event.pid = bpf_get_current_pid_tgid() >> 32;  // 获取当前进程的 PID
+    event.cgroup_id = bpf_get_current_cgroup_id();
 
     // 向 perf event 输出事件
-    bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, &pid, sizeof(pid));
+    bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, &event, sizeof(event));
 
     return 0;
 }
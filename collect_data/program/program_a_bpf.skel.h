@@ -1,445 +0,0 @@
-/* SPDX-License-Identifier: (LGPL-2.1 OR BSD-2-Clause) */
-
-/* THIS FILE IS AUTOGENERATED BY BPFTOOL! */
-#ifndef __PROGRAM_A_BPF_SKEL_H__
-#define __PROGRAM_A_BPF_SKEL_H__
-
-#include <errno.h>
-#include <stdlib.h>
-#include <bpf/libbpf.h>
-
-struct program_a_bpf {
-	struct bpf_object_skeleton *skeleton;
-	struct bpf_object *obj;
-	struct {
-		struct bpf_map *events;
-	} maps;
-	struct {
-		struct bpf_program *trace_execve;
-	} progs;
-	struct {
-		struct bpf_link *trace_execve;
-	} links;
-
-#ifdef __cplusplus
-	static inline struct program_a_bpf *open(const struct bpf_object_open_opts *opts = nullptr);
-	static inline struct program_a_bpf *open_and_load();
-	static inline int load(struct program_a_bpf *skel);
-	static inline int attach(struct program_a_bpf *skel);
-	static inline void detach(struct program_a_bpf *skel);
-	static inline void destroy(struct program_a_bpf *skel);
-	static inline const void *elf_bytes(size_t *sz);
-#endif /* __cplusplus */
-};
-
-static void
-program_a_bpf__destroy(struct program_a_bpf *obj)
-{
-	if (!obj)
-		return;
-	if (obj->skeleton)
-		bpf_object__destroy_skeleton(obj->skeleton);
-	free(obj);
-}
-
-static inline int
-program_a_bpf__create_skeleton(struct program_a_bpf *obj);
-
-static inline struct program_a_bpf *
-program_a_bpf__open_opts(const struct bpf_object_open_opts *opts)
-{
-	struct program_a_bpf *obj;
-	int err;
-
-	obj = (struct program_a_bpf *)calloc(1, sizeof(*obj));
-	if (!obj) {
-		errno = ENOMEM;
-		return NULL;
-	}
-
-	err = program_a_bpf__create_skeleton(obj);
-	if (err)
-		goto err_out;
-
-	err = bpf_object__open_skeleton(obj->skeleton, opts);
-	if (err)
-		goto err_out;
-
-	return obj;
-err_out:
-	program_a_bpf__destroy(obj);
-	errno = -err;
-	return NULL;
-}
-
-static inline struct program_a_bpf *
-program_a_bpf__open(void)
-{
-	return program_a_bpf__open_opts(NULL);
-}
-
-static inline int
-program_a_bpf__load(struct program_a_bpf *obj)
-{
-	return bpf_object__load_skeleton(obj->skeleton);
-}
-
-static inline struct program_a_bpf *
-program_a_bpf__open_and_load(void)
-{
-	struct program_a_bpf *obj;
-	int err;
-
-	obj = program_a_bpf__open();
-	if (!obj)
-		return NULL;
-	err = program_a_bpf__load(obj);
-	if (err) {
-		program_a_bpf__destroy(obj);
-		errno = -err;
-		return NULL;
-	}
-	return obj;
-}
-
-static inline int
-program_a_bpf__attach(struct program_a_bpf *obj)
-{
-	return bpf_object__attach_skeleton(obj->skeleton);
-}
-
-static inline void
-program_a_bpf__detach(struct program_a_bpf *obj)
-{
-	bpf_object__detach_skeleton(obj->skeleton);
-}
-
-static inline const void *program_a_bpf__elf_bytes(size_t *sz);
-
-static inline int
-program_a_bpf__create_skeleton(struct program_a_bpf *obj)
-{
-	struct bpf_object_skeleton *s;
-	int err;
-
-	s = (struct bpf_object_skeleton *)calloc(1, sizeof(*s));
-	if (!s)	{
-		err = -ENOMEM;
-		goto err;
-	}
-
-	s->sz = sizeof(*s);
-	s->name = "program_a_bpf";
-	s->obj = &obj->obj;
-
-	/* maps */
-	s->map_cnt = 1;
-	s->map_skel_sz = sizeof(*s->maps);
-	s->maps = (struct bpf_map_skeleton *)calloc(s->map_cnt, s->map_skel_sz);
-	if (!s->maps) {
-		err = -ENOMEM;
-		goto err;
-	}
-
-	s->maps[0].name = "events";
-	s->maps[0].map = &obj->maps.events;
-
-	/* programs */
-	s->prog_cnt = 1;
-	s->prog_skel_sz = sizeof(*s->progs);
-	s->progs = (struct bpf_prog_skeleton *)calloc(s->prog_cnt, s->prog_skel_sz);
-	if (!s->progs) {
-		err = -ENOMEM;
-		goto err;
-	}
-
-	s->progs[0].name = "trace_execve";
-	s->progs[0].prog = &obj->progs.trace_execve;
-	s->progs[0].link = &obj->links.trace_execve;
-
-	s->data = program_a_bpf__elf_bytes(&s->data_sz);
-
-	obj->skeleton = s;
-	return 0;
-err:
-	bpf_object__destroy_skeleton(s);
-	return err;
-}
-
-static inline const void *program_a_bpf__elf_bytes(size_t *sz)
-{
-	static const char data[] __attribute__((__aligned__(8))) = "\
-\x7f\x45\x4c\x46\x02\x01\x01\0\0\0\0\0\0\0\0\0\x01\0\xf7\0\x01\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\xa8\x13\0\0\0\0\0\0\0\0\0\0\x40\0\0\0\0\0\x40\0\x1b\0\
-\x01\0\xbf\x16\0\0\0\0\0\0\x85\0\0\0\x0e\0\0\0\x77\0\0\0\x20\0\0\0\x63\x0a\xfc\
-\xff\0\0\0\0\xbf\xa4\0\0\0\0\0\0\x07\x04\0\0\xfc\xff\xff\xff\xbf\x61\0\0\0\0\0\
-\0\x18\x02\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x18\x03\0\0\xff\xff\xff\xff\0\0\0\0\0\0\
-\0\0\xb7\x05\0\0\x04\0\0\0\x85\0\0\0\x19\0\0\0\xb7\0\0\0\0\0\0\0\x95\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x47\x50\
-\x4c\0\x27\0\0\0\x05\0\x08\0\x02\0\0\0\x08\0\0\0\x18\0\0\0\x04\0\x08\x01\x51\
-\x04\x08\x38\x01\x56\x04\x38\x68\x01\x51\0\x04\x20\x78\x02\x7a\x04\0\x01\x11\
-\x01\x25\x25\x13\x05\x03\x25\x72\x17\x10\x17\x1b\x25\x11\x1b\x12\x06\x73\x17\
-\x8c\x01\x17\0\0\x02\x34\0\x03\x25\x49\x13\x3f\x19\x3a\x0b\x3b\x0b\x02\x18\0\0\
-\x03\x01\x01\x49\x13\0\0\x04\x21\0\x49\x13\x37\x0b\0\0\x05\x24\0\x03\x25\x3e\
-\x0b\x0b\x0b\0\0\x06\x24\0\x03\x25\x0b\x0b\x3e\x0b\0\0\x07\x13\x01\x0b\x0b\x3a\
-\x0b\x3b\x0b\0\0\x08\x0d\0\x03\x25\x49\x13\x3a\x0b\x3b\x0b\x38\x0b\0\0\x09\x0f\
-\0\x49\x13\0\0\x0a\x16\0\x49\x13\x03\x25\x3a\x0b\x3b\x0b\0\0\x0b\x34\0\x03\x25\
-\x49\x13\x3a\x0b\x3b\x05\0\0\x0c\x15\0\x49\x13\x27\x19\0\0\x0d\x15\x01\x49\x13\
-\x27\x19\0\0\x0e\x05\0\x49\x13\0\0\x0f\x0f\0\0\0\x10\x04\x01\x49\x13\x0b\x0b\
-\x3a\x0b\x3b\x06\0\0\x11\x28\0\x03\x25\x1c\x0f\0\0\x12\x2e\x01\x11\x1b\x12\x06\
-\x40\x18\x7a\x19\x03\x25\x3a\x0b\x3b\x0b\x27\x19\x49\x13\x3f\x19\0\0\x13\x05\0\
-\x02\x22\x03\x25\x3a\x0b\x3b\x0b\x49\x13\0\0\x14\x34\0\x02\x22\x03\x25\x3a\x0b\
-\x3b\x0b\x49\x13\0\0\x15\x13\x01\x03\x25\x0b\x0b\x3a\x0b\x3b\x06\0\0\x16\x0d\0\
-\x03\x25\x49\x13\x3a\x0b\x3b\x06\x38\x0b\0\0\x17\x13\x01\x03\x25\x0b\x0b\x3a\
-\x0b\x3b\x05\0\0\x18\x0d\0\x03\x25\x49\x13\x3a\x0b\x3b\x05\x38\x0b\0\0\0\xde\
-\x01\0\0\x05\0\x01\x08\0\0\0\0\x01\0\x0c\0\x01\x08\0\0\0\0\0\0\0\x02\x02\x78\0\
-\0\0\x08\0\0\0\x0c\0\0\0\x02\x03\x32\0\0\0\0\x1b\x02\xa1\0\x03\x3e\0\0\0\x04\
-\x42\0\0\0\x04\0\x05\x04\x06\x01\x06\x05\x08\x07\x02\x06\x51\0\0\0\0\x0e\x02\
-\xa1\x01\x07\x20\0\x09\x08\x07\x7a\0\0\0\0\x0a\0\x08\x09\x8f\0\0\0\0\x0b\x08\
-\x08\x0a\xa0\0\0\0\0\x0c\x10\x08\x0e\xa0\0\0\0\0\x0d\x18\0\x09\x7f\0\0\0\x03\
-\x8b\0\0\0\x04\x42\0\0\0\x04\0\x05\x08\x05\x04\x09\x94\0\0\0\x03\x8b\0\0\0\x04\
-\x42\0\0\0\x80\0\x09\xa5\0\0\0\x0a\xad\0\0\0\x0d\x01\x1a\x0a\xb5\0\0\0\x0c\x01\
-\x0e\x05\x0b\x07\x04\x0b\x0f\xc2\0\0\0\x02\x69\x01\x09\xc7\0\0\0\x0c\xcc\0\0\0\
-\x0a\xd4\0\0\0\x11\x01\x12\x05\x10\x07\x08\x0b\x12\xe1\0\0\0\x02\xad\x02\x09\
-\xe6\0\0\0\x0d\x05\x01\0\0\x0e\x09\x01\0\0\x0e\x09\x01\0\0\x0e\xcc\0\0\0\x0e\
-\x09\x01\0\0\x0e\xcc\0\0\0\0\x05\x13\x05\x08\x0f\x10\x2e\x01\0\0\x08\x01\x33\
-\xd0\x01\0\x11\x15\xff\xff\xff\xff\x0f\x11\x16\xff\xff\xff\xff\x0f\x11\x17\x80\
-\x80\x80\x80\xf0\xff\xff\x07\0\x05\x14\x07\x08\x12\x02\x78\0\0\0\x01\x5a\x18\0\
-\x12\x8b\0\0\0\x13\0\x19\0\x12\x54\x01\0\0\x14\x01\x1f\0\x13\xa5\0\0\0\0\x09\
-\x59\x01\0\0\x15\x24\x40\x01\xea\x69\x01\0\x16\x1a\x92\x01\0\0\x01\xeb\x69\x01\
-\0\0\x16\x21\x05\x01\0\0\x01\xec\x69\x01\0\x08\x16\x22\xc9\x01\0\0\x01\xed\x69\
-\x01\0\x10\x16\x23\xd5\x01\0\0\x01\xee\x69\x01\0\x40\0\x17\x20\x08\x01\xef\x16\
-\x18\x07\xc1\x01\0\0\x01\xf0\x16\0\x18\x1c\xc5\x01\0\0\x01\xf1\x16\x02\x18\x1e\
-\xc5\x01\0\0\x01\xf2\x16\x03\x18\x1f\x8b\0\0\0\x01\xf3\x16\x04\0\x05\x1b\x07\
-\x02\x05\x1d\x08\x01\x03\x2e\x01\0\0\x04\x42\0\0\0\x06\0\x03\x3e\0\0\0\x04\x42\
-\0\0\0\0\0\0\x98\0\0\0\x05\0\0\0\0\0\0\0\x27\0\0\0\x37\0\0\0\x4d\0\0\0\x55\0\0\
-\0\x5a\0\0\0\x6e\0\0\0\x75\0\0\0\x7a\0\0\0\x7e\0\0\0\x8a\0\0\0\x8e\0\0\0\x9b\0\
-\0\0\xa1\0\0\0\xa5\0\0\0\xab\0\0\0\xc4\0\0\0\xd7\0\0\0\xdd\0\0\0\xf3\0\0\0\xf8\
-\0\0\0\x06\x01\0\0\x17\x01\0\0\x29\x01\0\0\x3b\x01\0\0\x48\x01\0\0\x4c\x01\0\0\
-\x50\x01\0\0\x5f\x01\0\0\x65\x01\0\0\x73\x01\0\0\x81\x01\0\0\x85\x01\0\0\x91\
-\x01\0\0\x94\x01\0\0\x99\x01\0\0\xa0\x01\0\0\x55\x62\x75\x6e\x74\x75\x20\x63\
-\x6c\x61\x6e\x67\x20\x76\x65\x72\x73\x69\x6f\x6e\x20\x31\x34\x2e\x30\x2e\x30\
-\x2d\x31\x75\x62\x75\x6e\x74\x75\x31\x2e\x31\0\x70\x72\x6f\x67\x72\x61\x6d\x5f\
-\x61\x5f\x62\x70\x66\x2e\x63\0\x2f\x68\x6f\x6d\x65\x2f\x6d\x7a\x32\x2f\x44\x65\
-\x73\x6b\x74\x6f\x70\x2f\x78\x6c\x6b\0\x4c\x49\x43\x45\x4e\x53\x45\0\x63\x68\
-\x61\x72\0\x5f\x5f\x41\x52\x52\x41\x59\x5f\x53\x49\x5a\x45\x5f\x54\x59\x50\x45\
-\x5f\x5f\0\x65\x76\x65\x6e\x74\x73\0\x74\x79\x70\x65\0\x69\x6e\x74\0\x6d\x61\
-\x78\x5f\x65\x6e\x74\x72\x69\x65\x73\0\x6b\x65\x79\0\x75\x6e\x73\x69\x67\x6e\
-\x65\x64\x20\x69\x6e\x74\0\x5f\x5f\x75\x33\x32\0\x75\x33\x32\0\x76\x61\x6c\x75\
-\x65\0\x62\x70\x66\x5f\x67\x65\x74\x5f\x63\x75\x72\x72\x65\x6e\x74\x5f\x70\x69\
-\x64\x5f\x74\x67\x69\x64\0\x75\x6e\x73\x69\x67\x6e\x65\x64\x20\x6c\x6f\x6e\x67\
-\x20\x6c\x6f\x6e\x67\0\x5f\x5f\x75\x36\x34\0\x62\x70\x66\x5f\x70\x65\x72\x66\
-\x5f\x65\x76\x65\x6e\x74\x5f\x6f\x75\x74\x70\x75\x74\0\x6c\x6f\x6e\x67\0\x75\
-\x6e\x73\x69\x67\x6e\x65\x64\x20\x6c\x6f\x6e\x67\0\x42\x50\x46\x5f\x46\x5f\x49\
-\x4e\x44\x45\x58\x5f\x4d\x41\x53\x4b\0\x42\x50\x46\x5f\x46\x5f\x43\x55\x52\x52\
-\x45\x4e\x54\x5f\x43\x50\x55\0\x42\x50\x46\x5f\x46\x5f\x43\x54\x58\x4c\x45\x4e\
-\x5f\x4d\x41\x53\x4b\0\x74\x72\x61\x63\x65\x5f\x65\x78\x65\x63\x76\x65\0\x63\
-\x74\x78\0\x65\x6e\x74\0\x75\x6e\x73\x69\x67\x6e\x65\x64\x20\x73\x68\x6f\x72\
-\x74\0\x66\x6c\x61\x67\x73\0\x75\x6e\x73\x69\x67\x6e\x65\x64\x20\x63\x68\x61\
-\x72\0\x70\x72\x65\x65\x6d\x70\x74\x5f\x63\x6f\x75\x6e\x74\0\x70\x69\x64\0\x74\
-\x72\x61\x63\x65\x5f\x65\x6e\x74\x72\x79\0\x69\x64\0\x61\x72\x67\x73\0\x5f\x5f\
-\x64\x61\x74\x61\0\x74\x72\x61\x63\x65\x5f\x65\x76\x65\x6e\x74\x5f\x72\x61\x77\
-\x5f\x73\x79\x73\x5f\x65\x6e\x74\x65\x72\0\x1c\0\0\0\x05\0\x08\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x9f\xeb\x01\0\x18\0\0\0\0\0\0\0\x64\x02\0\
-\0\x64\x02\0\0\x2f\x02\0\0\0\0\0\0\0\0\0\x02\x03\0\0\0\x01\0\0\0\0\0\0\x01\x04\
-\0\0\0\x20\0\0\x01\0\0\0\0\0\0\0\x03\0\0\0\0\x02\0\0\0\x04\0\0\0\x04\0\0\0\x05\
-\0\0\0\0\0\0\x01\x04\0\0\0\x20\0\0\0\0\0\0\0\0\0\0\x02\x06\0\0\0\0\0\0\0\0\0\0\
-\x03\0\0\0\0\x02\0\0\0\x04\0\0\0\x80\0\0\0\0\0\0\0\0\0\0\x02\x08\0\0\0\x19\0\0\
-\0\0\0\0\x08\x09\0\0\0\x1d\0\0\0\0\0\0\x08\x0a\0\0\0\x23\0\0\0\0\0\0\x01\x04\0\
-\0\0\x20\0\0\0\0\0\0\0\x04\0\0\x04\x20\0\0\0\x30\0\0\0\x01\0\0\0\0\0\0\0\x35\0\
-\0\0\x05\0\0\0\x40\0\0\0\x41\0\0\0\x07\0\0\0\x80\0\0\0\x45\0\0\0\x07\0\0\0\xc0\
-\0\0\0\x4b\0\0\0\0\0\0\x0e\x0b\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\x02\x0e\0\0\0\x52\
-\0\0\0\x04\0\0\x04\x40\0\0\0\x6c\0\0\0\x0f\0\0\0\0\0\0\0\x70\0\0\0\x12\0\0\0\
-\x40\0\0\0\x73\0\0\0\x14\0\0\0\x80\0\0\0\x78\0\0\0\x16\0\0\0\0\x02\0\0\x7f\0\0\
-\0\x04\0\0\x04\x08\0\0\0\x30\0\0\0\x10\0\0\0\0\0\0\0\x8b\0\0\0\x11\0\0\0\x10\0\
-\0\0\x91\0\0\0\x11\0\0\0\x18\0\0\0\x9f\0\0\0\x02\0\0\0\x20\0\0\0\xa3\0\0\0\0\0\
-\0\x01\x02\0\0\0\x10\0\0\0\xb2\0\0\0\0\0\0\x01\x01\0\0\0\x08\0\0\0\xc0\0\0\0\0\
-\0\0\x01\x08\0\0\0\x40\0\0\x01\xc5\0\0\0\0\0\0\x01\x08\0\0\0\x40\0\0\0\0\0\0\0\
-\0\0\0\x03\0\0\0\0\x13\0\0\0\x04\0\0\0\x06\0\0\0\xd3\0\0\0\0\0\0\x01\x01\0\0\0\
-\x08\0\0\x01\0\0\0\0\0\0\0\x03\0\0\0\0\x15\0\0\0\x04\0\0\0\0\0\0\0\0\0\0\0\x01\
-\0\0\x0d\x02\0\0\0\xd8\0\0\0\x0d\0\0\0\xdc\0\0\0\x01\0\0\x0c\x17\0\0\0\0\0\0\0\
-\0\0\0\x03\0\0\0\0\x15\0\0\0\x04\0\0\0\x04\0\0\0\x19\x02\0\0\0\0\0\x0e\x19\0\0\
-\0\x01\0\0\0\x21\x02\0\0\x01\0\0\x0f\0\0\0\0\x0c\0\0\0\0\0\0\0\x20\0\0\0\x27\
-\x02\0\0\x01\0\0\x0f\0\0\0\0\x1a\0\0\0\0\0\0\0\x04\0\0\0\0\x69\x6e\x74\0\x5f\
-\x5f\x41\x52\x52\x41\x59\x5f\x53\x49\x5a\x45\x5f\x54\x59\x50\x45\x5f\x5f\0\x75\
-\x33\x32\0\x5f\x5f\x75\x33\x32\0\x75\x6e\x73\x69\x67\x6e\x65\x64\x20\x69\x6e\
-\x74\0\x74\x79\x70\x65\0\x6d\x61\x78\x5f\x65\x6e\x74\x72\x69\x65\x73\0\x6b\x65\
-\x79\0\x76\x61\x6c\x75\x65\0\x65\x76\x65\x6e\x74\x73\0\x74\x72\x61\x63\x65\x5f\
-\x65\x76\x65\x6e\x74\x5f\x72\x61\x77\x5f\x73\x79\x73\x5f\x65\x6e\x74\x65\x72\0\
-\x65\x6e\x74\0\x69\x64\0\x61\x72\x67\x73\0\x5f\x5f\x64\x61\x74\x61\0\x74\x72\
-\x61\x63\x65\x5f\x65\x6e\x74\x72\x79\0\x66\x6c\x61\x67\x73\0\x70\x72\x65\x65\
-\x6d\x70\x74\x5f\x63\x6f\x75\x6e\x74\0\x70\x69\x64\0\x75\x6e\x73\x69\x67\x6e\
-\x65\x64\x20\x73\x68\x6f\x72\x74\0\x75\x6e\x73\x69\x67\x6e\x65\x64\x20\x63\x68\
-\x61\x72\0\x6c\x6f\x6e\x67\0\x75\x6e\x73\x69\x67\x6e\x65\x64\x20\x6c\x6f\x6e\
-\x67\0\x63\x68\x61\x72\0\x63\x74\x78\0\x74\x72\x61\x63\x65\x5f\x65\x78\x65\x63\
-\x76\x65\0\x74\x72\x61\x63\x65\x70\x6f\x69\x6e\x74\x2f\x73\x79\x73\x63\x61\x6c\
-\x6c\x73\x2f\x73\x79\x73\x5f\x65\x6e\x74\x65\x72\x5f\x65\x78\x65\x63\x76\x65\0\
-\x2f\x68\x6f\x6d\x65\x2f\x6d\x7a\x32\x2f\x44\x65\x73\x6b\x74\x6f\x70\x2f\x78\
-\x6c\x6b\x2f\x70\x72\x6f\x67\x72\x61\x6d\x5f\x61\x5f\x62\x70\x66\x2e\x63\0\x69\
-\x6e\x74\x20\x74\x72\x61\x63\x65\x5f\x65\x78\x65\x63\x76\x65\x28\x73\x74\x72\
-\x75\x63\x74\x20\x74\x72\x61\x63\x65\x5f\x65\x76\x65\x6e\x74\x5f\x72\x61\x77\
-\x5f\x73\x79\x73\x5f\x65\x6e\x74\x65\x72\x20\x2a\x63\x74\x78\x29\x20\x7b\0\x20\
-\x20\x20\x20\x75\x33\x32\x20\x70\x69\x64\x20\x3d\x20\x62\x70\x66\x5f\x67\x65\
-\x74\x5f\x63\x75\x72\x72\x65\x6e\x74\x5f\x70\x69\x64\x5f\x74\x67\x69\x64\x28\
-\x29\x20\x3e\x3e\x20\x33\x32\x3b\x20\x20\x2f\x2f\x20\xe8\x8e\xb7\xe5\x8f\x96\
-\xe5\xbd\x93\xe5\x89\x8d\xe8\xbf\x9b\xe7\xa8\x8b\xe7\x9a\x84\x20\x50\x49\x44\0\
-\x20\x20\x20\x20\x62\x70\x66\x5f\x70\x65\x72\x66\x5f\x65\x76\x65\x6e\x74\x5f\
-\x6f\x75\x74\x70\x75\x74\x28\x63\x74\x78\x2c\x20\x26\x65\x76\x65\x6e\x74\x73\
-\x2c\x20\x42\x50\x46\x5f\x46\x5f\x43\x55\x52\x52\x45\x4e\x54\x5f\x43\x50\x55\
-\x2c\x20\x26\x70\x69\x64\x2c\x20\x73\x69\x7a\x65\x6f\x66\x28\x70\x69\x64\x29\
-\x29\x3b\0\x20\x20\x20\x20\x72\x65\x74\x75\x72\x6e\x20\x30\x3b\0\x4c\x49\x43\
-\x45\x4e\x53\x45\0\x2e\x6d\x61\x70\x73\0\x6c\x69\x63\x65\x6e\x73\x65\0\0\x9f\
-\xeb\x01\0\x20\0\0\0\0\0\0\0\x14\0\0\0\x14\0\0\0\x7c\0\0\0\x90\0\0\0\0\0\0\0\
-\x08\0\0\0\xe9\0\0\0\x01\0\0\0\0\0\0\0\x18\0\0\0\x10\0\0\0\xe9\0\0\0\x07\0\0\0\
-\0\0\0\0\x0e\x01\0\0\x34\x01\0\0\0\x48\0\0\x08\0\0\0\x0e\x01\0\0\x6e\x01\0\0\
-\x0f\x4c\0\0\x10\0\0\0\x0e\x01\0\0\x6e\x01\0\0\x2a\x4c\0\0\x18\0\0\0\x0e\x01\0\
-\0\x6e\x01\0\0\x09\x4c\0\0\x28\0\0\0\x0e\x01\0\0\0\0\0\0\0\0\0\0\x30\0\0\0\x0e\
-\x01\0\0\xbc\x01\0\0\x05\x58\0\0\x68\0\0\0\x0e\x01\0\0\x0b\x02\0\0\x05\x60\0\0\
-\0\0\0\0\x0c\0\0\0\xff\xff\xff\xff\x04\0\x08\0\x08\x7c\x0b\0\x14\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\x78\0\0\0\0\0\0\0\x9b\0\0\0\x05\0\x08\0\x69\0\0\0\x08\x01\x01\
-\xfb\x0e\x0d\0\x01\x01\x01\x01\0\0\0\x01\0\0\x01\x01\x01\x1f\x03\0\0\0\0\x16\0\
-\0\0\x18\0\0\0\x03\x01\x1f\x02\x0f\x05\x1e\x03\x29\0\0\0\0\x8d\x8a\x8d\xef\xed\
-\xcc\x07\x4c\x46\x86\x49\x3a\x5d\xdf\x8b\xb8\x39\0\0\0\x01\x06\xb1\x0c\x70\x72\
-\xc1\x44\xbb\xba\xee\x94\xd3\x5a\x59\xfb\x4a\x43\0\0\0\x02\xea\xdf\x4a\x8b\xcf\
-\x7a\xc4\xe7\xbd\x6d\x2c\xb6\x66\x45\x22\x42\x04\0\0\x09\x02\0\0\0\0\0\0\0\0\
-\x03\x11\x01\x05\x0f\x0a\x21\x05\x2a\x06\x20\x05\x09\x20\x03\x6d\x20\x05\x05\
-\x06\x03\x16\x2e\x76\x02\x02\0\x01\x01\x2f\x68\x6f\x6d\x65\x2f\x6d\x7a\x32\x2f\
-\x44\x65\x73\x6b\x74\x6f\x70\x2f\x78\x6c\x6b\0\x2e\0\x2f\x75\x73\x72\x2f\x69\
-\x6e\x63\x6c\x75\x64\x65\x2f\x62\x70\x66\0\x70\x72\x6f\x67\x72\x61\x6d\x5f\x61\
-\x5f\x62\x70\x66\x2e\x63\0\x76\x6d\x6c\x69\x6e\x75\x78\x2e\x68\0\x62\x70\x66\
-\x5f\x68\x65\x6c\x70\x65\x72\x5f\x64\x65\x66\x73\x2e\x68\0\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xfe\0\0\0\x04\0\xf1\xff\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\x03\0\x03\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x03\
-\0\x07\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x03\0\x08\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\x03\0\x0b\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x03\
-\0\x0d\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x03\0\x0e\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\x03\0\x14\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x03\
-\0\x16\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x03\0\x18\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\xc8\0\0\0\x12\0\x03\0\0\0\0\0\0\0\0\0\x78\0\0\0\0\0\0\0\x32\0\0\
-\0\x11\0\x05\0\0\0\0\0\0\0\0\0\x20\0\0\0\0\0\0\0\x27\x01\0\0\x11\0\x06\0\0\0\0\
-\0\0\0\0\0\x04\0\0\0\0\0\0\0\x38\0\0\0\0\0\0\0\x01\0\0\0\x0c\0\0\0\x08\0\0\0\0\
-\0\0\0\x03\0\0\0\x04\0\0\0\x11\0\0\0\0\0\0\0\x03\0\0\0\x05\0\0\0\x15\0\0\0\0\0\
-\0\0\x03\0\0\0\x09\0\0\0\x1f\0\0\0\0\0\0\0\x03\0\0\0\x07\0\0\0\x23\0\0\0\0\0\0\
-\0\x03\0\0\0\x03\0\0\0\x08\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x0c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x10\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x14\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x18\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x1c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x20\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x24\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x28\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x2c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x30\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x34\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x38\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x3c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x40\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x44\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x48\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x4c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x50\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x54\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x58\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x5c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x60\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x64\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x68\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x6c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x70\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x74\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x78\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x7c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x80\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x84\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x88\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x8c\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x90\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x94\0\0\0\0\0\0\0\
-\x03\0\0\0\x06\0\0\0\x98\0\0\0\0\0\0\0\x03\0\0\0\x06\0\0\0\x08\0\0\0\0\0\0\0\
-\x02\0\0\0\x0d\0\0\0\x10\0\0\0\0\0\0\0\x02\0\0\0\x0c\0\0\0\x18\0\0\0\0\0\0\0\
-\x02\0\0\0\x02\0\0\0\x5c\x02\0\0\0\0\0\0\x04\0\0\0\x0c\0\0\0\x74\x02\0\0\0\0\0\
-\0\x04\0\0\0\x0d\0\0\0\x2c\0\0\0\0\0\0\0\x04\0\0\0\x02\0\0\0\x40\0\0\0\0\0\0\0\
-\x04\0\0\0\x02\0\0\0\x50\0\0\0\0\0\0\0\x04\0\0\0\x02\0\0\0\x60\0\0\0\0\0\0\0\
-\x04\0\0\0\x02\0\0\0\x70\0\0\0\0\0\0\0\x04\0\0\0\x02\0\0\0\x80\0\0\0\0\0\0\0\
-\x04\0\0\0\x02\0\0\0\x90\0\0\0\0\0\0\0\x04\0\0\0\x02\0\0\0\xa0\0\0\0\0\0\0\0\
-\x04\0\0\0\x02\0\0\0\x14\0\0\0\0\0\0\0\x03\0\0\0\x08\0\0\0\x18\0\0\0\0\0\0\0\
-\x02\0\0\0\x02\0\0\0\x22\0\0\0\0\0\0\0\x03\0\0\0\x0a\0\0\0\x26\0\0\0\0\0\0\0\
-\x03\0\0\0\x0a\0\0\0\x2a\0\0\0\0\0\0\0\x03\0\0\0\x0a\0\0\0\x36\0\0\0\0\0\0\0\
-\x03\0\0\0\x0a\0\0\0\x4b\0\0\0\0\0\0\0\x03\0\0\0\x0a\0\0\0\x60\0\0\0\0\0\0\0\
-\x03\0\0\0\x0a\0\0\0\x7a\0\0\0\0\0\0\0\x02\0\0\0\x02\0\0\0\x0b\x0c\x0d\0\x2e\
-\x64\x65\x62\x75\x67\x5f\x61\x62\x62\x72\x65\x76\0\x2e\x74\x65\x78\x74\0\x2e\
-\x72\x65\x6c\x2e\x42\x54\x46\x2e\x65\x78\x74\0\x2e\x64\x65\x62\x75\x67\x5f\x6c\
-\x6f\x63\x6c\x69\x73\x74\x73\0\x65\x76\x65\x6e\x74\x73\0\x2e\x72\x65\x6c\x2e\
-\x64\x65\x62\x75\x67\x5f\x73\x74\x72\x5f\x6f\x66\x66\x73\x65\x74\x73\0\x2e\x6d\
-\x61\x70\x73\0\x2e\x64\x65\x62\x75\x67\x5f\x73\x74\x72\0\x2e\x64\x65\x62\x75\
-\x67\x5f\x6c\x69\x6e\x65\x5f\x73\x74\x72\0\x2e\x72\x65\x6c\x2e\x64\x65\x62\x75\
-\x67\x5f\x61\x64\x64\x72\0\x2e\x72\x65\x6c\x2e\x64\x65\x62\x75\x67\x5f\x69\x6e\
-\x66\x6f\0\x2e\x6c\x6c\x76\x6d\x5f\x61\x64\x64\x72\x73\x69\x67\0\x2e\x72\x65\
-\x6c\x74\x72\x61\x63\x65\x70\x6f\x69\x6e\x74\x2f\x73\x79\x73\x63\x61\x6c\x6c\
-\x73\x2f\x73\x79\x73\x5f\x65\x6e\x74\x65\x72\x5f\x65\x78\x65\x63\x76\x65\0\x74\
-\x72\x61\x63\x65\x5f\x65\x78\x65\x63\x76\x65\0\x6c\x69\x63\x65\x6e\x73\x65\0\
-\x2e\x72\x65\x6c\x2e\x64\x65\x62\x75\x67\x5f\x6c\x69\x6e\x65\0\x2e\x72\x65\x6c\
-\x2e\x64\x65\x62\x75\x67\x5f\x66\x72\x61\x6d\x65\0\x70\x72\x6f\x67\x72\x61\x6d\
-\x5f\x61\x5f\x62\x70\x66\x2e\x63\0\x2e\x73\x74\x72\x74\x61\x62\0\x2e\x73\x79\
-\x6d\x74\x61\x62\0\x2e\x72\x65\x6c\x2e\x42\x54\x46\0\x4c\x49\x43\x45\x4e\x53\
-\x45\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x0e\x01\0\
-\0\x03\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x73\x12\0\0\0\0\0\0\x2f\x01\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x0f\0\0\0\x01\0\0\0\
-\x06\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x40\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\x04\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xa3\0\0\0\x01\0\0\0\x06\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\x40\0\0\0\0\0\0\0\x78\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x08\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\x9f\0\0\0\x09\0\0\0\x40\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\x60\x0e\0\0\0\0\0\0\x10\0\0\0\0\0\0\0\x1a\0\0\0\x03\0\0\0\x08\0\0\0\0\0\0\0\
-\x10\0\0\0\0\0\0\0\x50\0\0\0\x01\0\0\0\x03\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xb8\0\
-\0\0\0\0\0\0\x20\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x08\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\0\xd5\0\0\0\x01\0\0\0\x03\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xd8\0\0\0\0\0\0\0\x04\
-\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x22\0\0\0\x01\
-\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xdc\0\0\0\0\0\0\0\x2b\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x01\0\0\0\x01\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\x07\x01\0\0\0\0\0\0\x30\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x85\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\x37\x02\0\0\0\0\0\0\xe2\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x01\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\x81\0\0\0\x09\0\0\0\x40\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x70\
-\x0e\0\0\0\0\0\0\x50\0\0\0\0\0\0\0\x1a\0\0\0\x09\0\0\0\x08\0\0\0\0\0\0\0\x10\0\
-\0\0\0\0\0\0\x3d\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x19\x04\0\0\0\
-\0\0\0\x9c\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x39\
-\0\0\0\x09\0\0\0\x40\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xc0\x0e\0\0\0\0\0\0\x50\x02\
-\0\0\0\0\0\0\x1a\0\0\0\x0b\0\0\0\x08\0\0\0\0\0\0\0\x10\0\0\0\0\0\0\0\x56\0\0\0\
-\x01\0\0\0\x30\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xb5\x04\0\0\0\0\0\0\xba\x01\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\x01\0\0\0\0\0\0\0\x01\0\0\0\0\0\0\0\x75\0\0\0\x01\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x6f\x06\0\0\0\0\0\0\x20\0\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x71\0\0\0\x09\0\0\0\x40\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\x10\x11\0\0\0\0\0\0\x30\0\0\0\0\0\0\0\x1a\0\0\0\x0e\0\0\0\
-\x08\0\0\0\0\0\0\0\x10\0\0\0\0\0\0\0\x22\x01\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\x90\x06\0\0\0\0\0\0\xab\x04\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x04\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\x1e\x01\0\0\x09\0\0\0\x40\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\0\x40\x11\0\0\0\0\0\0\x20\0\0\0\0\0\0\0\x1a\0\0\0\x10\0\0\0\x08\0\0\0\0\0\0\0\
-\x10\0\0\0\0\0\0\0\x19\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x3c\x0b\
-\0\0\0\0\0\0\xb0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x04\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\0\x15\0\0\0\x09\0\0\0\x40\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x60\x11\0\0\0\0\0\0\
-\x80\0\0\0\0\0\0\0\x1a\0\0\0\x12\0\0\0\x08\0\0\0\0\0\0\0\x10\0\0\0\0\0\0\0\xf1\
-\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xf0\x0b\0\0\0\0\0\0\x28\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\x08\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xed\0\0\0\x09\0\0\0\
-\x40\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xe0\x11\0\0\0\0\0\0\x20\0\0\0\0\0\0\0\x1a\0\
-\0\0\x14\0\0\0\x08\0\0\0\0\0\0\0\x10\0\0\0\0\0\0\0\xe1\0\0\0\x01\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\0\0\0\0\0\0\x18\x0c\0\0\0\0\0\0\x9f\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\x01\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\xdd\0\0\0\x09\0\0\0\x40\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\0\0\x12\0\0\0\0\0\0\x70\0\0\0\0\0\0\0\x1a\0\0\0\x16\0\0\0\x08\0\0\0\0\
-\0\0\0\x10\0\0\0\0\0\0\0\x61\0\0\0\x01\0\0\0\x30\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\
-\xb7\x0c\0\0\0\0\0\0\x55\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x01\0\0\0\0\0\0\0\x01\0\
-\0\0\0\0\0\0\x91\0\0\0\x03\x4c\xff\x6f\0\0\0\x80\0\0\0\0\0\0\0\0\0\0\0\0\x70\
-\x12\0\0\0\0\0\0\x03\0\0\0\0\0\0\0\x1a\0\0\0\0\0\0\0\x01\0\0\0\0\0\0\0\0\0\0\0\
-\0\0\0\0\x16\x01\0\0\x02\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x10\x0d\0\0\0\0\
-\0\0\x50\x01\0\0\0\0\0\0\x01\0\0\0\x0b\0\0\0\x08\0\0\0\0\0\0\0\x18\0\0\0\0\0\0\
-\0";
-
-	*sz = sizeof(data) - 1;
-	return (const void *)data;
-}
-
-#ifdef __cplusplus
-struct program_a_bpf *program_a_bpf::open(const struct bpf_object_open_opts *opts) { return program_a_bpf__open_opts(opts); }
-struct program_a_bpf *program_a_bpf::open_and_load() { return program_a_bpf__open_and_load(); }
-int program_a_bpf::load(struct program_a_bpf *skel) { return program_a_bpf__load(skel); }
-int program_a_bpf::attach(struct program_a_bpf *skel) { return program_a_bpf__attach(skel); }
-void program_a_bpf::detach(struct program_a_bpf *skel) { program_a_bpf__detach(skel); }
-void program_a_bpf::destroy(struct program_a_bpf *skel) { program_a_bpf__destroy(skel); }
-const void *program_a_bpf::elf_bytes(size_t *sz) { return program_a_bpf__elf_bytes(sz); }
-#endif /* __cplusplus */
-
-__attribute__((unused)) static void
-program_a_bpf__assert(struct program_a_bpf *s __attribute__((unused)))
-{
-#ifdef __cplusplus
-#define _Static_assert static_assert
-#endif
-#ifdef __cplusplus
-#undef _Static_assert
-#endif
-}
-
-#endif /* __PROGRAM_A_BPF_SKEL_H__ */
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <bpf/libbpf.h>
+#include <bpf/bpf.h>
+#include "program_a_bpf.skel.h"
+#include "collect.h"
+#include "perf_monitor.h"
+#include "sample_job.h"
+#include "corpus.h"
+
+// 并行样本执行器：替代 run_sample.sh。BPF 程序只加载一次，同时运行多个样本，
+// 每个样本放在独立的 cgroup 中（可选绑定到独立 CPU），execve 事件按 cgroup 归到样本，
+// 为样本内每个进程启动采集线程，结果写入 data/data_a_<样本号>/。超时的样本整组终止。
+// 指定样本库索引时在索引中记录每个样本的采集状态，中断后重新运行跳过已完成的样本
+
+#define DEFAULT_CGROUP_BASE SAMPLE_CGROUP_ROOT "/kleb_samples"
+#define MAX_SLOTS 256
+#define POLL_MS 10
+
+static volatile sig_atomic_t exiting = 0;
+static struct event_set active_events;
+static struct sample_job slots[MAX_SLOTS];
+static int slot_count = 4;
+static struct corpus *corpus;
+static struct corpus_entry *slot_entries[MAX_SLOTS];    // 槽位对应的索引条目，不在索引中为 NULL
+
+static void handle_signal(int sig) {
+    exiting = 1;
+}
+
+static long elapsed_ms(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+// execve 事件：只处理位于样本 cgroup 中的进程
+static void handle_event(void *ctx, int cpu, void *data, __u32 data_sz) {
+    if (data_sz < sizeof(struct sample_exec_event))
+        return;
+    const struct sample_exec_event *event = data;
+    struct sample_job *slot = sample_job_find(slots, slot_count, event);
+    if (slot)
+        sample_job_collect(slot, event->pid, &active_events);
+}
+
+static void handle_lost(void *ctx, int cpu, __u64 cnt) {
+    fprintf(stderr, "警告：CPU %d 丢失 %llu 个 execve 事件\n", cpu, (unsigned long long)cnt);
+}
+
+// 推进各槽位状态，返回仍在使用的槽位数
+static int service_slots(int *completed) {
+    int busy = 0;
+    sample_jobs_reap(slots, slot_count);
+    for (int i = 0; i < slot_count; i++) {
+        struct sample_job *slot = &slots[i];
+        if (slot->state == JOB_FREE)
+            continue;
+        if (!sample_job_service(slot, exiting)) {
+            busy++;
+            continue;
+        }
+        printf("样本 %d 完成：%d 个进程，%ld ms%s，数据保存至 %s\n", slot->id, slot->processes,
+               sample_job_elapsed_ms(slot), slot->timed_out ? "（超时终止）" : "",
+               slot->dataset ? "数据集" : slot->data_dir);
+        (*completed)++;
+        struct corpus_entry *entry = slot_entries[i];
+        if (entry) {
+            // 因退出而提前终止的样本下次重新采集；一个进程都没有采到（样本未能启动）记为失败
+            enum corpus_status status = slot->timed_out ? CORPUS_TIMEOUT : CORPUS_DONE;
+            if (exiting)
+                status = CORPUS_PENDING;
+            else if (slot->processes == 0)
+                status = CORPUS_FAILED;
+            entry->processes = slot->processes;
+            entry->data_end = slot->dataset ? kds_writer_offset(slot->dataset) : 0;
+            corpus_set_status(entry, status);
+            slot_entries[i] = NULL;
+        }
+    }
+    return busy;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "用法: %s [-j 并发数] [-t 超时ms] [-r 采样行数] [-C] [-e 事件列表 | -E 事件文件] [-U]\n"
+            "          [-s 样本目录] [-o 数据目录] [-g cgroup目录] [-f 起始样本号] [-n 样本数]\n"
+            "          [-D 数据集文件 [-z 压缩] [-M 映射文件]] [-I 样本库索引]\n"
+            "  -j N     同时运行的样本数（默认 CPU 数）\n"
+            "  -t MS    每个样本的运行上限，超时后终止整个 cgroup（默认 1000）\n"
+            "  -r ROWS  每个进程采集的行数，每行 10ms（默认 10）\n"
+            "  -C       每个样本绑定到独立的 CPU（cpuset 与 CPU 亲和性）\n"
+            "  -U       每行在计数器之后追加进程的资源列（CPU 时间、缺页、RSS），事件最多 4 个\n"
+            "  -s DIR   样本目录，样本文件名为样本号（默认 sample）\n"
+            "  -o DIR   数据目录（默认 data）\n"
+            "  -g DIR   样本 cgroup 的父目录（默认 " DEFAULT_CGROUP_BASE "）\n"
+            "  -f N     起始样本号（默认 1）\n"
+            "  -n N     样本数（默认 10000；指定 -I 时为索引中的全部样本）\n"
+            "  -D FILE  写入列式数据集文件（.kds，可续写），不再生成 CSV\n"
+            "  -z CODEC 数据集压缩方式 none / zstd / lz4（默认 none）\n"
+            "  -M FILE  md5_mapping.txt，把样本哈希写入数据集\n"
+            "  -I FILE  样本库索引（code/corpus_tool build 生成）：只运行索引中的样本，跳过已完成的，\n"
+            "           记录每个样本的采集状态；样本哈希取自索引\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    const char *event_list = NULL, *event_file = NULL;
+    const char *sample_dir = "sample", *data_base = "data", *cgroup_base = DEFAULT_CGROUP_BASE;
+    const char *dataset_path = NULL, *mapping_path = NULL, *corpus_path = NULL;
+    int first = 1, total = 0, pin = 0, resources = 0, rows = 10, timeout_ms = 1000, codec = KDS_CODEC_NONE;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    slot_count = ncpu > 0 ? (ncpu < MAX_SLOTS ? ncpu : MAX_SLOTS) : 4;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:t:r:Ce:E:Us:o:g:f:n:D:z:M:I:h")) != -1) {
+        switch (opt) {
+        case 'j':
+            slot_count = atoi(optarg);
+            break;
+        case 't':
+            timeout_ms = atoi(optarg);
+            break;
+        case 'r':
+            rows = atoi(optarg);
+            break;
+        case 'C':
+            pin = 1;
+            break;
+        case 'e':
+            event_list = optarg;
+            break;
+        case 'E':
+            event_file = optarg;
+            break;
+        case 'U':
+            resources = 1;
+            break;
+        case 's':
+            sample_dir = optarg;
+            break;
+        case 'o':
+            data_base = optarg;
+            break;
+        case 'g':
+            cgroup_base = optarg;
+            break;
+        case 'f':
+            first = atoi(optarg);
+            break;
+        case 'D':
+            dataset_path = optarg;
+            break;
+        case 'z':
+            if ((codec = kds_codec_parse(optarg)) < 0)
+                return 1;
+            break;
+        case 'M':
+            mapping_path = optarg;
+            break;
+        case 'I':
+            corpus_path = optarg;
+            break;
+        case 'n':
+            total = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (slot_count <= 0 || slot_count > MAX_SLOTS || timeout_ms <= 0 || rows <= 0 ||
+        rows > TOTAL_SAMPLES || total < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (event_list) {
+        if (event_set_parse(&active_events, event_list) != 0)
+            return 1;
+    } else if (event_file) {
+        if (event_set_load(&active_events, event_file) != 0)
+            return 1;
+    } else {
+        event_set_default(&active_events);
+    }
+    struct event_set columns;
+    if (collect_columns(&active_events, resources, &columns) != 0)
+        return 1;
+
+    struct stat st;
+    if (stat(sample_dir, &st) == -1 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "错误：样本目录 %s 不存在\n", sample_dir);
+        return 1;
+    }
+    if (mkdir(data_base, 0755) == -1 && errno != EEXIST) {
+        fprintf(stderr, "错误：无法创建数据目录 %s: %s\n", data_base, strerror(errno));
+        return 1;
+    }
+    if (sample_cgroup_base(cgroup_base, pin) != 0)
+        return 1;
+
+    // 所有样本写入同一个数据集文件
+    struct kds_writer *dataset = NULL;
+    uint8_t *hashes = NULL;
+    uint32_t mapped = 0;
+    if (mapping_path && !(hashes = kds_mapping_load(mapping_path, &mapped)))
+        return 1;
+    if (dataset_path && !(dataset = kds_writer_open(dataset_path, &columns, codec)))
+        return 1;
+    if (corpus_path) {
+        if (!(corpus = corpus_open(corpus_path, 1)))
+            return 1;
+        size_t recovered = corpus_recover(corpus);
+        if (recovered)
+            printf("上次运行中断的 %zu 个样本将重新采集\n", recovered);
+    }
+    if (total == 0)
+        total = corpus ? (int)corpus->header->capacity - first : 10000;
+
+    for (int i = 0; i < slot_count; i++) {
+        slots[i].cpu = pin ? i % ncpu : -1;
+        slots[i].rows = rows;
+        slots[i].timeout_ms = timeout_ms;
+        slots[i].dataset = dataset;
+        slots[i].resources = resources;
+    }
+
+    struct rlimit rlim = {RLIM_INFINITY, RLIM_INFINITY};
+    setrlimit(RLIMIT_MEMLOCK, &rlim);
+
+    struct program_a_bpf *skel = program_a_bpf__open_and_load();
+    if (!skel) {
+        fprintf(stderr, "无法打开和加载 BPF 框架\n");
+        return 1;
+    }
+    if (program_a_bpf__attach(skel)) {
+        fprintf(stderr, "无法附加 BPF 程序\n");
+        program_a_bpf__destroy(skel);
+        return 1;
+    }
+    struct perf_buffer_opts opts = { .sample_cb = handle_event, .lost_cb = handle_lost };
+    struct perf_buffer *pb = perf_buffer__new(bpf_map__fd(skel->maps.events), 64, &opts);
+    if (!pb) {
+        fprintf(stderr, "无法创建性能缓冲区\n");
+        program_a_bpf__destroy(skel);
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    // 整个执行器一份资源占用记录，代替每个采集线程各自的 usage 文件。
+    // 执行器可能运行数小时，边采边写盘，内存占用固定
+    char usage_path[PATH_MAX];
+    snprintf(usage_path, sizeof(usage_path), "%s/usage_runner.csv", data_base);
+    PerformanceMonitor *monitor = perf_monitor_create(1000);
+    if (monitor && perf_monitor_stream(monitor, usage_path) != 0) {
+        perf_monitor_destroy(monitor);
+        monitor = NULL;
+    }
+    if (monitor)
+        perf_monitor_start(monitor);
+
+    struct timespec run_start;
+    clock_gettime(CLOCK_MONOTONIC, &run_start);
+    int next = first, last = first + total - 1;
+    int started = 0, completed = 0, skipped = 0, collected = 0;
+
+    for (;;) {
+        // 填满空闲槽位
+        for (int i = 0; i < slot_count && next <= last && !exiting; i++) {
+            if (slots[i].state != JOB_FREE)
+                continue;
+            // 有索引时只运行索引中尚未完成的样本
+            struct corpus_entry *entry = corpus ? corpus_by_id(corpus, next) : NULL;
+            if (corpus && (!entry || !corpus_needs_collect(entry))) {
+                collected += entry != NULL;
+                next++;
+                i--;
+                continue;
+            }
+            char sample_path[PATH_MAX];
+            snprintf(sample_path, sizeof(sample_path), "%s/%d", sample_dir, next);
+            if (access(sample_path, X_OK) != 0) {
+                fprintf(stderr, "警告：样本 %s 不存在或不可执行，跳过\n", sample_path);
+                if (entry)
+                    corpus_set_status(entry, CORPUS_FAILED);
+                skipped++;
+                next++;
+                i--;
+                continue;
+            }
+            char name[32], data_dir[PATH_MAX];
+            snprintf(name, sizeof(name), "sample_%d", next);
+            snprintf(data_dir, sizeof(data_dir), "%s/data_a_%d", data_base, next);
+            slots[i].id = next;
+            slots[i].sample_id = next;
+            slots[i].attempt = 0;
+            slots[i].hash = (uint32_t)next < mapped ? hashes + (size_t)next * KDS_HASH_LEN : NULL;
+            if (entry) {
+                if (!slots[i].hash)
+                    slots[i].hash = entry->hash;
+                entry->attempts++;
+                slots[i].attempt = (uint8_t)entry->attempts;
+                entry->data_offset = dataset ? kds_writer_offset(dataset) : 0;
+                entry->data_end = 0;
+                corpus_set_status(entry, CORPUS_RUNNING);
+            }
+            if (sample_job_start(&slots[i], cgroup_base, name, sample_path, data_dir) == 0) {
+                slot_entries[i] = entry;
+                started++;
+            } else {
+                if (entry)
+                    corpus_set_status(entry, CORPUS_FAILED);
+                skipped++;
+            }
+            next++;
+        }
+
+        int err = perf_buffer__poll(pb, POLL_MS);
+        if (err < 0 && err != -EINTR) {
+            fprintf(stderr, "轮询性能缓冲区出错: %d\n", err);
+            exiting = 1;
+        }
+        int busy = service_slots(&completed);
+        if (busy == 0 && (next > last || exiting))
+            break;
+    }
+
+    double seconds = elapsed_ms(&run_start) / 1000.0;
+    printf("所有样本处理完成：启动 %d，完成 %d，跳过 %d，用时 %.1f s（%.1f 样本/s）\n",
+           started, completed, skipped, seconds, seconds > 0 ? completed / seconds : 0);
+    if (corpus) {
+        printf("索引中此前已完成 %d 个样本\n", collected);
+        corpus_sync(corpus);
+        corpus_close(corpus);
+    }
+
+    perf_buffer__free(pb);
+    program_a_bpf__destroy(skel);
+    perf_monitor_destroy(monitor);
+    if (dataset && kds_writer_close(dataset) == 0)
+        printf("数据集已保存至 %s\n", dataset_path);
+    free(hashes);
+    return 0;
+}
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "sample_job.h"
+#include "collect.h"
+
+#define MAX_PARENT_DEPTH 32
+
+struct collector_arg {
+    struct sample_job *job;
+    const struct event_set *events;
+    int pid;
+};
+
+static int write_file(const char *path, const char *value) {
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd == -1)
+        return -1;
+    ssize_t len = strlen(value);
+    int ret = write(fd, value, len) == len ? 0 : -1;
+    close(fd);
+    return ret;
+}
+
+long sample_job_elapsed_ms(const struct sample_job *job) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - job->start.tv_sec) * 1000 + (now.tv_nsec - job->start.tv_nsec) / 1000000;
+}
+
+// 在 base 上启用 cpuset 控制器，失败时只绑定 CPU 亲和性
+int sample_cgroup_base(const char *base, int pin) {
+    if (mkdir(base, 0755) == -1 && errno != EEXIST) {
+        fprintf(stderr, "创建 cgroup %s 失败: %s\n", base, strerror(errno));
+        return -1;
+    }
+    if (pin) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/cgroup.subtree_control", SAMPLE_CGROUP_ROOT);
+        write_file(path, "+cpuset");
+        snprintf(path, sizeof(path), "%s/cgroup.subtree_control", base);
+        if (write_file(path, "+cpuset") != 0)
+            fprintf(stderr, "无法在 %s 启用 cpuset，仅设置 CPU 亲和性: %s\n", base, strerror(errno));
+    }
+    return 0;
+}
+
+// 创建作业 cgroup 并启动样本：子进程先加入 cgroup（或新建进程组）并绑定 CPU，再 execve
+int sample_job_start(struct sample_job *job, const char *cgroup_base, const char *name,
+                     const char *sample_path, const char *data_dir) {
+    char path[PATH_MAX + 32];
+    job->cgroup[0] = '\0';
+    job->cgroup_id = 0;
+    if (cgroup_base) {
+        snprintf(job->cgroup, sizeof(job->cgroup), "%s/%s", cgroup_base, name);
+        if (mkdir(job->cgroup, 0755) == -1 && errno != EEXIST) {
+            fprintf(stderr, "创建 cgroup %s 失败: %s\n", job->cgroup, strerror(errno));
+            return -1;
+        }
+        struct stat st;
+        if (stat(job->cgroup, &st) == -1) {
+            fprintf(stderr, "stat %s 失败: %s\n", job->cgroup, strerror(errno));
+            rmdir(job->cgroup);
+            return -1;
+        }
+        // bpf_get_current_cgroup_id() 即 cgroup 目录的 inode
+        job->cgroup_id = st.st_ino;
+        if (job->cpu >= 0) {
+            char cpu[16];
+            snprintf(cpu, sizeof(cpu), "%d", job->cpu);
+            snprintf(path, sizeof(path), "%s/cpuset.cpus", job->cgroup);
+            write_file(path, cpu);
+        }
+    }
+
+    job->timed_out = 0;
+    job->processes = 0;
+    atomic_store(&job->collectors, 0);
+    snprintf(job->data_dir, sizeof(job->data_dir), "%s", data_dir);
+    // 先登记再 fork，样本的第一个 execve 事件到达时已能找到所属作业
+    job->state = JOB_RUNNING;
+    clock_gettime(CLOCK_MONOTONIC, &job->start);
+
+    snprintf(path, sizeof(path), "%s/cgroup.procs", job->cgroup);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (job->cgroup_id && write_file(path, "0") != 0) {
+            fprintf(stderr, "加入 cgroup %s 失败: %s\n", job->cgroup, strerror(errno));
+            _exit(126);
+        }
+        setpgid(0, 0);
+        if (job->cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(job->cpu, &set);
+            sched_setaffinity(0, sizeof(set), &set);
+        }
+        execl(sample_path, sample_path, (char *)NULL);
+        _exit(127);
+    }
+    if (pid == -1) {
+        perror("fork");
+        job->state = JOB_FREE;
+        if (job->cgroup_id)
+            rmdir(job->cgroup);
+        return -1;
+    }
+    job->pid = pid;
+    return 0;
+}
+
+static pid_t parent_of(pid_t pid) {
+    char path[64], buf[512];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return -1;
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0)
+        return -1;
+    buf[len] = '\0';
+    // comm 可能包含空格和括号，从最后一个 ')' 之后解析
+    char *p = strrchr(buf, ')');
+    int ppid;
+    if (!p || sscanf(p + 1, " %*c %d", &ppid) != 1)
+        return -1;
+    return ppid;
+}
+
+struct sample_job *sample_job_find(struct sample_job *jobs, int count,
+                                   const struct sample_exec_event *event) {
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].state == JOB_RUNNING && jobs[i].cgroup_id &&
+            jobs[i].cgroup_id == event->cgroup_id)
+            return &jobs[i];
+    }
+    // 未使用 cgroup 的作业：沿父进程链找到样本进程
+    pid_t pid = event->pid;
+    for (int depth = 0; depth < MAX_PARENT_DEPTH && pid > 1; depth++) {
+        for (int i = 0; i < count; i++) {
+            if (jobs[i].state == JOB_RUNNING && !jobs[i].cgroup_id && jobs[i].pid == pid)
+                return &jobs[i];
+        }
+        pid = parent_of(pid);
+    }
+    return NULL;
+}
+
+static void *collector_thread(void *arg) {
+    struct collector_arg *carg = arg;
+    struct sample_job *job = carg->job;
+    struct collect_output out = {
+        .dir = job->data_dir,
+        .dataset = job->dataset,
+        .sample_id = job->sample_id,
+        .attempt = job->attempt,
+        .hash = job->hash,
+        .resources = job->resources,
+    };
+    collect_perf_events(carg->pid, carg->events, &out, job->rows, 0);
+    atomic_fetch_sub(&job->collectors, 1);
+    free(carg);
+    return NULL;
+}
+
+int sample_job_collect(struct sample_job *job, int pid, const struct event_set *events) {
+    struct collector_arg *carg = malloc(sizeof(*carg));
+    if (!carg) {
+        perror("malloc");
+        return -1;
+    }
+    carg->job = job;
+    carg->events = events;
+    carg->pid = pid;
+    atomic_fetch_add(&job->collectors, 1);
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, collector_thread, carg) != 0) {
+        perror("pthread_create");
+        atomic_fetch_sub(&job->collectors, 1);
+        free(carg);
+        return -1;
+    }
+    pthread_detach(tid);
+    job->processes++;
+    return 0;
+}
+
+// 终止作业内的所有进程（cgroup.kill 需要 5.14+，否则逐个 kill）
+static void kill_job(struct sample_job *job) {
+    if (!job->cgroup_id) {
+        kill(-job->pid, SIGKILL);
+        return;
+    }
+    char path[PATH_MAX + 32];
+    snprintf(path, sizeof(path), "%s/cgroup.kill", job->cgroup);
+    if (write_file(path, "1") == 0)
+        return;
+    snprintf(path, sizeof(path), "%s/cgroup.procs", job->cgroup);
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        kill(job->pid, SIGKILL);
+        return;
+    }
+    int pid;
+    while (fscanf(file, "%d", &pid) == 1)
+        kill(pid, SIGKILL);
+    fclose(file);
+}
+
+void sample_jobs_reap(struct sample_job *jobs, int count) {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (int i = 0; i < count; i++) {
+            if (jobs[i].state == JOB_RUNNING && jobs[i].pid == pid)
+                jobs[i].state = JOB_DRAINING;
+        }
+    }
+}
+
+int sample_job_service(struct sample_job *job, int stop) {
+    if (job->state == JOB_RUNNING && (stop || sample_job_elapsed_ms(job) >= job->timeout_ms)) {
+        job->timed_out = !stop;
+        kill_job(job);
+        // 仍等待 waitpid 回收后进入 DRAINING
+        return 0;
+    }
+    if (job->state != JOB_DRAINING)
+        return 0;
+    // 样本本身退出后，残留的子进程一并终止
+    kill_job(job);
+    if (atomic_load(&job->collectors) > 0)
+        return 0;
+    if (job->cgroup_id && rmdir(job->cgroup) == -1)
+        return 0;
+    job->state = JOB_FREE;
+    return 1;
+}
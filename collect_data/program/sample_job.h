@@ -0,0 +1,74 @@
+#ifndef SAMPLE_JOB_H
+#define SAMPLE_JOB_H
+
+#include <stdint.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/types.h>
+#include "event_set.h"
+#include "dataset.h"
+
+// 样本作业：在独立的 cgroup（或进程组）中运行一个样本，把 execve 事件归到作业，
+// 为作业内每个新进程启动采集线程。run_samples 与 collect_server 共用。
+// 除采集线程外，所有函数都只在轮询 perf buffer 的线程中调用
+
+#define SAMPLE_CGROUP_ROOT "/sys/fs/cgroup"
+
+// BPF 程序输出的 execve 事件
+struct sample_exec_event {
+    uint32_t pid;
+    uint32_t pad;
+    uint64_t cgroup_id;
+};
+
+enum job_state {
+    JOB_FREE = 0,
+    JOB_RUNNING,        // 样本进程运行中
+    JOB_DRAINING,       // 样本已结束或被终止，等待采集线程和 cgroup 清空
+};
+
+struct sample_job {
+    enum job_state state;
+    int id;
+    int cpu;                    // 绑定的 CPU，-1 表示不绑定
+    int rows;                   // 每个进程采集的行数
+    int timeout_ms;
+    struct kds_writer *dataset; // 非空时写入数据集而不是 data_dir 下的 CSV
+    uint32_t sample_id;         // 数据集分块的样本号
+    uint8_t attempt;            // 数据集分块的尝试序号（见 collect.h）
+    const uint8_t *hash;        // 样本哈希，写入数据集分块，可为 NULL
+    int resources;              // 同时记录进程的资源列（见 collect.h）
+    pid_t pid;                  // 样本进程，同时是进程组号
+    uint64_t cgroup_id;         // 0 表示未使用 cgroup，按父进程归属
+    char cgroup[PATH_MAX];
+    char data_dir[PATH_MAX];
+    struct timespec start;
+    int timed_out;
+    int processes;              // 已启动采集的进程数
+    atomic_int collectors;      // 运行中的采集线程
+};
+
+// 创建作业 cgroup 的父目录；pin 非 0 时尝试启用 cpuset 控制器
+int sample_cgroup_base(const char *base, int pin);
+
+// 启动样本。cgroup_base 非空时作业放在 <cgroup_base>/<name> 中，否则只放到新的进程组
+int sample_job_start(struct sample_job *job, const char *cgroup_base, const char *name,
+                     const char *sample_path, const char *data_dir);
+
+// 找到事件所属的运行中作业：cgroup 作业按 cgroup id 匹配，其余沿父进程链匹配
+struct sample_job *sample_job_find(struct sample_job *jobs, int count,
+                                   const struct sample_exec_event *event);
+
+// 为作业内的进程启动采集线程
+int sample_job_collect(struct sample_job *job, int pid, const struct event_set *events);
+
+// 回收已退出的样本进程，对应作业进入 DRAINING
+void sample_jobs_reap(struct sample_job *jobs, int count);
+
+// 推进作业状态：超时或 stop 时终止，全部清空后释放。返回 1 表示作业刚刚完成
+int sample_job_service(struct sample_job *job, int stop);
+
+long sample_job_elapsed_ms(const struct sample_job *job);
+
+#endif
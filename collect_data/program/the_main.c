@@ -7,24 +7,32 @@
 #include <sys/resource.h>
 #include <bpf/libbpf.h>
 #include <bpf/bpf.h>
+#include <getopt.h>
 #include "program_a_bpf.skel.h"
 #include "collect.h"
 
 // 线程工作数据
 struct thread_arg {
     int pid;
-    const char **events;
+    const struct event_set *events;
     char *sample_dir; // 新增样本子目录路径
 };
 
+// 是否在计数器之后追加目标进程的资源列
+static int record_resources = 0;
+
 void *monitor_thread(void *arg) {
     struct thread_arg *targ = arg;
-    collect_perf_events(targ->pid, targ->events, targ->sample_dir);
+    struct collect_output out = { .dir = targ->sample_dir, .resources = record_resources };
+    collect_perf_events(targ->pid, targ->events, &out, TOTAL_SAMPLES, 1);
     free(targ->sample_dir);
     free(targ);
     return NULL;
 }
 
+// 采集的事件集
+static struct event_set active_events;
+
 // BPF 和性能事件处理
 static volatile sig_atomic_t exiting = 0;
 
@@ -44,7 +52,7 @@ static void handle_event(void *ctx, int cpu, void *data, __u32 data_sz) {
         return;
     }
     targ->pid = pid;
-    targ->events = NULL;
+    targ->events = &active_events;
     targ->sample_dir = strdup((char *)ctx); // 从 ctx 获取样本子目录
     if (!targ->sample_dir) {
         perror("strdup");
@@ -61,10 +69,42 @@ static void handle_event(void *ctx, int cpu, void *data, __u32 data_sz) {
 }
 
 int main(int argc, char **argv) {
-    if (argc != 2) {
-        fprintf(stderr, "用法: %s <样本子目录>\n", argv[0]);
+    const char *event_list = NULL, *event_file = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "e:E:U")) != -1) {
+        switch (opt) {
+        case 'e':
+            event_list = optarg;
+            break;
+        case 'E':
+            event_file = optarg;
+            break;
+        case 'U':
+            record_resources = 1;
+            break;
+        default:
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "用法: %s [-e 事件列表 | -E 事件文件] [-U] <样本子目录>\n", argv[0]);
         return 1;
     }
+    const char *sample_dir = argv[optind];
+
+    if (event_list) {
+        if (event_set_parse(&active_events, event_list) != 0)
+            return 1;
+    } else if (event_file) {
+        if (event_set_load(&active_events, event_file) != 0)
+            return 1;
+    } else {
+        event_set_default(&active_events);
+    }
+    struct event_set columns;
+    if (collect_columns(&active_events, record_resources, &columns) != 0)
+        return 1;
 
     struct program_a_bpf *skel;
     int err;
@@ -85,7 +125,7 @@ int main(int argc, char **argv) {
     }
 
     struct perf_buffer *pb = NULL;
-    struct perf_buffer_opts opts = { .sample_cb = handle_event, .ctx = argv[1] };
+    struct perf_buffer_opts opts = { .sample_cb = handle_event, .ctx = (void *)sample_dir };
     pb = perf_buffer__new(bpf_map__fd(skel->maps.events), 8, &opts);
     if (!pb) {
         fprintf(stderr, "无法创建性能缓冲区\n");
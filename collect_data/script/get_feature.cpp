@@ -8,242 +8,17 @@
 #include <iterator>
 #include <vector>
 #include <iomanip>
-#include <mutex>
 #include <atomic>
 #include <algorithm>
+#include <memory>
 #include <sys/resource.h>
-
-// 性能数据结构体
-struct PerformanceData {
-    std::chrono::system_clock::time_point timestamp;
-    double cpu_usage;
-    size_t ram_usage;    // KB
-    size_t virtual_mem;  // KB
-};
-
-// 线程安全性能监控器
-class PerformanceMonitor {
-public:
-    PerformanceMonitor(int interval_ms = 1000) 
-        : interval(interval_ms), running(false) {}
-
-    void start() {
-        running = true;
-        // 初始化前一次的 CPU 时间（第一次采样）
-        auto initial_proc = get_process_cpu_time();
-        auto initial_sys = get_system_cpu_time();
-        prev_proc_time = initial_proc;
-        prev_sys_time = initial_sys;
-
-        monitor_thread = std::thread([this](){
-            auto prev_proc_time = get_process_cpu_time();  // 线程内的前一次时间（局部变量，避免共享）
-            auto prev_sys_time = get_system_cpu_time();
-
-            while(running) {
-                auto start = std::chrono::steady_clock::now();
-                
-                // 采集CPU
-                auto curr_proc_time = get_process_cpu_time();
-                auto curr_sys_time = get_system_cpu_time();
-                double cpu = calculate_cpu_usage(prev_proc_time, curr_proc_time,
-                                                prev_sys_time, curr_sys_time);
-                
-                // 采集内存
-                auto mem = get_memory_usage();
-
-                // 记录数据（加锁保护共享数据）
-                {
-                    std::lock_guard<std::mutex> lock(data_mutex);
-                    data.push_back({
-                        std::chrono::system_clock::now(),
-                        cpu,
-                        mem.resident,
-                        mem.virtual_size
-                    });
-                }
-
-                prev_proc_time = curr_proc_time;  // 更新线程内的前一次时间
-                prev_sys_time = curr_sys_time;
-
-                // 精确间隔控制
-                auto end = std::chrono::steady_clock::now();
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-                if(elapsed < interval) {
-                    std::this_thread::sleep_for(interval - elapsed);
-                }
-            }
-        });
-    }
-
-    void stop() {
-        running = false;
-        if(monitor_thread.joinable()) {
-            monitor_thread.join();
-        }
-    }
-
-    void save_csv(const std::string& filename) {
-        std::lock_guard<std::mutex> lock(data_mutex);
-        std::ofstream file(filename);
-        file << "Timestamp,CPU(%),RAM(KB),VirtualMem(KB)\n";
-        
-        for(const auto& entry : data) {
-            auto time = std::chrono::system_clock::to_time_t(entry.timestamp);
-            // 使用 localtime_r 替代 localtime 保证线程安全（Linux）
-            struct tm* local_time = localtime(&time); 
-            file << std::put_time(local_time, "%F %T") << ","
-                 << entry.cpu_usage << ","
-                 << entry.ram_usage << ","
-                 << entry.virtual_mem << "\n";
-        }
-    }
-
-    // 新增：获取最新性能数据（从已采集的 data 中返回）
-    PerformanceData get_latest_performance_data() {
-        std::lock_guard<std::mutex> lock(data_mutex);
-        if (data.empty()) {
-            return {std::chrono::system_clock::now(), 0.0, 0, 0}; // 默认值
-        }
-        return data.back();
-    }
-
-private:
-    struct CpuTime { 
-        unsigned long user, system; 
-        unsigned long long total_system;
-    };
-
-    struct MemoryUsage { 
-        size_t resident; 
-        size_t virtual_size; 
-    };
-
-    // 获取进程CPU时间（用户态+内核态）
-    CpuTime get_process_cpu_time() {
-        std::ifstream stat("/proc/self/stat");
-        std::string line;
-        std::getline(stat, line);
-        
-        std::istringstream iss(line);
-        std::vector<std::string> fields{
-            std::istream_iterator<std::string>(iss),
-            std::istream_iterator<std::string>()
-        };
-
-        // /proc/[pid]/stat 中 utime 是第14字段（索引13），stime 是第15字段（索引14）
-        return {
-            std::stoul(fields[13]),  // utime
-            std::stoul(fields[14]),  // stime
-            0
-        };
-    }
-
-    // 获取系统总CPU时间
-    CpuTime get_system_cpu_time() {
-	std::ifstream stat("/proc/stat");
-	    if (!stat.is_open()) {
-		throw std::runtime_error("Failed to open /proc/stat");
-	    }
-
-	    std::string line;
-	    if (!std::getline(stat, line)) {
-		throw std::runtime_error("Failed to read /proc/stat");
-	    }
-
-	    std::istringstream iss(line);
-	    std::vector<std::string> fields{
-		std::istream_iterator<std::string>(iss),
-		std::istream_iterator<std::string>()
-	    };
-
-	    // 检查字段数量是否足够（至少5个字段，索引0-4）
-	    if (fields.size() < 5) {
-		throw std::runtime_error("/proc/stat has insufficient fields (expected at least 5)");
-	    }
-
-	    // 正确解析 user（索引1）、nice（索引2）、system（索引3）、idle（索引4）
-	    const std::string& user_str = fields[1];
-	    const std::string& nice_str = fields[2];
-	    const std::string& system_str = fields[3];
-	    const std::string& idle_str = fields[4];
-
-	    // 安全转换函数（带错误提示）
-	    auto safe_stoul = [](const std::string& s, const std::string& field_name) -> unsigned long {
-		if (s.empty() || !std::all_of(s.begin(), s.end(), ::isdigit)) {
-		    throw std::invalid_argument("Invalid value for " + field_name + ": " + s);
-		}
-		try {
-		    return std::stoul(s);
-		} catch (const std::out_of_range&) {
-		    throw std::invalid_argument(field_name + " value out of range: " + s);
-		}
-	    };
-
-	    unsigned long user = safe_stoul(user_str, "user");
-	    unsigned long nice = safe_stoul(nice_str, "nice");
-	    unsigned long system = safe_stoul(system_str, "system");
-	    unsigned long idle = safe_stoul(idle_str, "idle");
-
-	    return {
-		0,
-		0,
-		user + nice + system + idle  // 总CPU时间 = user + nice + system + idle
-	    };
-    }
-
-    // 计算CPU使用率（百分比）
-    double calculate_cpu_usage(const CpuTime& prev_proc, const CpuTime& curr_proc,
-                              const CpuTime& prev_sys, const CpuTime& curr_sys) {
-        const unsigned long proc_diff = 
-            (curr_proc.user + curr_proc.system) - 
-            (prev_proc.user + prev_proc.system);
-        
-        const unsigned long long sys_diff = 
-            curr_sys.total_system - prev_sys.total_system;
-
-        return (sys_diff == 0) ? 0.0 : 
-            (100.0 * proc_diff / sys_diff);
-    }
-
-    // 获取内存使用情况
-    MemoryUsage get_memory_usage() {
-        std::unordered_map<std::string, unsigned long> mem_info;
-
-        std::ifstream status("/proc/self/status");
-        std::string line;
-        while (std::getline(status, line)) {
-            if (line.find("VmRSS:") == 0) {  
-                std::istringstream iss(line.substr(6));  
-                iss >> mem_info["VmRSS"];            
-            } else if (line.find("VmSize:") == 0) {    
-                std::istringstream iss(line.substr(7));  
-                iss >> mem_info["VmSize"];             
-            }
-        }
-
-        return { 
-            mem_info["VmRSS"], 
-            mem_info["VmSize"]  
-        };
-    }
-
-    // 新增：获取最新性能数据（从采集的 data 中返回）
-    PerformanceData get_performance_data() {
-        return get_latest_performance_data(); // 直接复用已有逻辑
-    }
-
-    std::thread monitor_thread;
-    std::atomic<bool> running;
-    std::chrono::milliseconds interval;
-    std::vector<PerformanceData> data;
-    std::mutex data_mutex;  // 保护 data 的互斥锁
-    CpuTime prev_proc_time;  // 类成员变量，保存前一次进程CPU时间（需加锁）
-    CpuTime prev_sys_time;   // 类成员变量，保存前一次系统CPU时间（需加锁）
-};
-PerformanceMonitor g_monitor;
+#include "../program/perf_monitor.h"  // 编译时一并编译链接 ../program/perf_monitor.c 和 proc_reader.c
 
 int main(int argc, char* argv[]) {
-    g_monitor.start();
+    // 监控本进程的资源占用，与 collect_data/program 共用同一个环形缓冲区实现；提前返回时也会停止
+    std::unique_ptr<PerformanceMonitor, decltype(&perf_monitor_destroy)> monitor(
+        perf_monitor_create(1000), perf_monitor_destroy);
+    perf_monitor_start(monitor.get());
 
     if (argc < 2) {
         std::cerr << "Usage: " << argv[0] << " <project_name>\n";
@@ -323,8 +98,8 @@ int main(int argc, char* argv[]) {
     // 关闭vmi
     vmi_destroy(vmi);
 
-    g_monitor.stop();
+    perf_monitor_stop(monitor.get());
     std::string filename = argv[1];
-    g_monitor.save_csv("/media/ym/MyPassport/project5/output/usage/" + filename + ".csv");
+    perf_monitor_save_csv(monitor.get(), ("/media/ym/MyPassport/project5/output/usage/" + filename + ".csv").c_str());
     return 0;
 }
@@ -0,0 +1,61 @@
+import argparse
+import os
+import numpy as np
+import torch
+
+from train import DQN, MODEL_PATH, SCHEMA_PATH
+
+# 导出 PyTorch 参考输出，供 code/bench_inference 校验 C 推理内核
+# 文件格式（小端）：int32 样本数, int32 输入维度, int32 输出维度,
+# 随后是 样本数 x 输入维度 个 float32 输入和 样本数 x 输出维度 个 float32 输出
+REFERENCE_PATH = r'reference.bin'
+
+
+# 特征模式（train.save_schema 写出）对应的输入维度：每窗口行数 x 事件数
+def schema_input_dim(path):
+    rows, events = 0, 0
+    with open(path) as f:
+        for line in f:
+            key, _, value = line.partition(' ')
+            if key == 'rows_per_window':
+                rows = int(value)
+            elif key == 'event':
+                events += 1
+    return rows * events
+
+
+def export_reference(model_path, schema_path, out_path, count, seed):
+    # 输入维度取自模型第一层，与被校验的模型一致
+    state = torch.load(model_path, map_location='cpu')
+    input_dim = state['fc1.weight'].shape[1]
+    if schema_path and os.path.exists(schema_path):
+        expected = schema_input_dim(schema_path)
+        if expected != input_dim:
+            raise ValueError(f"{schema_path} 对应 {expected} 维输入，模型 {model_path} 为 {input_dim} 维")
+    model = DQN(input_dim, 2)
+    model.load_state_dict(state)
+    model.eval()
+
+    # 计数器增量跨越多个数量级，按对数均匀分布生成，并保留一部分 0（窗口首行和补零）
+    rng = np.random.default_rng(seed)
+    inputs = np.exp(rng.uniform(0, 16, size=(count, input_dim))).astype(np.float32)
+    inputs[rng.random(size=inputs.shape) < 0.1] = 0
+    with torch.no_grad():
+        outputs = model(torch.from_numpy(inputs)).numpy().astype(np.float32)
+
+    with open(out_path, 'wb') as f:
+        np.array([count, input_dim, outputs.shape[1]], dtype='<i4').tofile(f)
+        inputs.astype('<f4').tofile(f)
+        outputs.astype('<f4').tofile(f)
+    print(f"参考输出已保存至: {out_path}（{count} 个样本）")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='导出 PyTorch 参考输出')
+    parser.add_argument('--model', default=MODEL_PATH)
+    parser.add_argument('--schema', default=SCHEMA_PATH, help='存在时校验与模型输入维度一致')
+    parser.add_argument('--out', default=REFERENCE_PATH)
+    parser.add_argument('--count', type=int, default=1024)
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args()
+    export_reference(args.model, args.schema, args.out, args.count, args.seed)
@@ -0,0 +1,141 @@
+import mmap
+import struct
+from collections import namedtuple
+
+import numpy as np
+
+# 列式数据集文件（.kds）读取，格式见 code/dataset.h
+# 未压缩的分块直接返回 mmap 上的视图；zstd / lz4 分块需要 zstandard / lz4 模块
+
+MAGIC = b'KLEBKDS1'
+INDEX_MAGIC = b'KDSINDEX'
+CHUNK_MAGIC = 0x4b445343
+MAX_EVENTS = 8
+EVENT_NAME_LEN = 64
+HASH_LEN = 32
+
+HEADER = struct.Struct('<8sIIQ' + f'{MAX_EVENTS * EVENT_NAME_LEN}s')
+CHUNK = struct.Struct(f'<IIIIHBBI{HASH_LEN}sQ')
+FOOTER = struct.Struct('<QQ8s')
+CODECS = ('none', 'zstd', 'lz4')
+
+Chunk = namedtuple('Chunk', 'sample_id pid rows columns codec stored_size hash offset attempt time_ns')
+
+
+def _pad8(n):
+    return (n + 7) & ~7
+
+
+def _hash_hex(digest):
+    # md5 只占前 16 字节，全 0 表示未知
+    if not any(digest[16:]):
+        digest = digest[:16]
+    return digest.hex() if any(digest) else ''
+
+
+class KdsReader:
+    def __init__(self, path):
+        self.path = path
+        with open(path, 'rb') as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, count, self.created_ns, names = HEADER.unpack_from(self._map, 0)
+        if magic != MAGIC or version != 1 or not 0 < count <= MAX_EVENTS:
+            raise ValueError(f"{path} 不是有效的数据集文件")
+        self.events = [names[i * EVENT_NAME_LEN:(i + 1) * EVENT_NAME_LEN].split(b'\0')[0].decode()
+                       for i in range(count)]
+        offsets = self._load_index()
+        if offsets is None:
+            offsets = self._scan()
+            print(f"{path} 没有有效索引，扫描得到 {len(offsets)} 块")
+        chunks = [self._chunk(off) for off in offsets]
+        self.chunks = sorted(self._drop_superseded(chunks), key=lambda c: (c.sample_id, c.pid))
+        self.superseded = len(chunks) - len(self.chunks)
+
+    @staticmethod
+    def _drop_superseded(chunks):
+        # 与 code/dataset.c 相同：每个样本只保留最后写入的分块所属尝试的分块，
+        # 被中断后重新采集的样本不会出现重复、不完整的序列
+        latest = {}
+        for c in chunks:
+            if c.sample_id not in latest or c.time_ns > latest[c.sample_id].time_ns:
+                latest[c.sample_id] = c
+        return [c for c in chunks if c.attempt == latest[c.sample_id].attempt]
+
+    def _chunk(self, offset):
+        size = len(self._map)
+        if offset + CHUNK.size > size:
+            return None
+        magic, sample_id, pid, rows, columns, codec, attempt, stored, digest, time_ns = \
+            CHUNK.unpack_from(self._map, offset)
+        if magic != CHUNK_MAGIC or columns != len(self.events) or codec >= len(CODECS):
+            return None
+        if codec == 0 and stored != columns * rows * 8:
+            return None
+        if offset + CHUNK.size + _pad8(stored) > size:
+            return None
+        return Chunk(sample_id, pid, rows, columns, CODECS[codec], stored, _hash_hex(digest),
+                     offset + CHUNK.size, attempt, time_ns)
+
+    def _load_index(self):
+        size = len(self._map)
+        if size < HEADER.size + FOOTER.size:
+            return None
+        index_offset, count, magic = FOOTER.unpack_from(self._map, size - FOOTER.size)
+        if magic != INDEX_MAGIC or index_offset + count * 8 != size - FOOTER.size:
+            return None
+        return list(struct.unpack_from(f'<{count}Q', self._map, index_offset))
+
+    def _scan(self):
+        offsets = []
+        offset = HEADER.size
+        while True:
+            chunk = self._chunk(offset)
+            if chunk is None:
+                return offsets
+            offsets.append(offset)
+            offset = chunk.offset + _pad8(chunk.stored_size)
+
+    def samples(self):
+        return sorted({c.sample_id for c in self.chunks})
+
+    def find(self, sample_id):
+        return [c for c in self.chunks if c.sample_id == sample_id]
+
+    def read(self, chunk):
+        """返回 rows x events 的 uint64 数组（与 perf_output CSV 去掉 sample 列后一致）"""
+        count = chunk.rows * chunk.columns
+        if chunk.codec == 'none':
+            cols = np.frombuffer(self._map, dtype='<u8', count=count, offset=chunk.offset)
+        else:
+            payload = self._map[chunk.offset:chunk.offset + chunk.stored_size]
+            if chunk.codec == 'zstd':
+                import zstandard
+                raw = zstandard.ZstdDecompressor().decompress(payload, max_output_size=count * 8)
+            else:
+                import lz4.block
+                raw = lz4.block.decompress(payload, uncompressed_size=count * 8)
+            cols = np.frombuffer(raw, dtype='<u8', count=count)
+        return cols.reshape(chunk.columns, chunk.rows).T
+
+    def close(self):
+        self._map.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def load_windows(prefix):
+    """读取 code/extract_windows 的输出，返回 (窗口数 x 维度 的 float32 memmap, 标签, 样本号, 元数据)"""
+    import json
+    with open(prefix + '.json') as f:
+        meta = json.load(f)
+    shape = (meta['windows'], meta['dim'])
+    if meta['windows'] == 0:
+        return np.zeros(shape, np.float32), np.zeros(0, np.uint8), np.zeros(0, np.uint32), meta
+    data = np.memmap(prefix + '.f32', dtype='<f4', mode='r', shape=shape)
+    labels = np.memmap(prefix + '.labels', dtype=np.uint8, mode='r', shape=(shape[0],))
+    samples = np.memmap(prefix + '.samples', dtype='<u4', mode='r', shape=(shape[0],))
+    return data, labels, samples, meta
@@ -7,27 +7,66 @@ import torch
 import torch.nn as nn
 import torch.optim as optim
 from sklearn.model_selection import train_test_split
+from kds import KdsReader, load_windows
 
-# 数据集路径（全局变量，修改这里以更改数据集位置）
+# 数据集路径（全局变量，修改这里以更改数据集位置），可以是 CSV 目录、.kds 数据集文件
+# 或 code/extract_windows 输出的 .f32 窗口文件
 DATASET_BENIGN_DIR = r'dataset/benign/benign_vec'  # 修改为你的良性数据集路径
 DATASET_RANSOMWARE_DIR = r'dataset/ransomware/ransomware_vec'  # 修改为你的恶意软件数据集路径
 MODEL_PATH = r'model.pth'  # 保存模型的路径
 WEIGHTS_PATH = r'model_weights.bin'  # 保存模型权重的二进制文件路径
+SCHEMA_PATH = r'model_weights.schema'  # 特征模式文件，C 程序启动时据此校验事件集
+ROWS_PER_WINDOW = 10
+
+# 训练数据的事件列（CSV 表头），所有文件必须一致
+feature_columns = None
+
+def check_columns(source, columns):
+    global feature_columns
+    if feature_columns is None:
+        feature_columns = columns
+    elif columns != feature_columns:
+        raise ValueError(f"{source} 的事件列 {columns} 与 {feature_columns} 不一致")
+
+# 从 .kds 数据集加载：每个分块（一个样本的一个进程）按 ROWS_PER_WINDOW 行切窗口
+def load_kds(path, label):
+    data = []
+    with KdsReader(path) as reader:
+        check_columns(path, reader.events)
+        for chunk in reader.chunks:
+            values = reader.read(chunk).astype(np.float32)
+            windows = len(values) // ROWS_PER_WINDOW
+            if windows:
+                data.extend(values[:windows * ROWS_PER_WINDOW].reshape(windows, -1))
+    labels = [label] * len(data)
+    return data, labels
+
+# 从 extract_windows 预先切好的窗口文件加载（np.memmap，不复制）；只取标签为 label 的窗口
+def load_windows_file(path, label):
+    data, labels, _, meta = load_windows(path[:-len('.f32')])
+    check_columns(path, meta['events'])
+    if meta['rows'] != ROWS_PER_WINDOW:
+        raise ValueError(f"{path} 每窗口 {meta['rows']} 行，训练需要 {ROWS_PER_WINDOW} 行")
+    data = list(data[labels == label])
+    return data, [label] * len(data)
 
 # 数据加载函数
 def load_data(directory, label):
+    if directory.endswith('.kds'):
+        return load_kds(directory, label)
+    if directory.endswith('.f32'):
+        return load_windows_file(directory, label)
     data = []
     for filename in os.listdir(directory):
         if filename.endswith('.csv'):
             filepath = os.path.join(directory, filename)
             df = pd.read_csv(filepath)
-            # 每次取10行数据（10*4=40维）
-            for start in range(0, len(df), 10):
-                end = start + 10
+            check_columns(filepath, list(df.columns))
+            # 每次取 ROWS_PER_WINDOW 行数据（ROWS_PER_WINDOW*列数 维）
+            for start in range(0, len(df), ROWS_PER_WINDOW):
+                end = start + ROWS_PER_WINDOW
                 if end <= len(df):  # 确保不超过数据长度
-                    chunk = df.iloc[start:end].values.flatten()
-                    if len(chunk) == 40:  # 确保维度为40
-                        data.append(chunk)
+                    data.append(df.iloc[start:end].values.flatten())
     labels = [label] * len(data)
     return data, labels
 
@@ -133,9 +172,18 @@ def save_weights_to_binary(model, filepath):
     weights.tofile(filepath)
     print(f"模型权重已保存至: {filepath}")
 
+# 保存特征模式（每窗口行数 + 事件顺序），与 code/event_set.c 的 schema_load 对应
+def save_schema(filepath, columns, rows_per_window):
+    with open(filepath, 'w') as f:
+        f.write(f"rows_per_window {rows_per_window}\n")
+        for name in columns:
+            f.write(f"event {name}\n")
+    print(f"特征模式已保存至: {filepath}")
+
 # 训练函数
 def train_agent(benign_train, ransomware_train):
-    input_dim = 40  # 修改为10*4=40
+    # 由数据集的事件列推出（默认 4 个事件为 10*4=40）；C 推理端按 model_weights.schema 校验维度
+    input_dim = ROWS_PER_WINDOW * len(feature_columns)
     output_dim = 2
     batch_size = 32
     num_episodes = 8000
@@ -168,6 +216,7 @@ def train_agent(benign_train, ransomware_train):
 
     # 保存模型权重为二进制格式（供C语言推理使用）
     save_weights_to_binary(agent.policy_net, WEIGHTS_PATH)
+    save_schema(SCHEMA_PATH, feature_columns, ROWS_PER_WINDOW)
 
     return agent
 